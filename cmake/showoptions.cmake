@@ -55,6 +55,12 @@ else()
   message(STATUS "Build Playerbot       : No  (default)")
 endif()
 
+if(BUILD_LOADTEST)
+  message(STATUS "Build load test       : Yes")
+else()
+  message(STATUS "Build load test       : No  (default)")
+endif()
+
 if(BUILD_EXTRACTORS)
   message(STATUS "Build extractors      : Yes")
 else()
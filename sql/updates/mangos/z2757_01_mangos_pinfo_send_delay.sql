@@ -0,0 +1,9 @@
+ALTER TABLE db_version CHANGE COLUMN required_z2756_01_mangos_new_ticket_system_update required_z2757_01_mangos_pinfo_send_delay bit;
+
+LOCK TABLES `mangos_string` WRITE;
+/*!40000 ALTER TABLE `mangos_string` DISABLE KEYS */;
+DELETE FROM `mangos_string` WHERE `entry` = 555;
+INSERT INTO `mangos_string` VALUES
+(555,'Send delay: avg %u us, max %u us, queued %u bytes',NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL);
+/*!40000 ALTER TABLE `mangos_string` ENABLE KEYS */;
+UNLOCK TABLES;
@@ -92,6 +92,19 @@ class NGrid
             i_GridInfo = GridInfo(expiry, unload);
         }
 
+        /** prepare an unloaded grid kept in a pool for another position, all cells must be empty
+         */
+        void Reuse(uint32 id, uint32 x, uint32 y, time_t expiry, bool unload = true)
+        {
+            assert(ActiveObjectsInGrid() == 0);
+            i_gridId = id;
+            i_x = x;
+            i_y = y;
+            i_cellstate = GRID_STATE_INVALID;
+            i_GridObjectDataLoaded = false;
+            i_GridInfo = GridInfo(expiry, unload);
+        }
+
         const GridType& operator()(uint32 x, uint32 y) const
         {
             assert(x < N);
@@ -117,6 +130,8 @@ class NGrid
             i_Reference.link(pTo, this);
         }
 
+        void unlink() { i_Reference.unlink(); }
+
         bool isGridObjectDataLoaded() const { return i_GridObjectDataLoaded; }
         void setGridObjectDataLoaded(bool pLoaded) { i_GridObjectDataLoaded = pLoaded; }
 
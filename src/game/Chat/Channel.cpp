@@ -662,16 +662,19 @@ void Channel::SendToOne(WorldPacket const& data, ObjectGuid receiver) const
 
 void Channel::SendToAll(WorldPacket const& data) const
 {
+    BroadcastPacket broadcast(data);
     for (PlayerList::const_iterator i = m_players.begin(); i != m_players.end(); ++i)
-        SendToOne(data, i->first);
+        if (Player* plr = sObjectMgr.GetPlayer(i->first))
+            broadcast.SendTo(*plr->GetSession());
 }
 
 void Channel::SendMessage(WorldPacket const& data, ObjectGuid sender) const
 {
+    BroadcastPacket broadcast(data);
     for (PlayerList::const_iterator i = m_players.begin(); i != m_players.end(); ++i)
         if (Player* plr = sObjectMgr.GetPlayer(i->first))
             if (!sender || !plr->GetSocial()->HasIgnore(sender))
-                plr->GetSession()->SendPacket(data);
+                broadcast.SendTo(*plr->GetSession());
 }
 
 void Channel::Voice(ObjectGuid /*guid1*/, ObjectGuid /*guid2*/) const
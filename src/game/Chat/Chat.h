@@ -276,6 +276,7 @@ class ChatHandler
         bool HandleDebugIsVisibleCommand(char* args);
 
         bool HandleDebugMaps(char* args);
+        bool HandleDebugTickProfileCommand(char* args);
         bool HandleShowTemporarySpawnList(char* args);
         bool HandleGridsLoadedCount(char* args);
 
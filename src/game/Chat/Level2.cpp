@@ -2509,6 +2509,10 @@ bool ChatHandler::HandlePInfoCommand(char* args)
     uint32 copp = (money % GOLD) % SILVER;
     PSendSysMessage(LANG_PINFO_LEVEL,  timeStr.c_str(), level, gold, silv, copp);
 
+    uint32 sendDelay, sendDelayMax;
+    if (target && target->GetSession()->GetSendDelay(sendDelay, sendDelayMax))
+        PSendSysMessage(LANG_PINFO_SEND_DELAY, sendDelay, sendDelayMax, uint32(target->GetSession()->GetSendQueueBytes()));
+
     return true;
 }
 
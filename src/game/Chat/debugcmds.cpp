@@ -29,6 +29,7 @@
 #include "BattleGround/BattleGroundMgr.h"
 #include <fstream>
 #include "Maps/MapManager.h"
+#include "World/World.h"
 #include "Globals/ObjectMgr.h"
 #include "Entities/ObjectGuid.h"
 #include "Spells/SpellMgr.h"
@@ -1221,6 +1222,51 @@ bool ChatHandler::HandleDebugMaps(char* /*args*/)
     return true;
 }
 
+// .debug perf ticks [#mapId [#instanceId]] - per phase tick percentiles of the world and a map
+bool ChatHandler::HandleDebugTickProfileCommand(char* args)
+{
+    if (!TickProfiler::IsEnabled())
+    {
+        SendSysMessage("Tick profiler is disabled (TickProfiler.Enable).");
+        return true;
+    }
+
+    Map* map = nullptr;
+    uint32 mapId;
+    if (ExtractUInt32(&args, mapId))
+    {
+        uint32 instanceId;
+        if (!ExtractOptUInt32(&args, instanceId, 0))
+            return false;
+
+        map = sMapMgr.FindMap(mapId, instanceId);
+        if (!map)
+        {
+            PSendSysMessage("Map %u (instance %u) is not loaded.", mapId, instanceId);
+            SetSentErrorMessage(true);
+            return false;
+        }
+    }
+    else if (m_session && m_session->GetPlayer())
+        map = m_session->GetPlayer()->GetMap();
+
+    TickProfiler const& worldProfiler = sWorld.GetTickProfiler();
+    SendSysMessage("World update:");
+    for (uint32 i = 0; i <= worldProfiler.GetPhaseCount(); ++i)
+        PSendSysMessage("  %s", worldProfiler.FormatPhase(i).c_str());
+
+    if (map)
+    {
+        TickProfiler const& mapProfiler = map->GetTickProfiler();
+        PSendSysMessage("Map[%u] (Instance: %u) update, overload stage %s:", map->GetId(), map->GetInstanceId(),
+                        OverloadGovernor::GetStageName(map->GetOverloadGovernor().GetStage()));
+        for (uint32 i = 0; i <= mapProfiler.GetPhaseCount(); ++i)
+            PSendSysMessage("  %s", mapProfiler.FormatPhase(i).c_str());
+    }
+
+    return true;
+}
+
 bool ChatHandler::HandleShowTemporarySpawnList(char* /*args*/)
 {
     Player* pPlayer = m_session->GetPlayer();
@@ -22,8 +22,9 @@
 #include "Log.h"
 #include "Errors.h"
 #include "Entities/Player.h"
+#include "Maps/Map.h"
 
-Camera::Camera(Player* pl) : m_owner(*pl), m_source(pl)
+Camera::Camera(Player* pl) : m_owner(*pl), m_source(pl), m_indexMap(nullptr), m_indexSlot(NOT_INDEXED)
 {
     m_source->GetViewPoint().Attach(this);
 }
@@ -35,6 +36,8 @@ Camera::~Camera()
 
     // for symmetry with constructor and way to make viewpoint's list empty
     m_source->GetViewPoint().Detach(this);
+
+    RemoveFromIndex();
 }
 
 void Camera::ReceivePacket(WorldPacket& data)
@@ -47,7 +50,12 @@ void Camera::UpdateForCurrentViewPoint()
     m_gridRef.unlink();
 
     if (GridType* grid = m_source->GetViewPoint().m_grid)
+    {
         grid->AddWorldObject(this);
+        UpdateIndex();
+    }
+    else
+        RemoveFromIndex();
 
     UpdateVisibilityForOwner();
 }
@@ -106,6 +114,7 @@ void Camera::Event_AddedToWorld()
     GridType* grid = m_source->GetViewPoint().m_grid;
     MANGOS_ASSERT(grid);
     grid->AddWorldObject(this);
+    UpdateIndex();
 
     UpdateVisibilityForOwner();
 }
@@ -115,6 +124,7 @@ void Camera::Event_RemovedFromWorld()
     if (m_source == &m_owner)
     {
         m_gridRef.unlink();
+        RemoveFromIndex();
         return;
     }
 
@@ -125,6 +135,26 @@ void Camera::Event_Moved()
 {
     m_gridRef.unlink();
     m_source->GetViewPoint().m_grid->AddWorldObject(this);
+    UpdateIndex();
+}
+
+void Camera::UpdateIndex()
+{
+    Map* map = m_source->GetMap();
+    if (m_indexMap != map)
+        RemoveFromIndex();
+
+    m_indexMap = map;
+    m_indexMap->PlaceCamera(this, MaNGOS::ComputeCellPair(m_source->GetPositionX(), m_source->GetPositionY()));
+}
+
+void Camera::RemoveFromIndex()
+{
+    if (!m_indexMap)
+        return;
+
+    m_indexMap->RemoveCamera(this);
+    m_indexMap = nullptr;
 }
 
 void Camera::UpdateVisibilityOf(WorldObject* target) const
@@ -24,6 +24,8 @@
 #include "Entities/EntitiesMgr.h"
 
 class ViewPoint;
+class CameraIndex;
+class Map;
 class UpdateData;
 class WorldPacket;
 
@@ -31,7 +33,9 @@ class WorldPacket;
 class Camera
 {
         friend class ViewPoint;
+        friend class CameraIndex;
     public:
+        static const uint32 NOT_INDEXED = 0xFFFFFFFF;
 
         explicit Camera(Player* pl);
         ~Camera();
@@ -68,6 +72,13 @@ class Camera
 
         void UpdateForCurrentViewPoint();
 
+        // keep the entry of the map's camera index in sync with the cell the camera is linked to
+        void UpdateIndex();
+        void RemoveFromIndex();
+
+        Map* m_indexMap;
+        uint32 m_indexSlot;
+
     public:
         GridReference<Camera>& GetGridRef() { return m_gridRef; }
         bool isActiveObject() const { return false; }
@@ -59,7 +59,7 @@ class LoginQueryHolder : public SqlQueryHolder
         ObjectGuid m_guid;
     public:
         LoginQueryHolder(uint32 accountId, ObjectGuid guid)
-            : m_accountId(accountId), m_guid(guid) { }
+            : m_accountId(accountId), m_guid(guid) { SetOrderKey(guid.GetCounter()); }
         ObjectGuid GetGuid() const { return m_guid; }
         uint32 GetAccountId() const { return m_accountId; }
         bool Initialize();
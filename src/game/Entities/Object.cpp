@@ -79,7 +79,7 @@ void Object::_InitValues()
     m_uint32Values = new uint32[ m_valuesCount ];
     memset(m_uint32Values, 0, m_valuesCount * sizeof(uint32));
 
-    m_changedValues.resize(m_valuesCount, false);
+    m_changedValues.SetCount(m_valuesCount);
 
     m_objectUpdated = false;
 }
@@ -107,8 +107,8 @@ void Object::SendForcedObjectUpdate()
 
     UpdateDataMapType update_players;
 
-    BuildUpdateData(update_players);
     RemoveFromClientUpdateList();
+    BuildUpdateData(update_players);
 
     WorldPacket packet;                                     // here we allocate a std::vector with a size of 0x10000
     for (auto& update_player : update_players)
@@ -202,6 +202,43 @@ void Object::BuildValuesUpdateBlockForPlayer(UpdateData* data, Player* target) c
     data->AddUpdateBlock(buf);
 }
 
+// health, power and aura fields, viewers in the far interest band get them at most once per Interest.FarInterval
+static void RemoveFarCoalescedBits(UpdateMask& mask)
+{
+    for (uint32 index = UNIT_FIELD_HEALTH; index <= UNIT_FIELD_MAXPOWER5; ++index)
+        mask.UnsetBit(index);
+
+    for (uint32 index = UNIT_FIELD_AURA; index <= UNIT_FIELD_AURASTATE; ++index)
+        mask.UnsetBit(index);
+}
+
+void Object::BuildValuesUpdateBlockForPlayer(UpdateData* data, Player* target, ValuesUpdateCache& cache) const
+{
+    if (!cache.built)
+    {
+        cache.block << uint8(UPDATETYPE_VALUES);
+        cache.block << GetPackGUID();
+
+        UpdateMask updateMask;
+        updateMask.SetCount(m_valuesCount);
+
+        _SetUpdateBits(&updateMask, target);
+        if (cache.farBand)
+            RemoveFarCoalescedBits(updateMask);
+
+        BuildValuesUpdate(UPDATETYPE_VALUES, &cache.block, &updateMask, target, &cache.viewerFields);
+        cache.built = true;
+    }
+    else
+    {
+        bool perViewer;
+        for (auto const& field : cache.viewerFields)
+            cache.block.put<uint32>(field.first, GetUpdateFieldValue(field.second, target, perViewer));
+    }
+
+    data->AddUpdateBlock(cache.block);
+}
+
 void Object::BuildForcedValuesUpdateBlockForPlayer(UpdateData* data, Player* target) const
 {
     ByteBuffer buf(500);
@@ -314,344 +351,363 @@ void Object::BuildMovementUpdate(ByteBuffer* data, uint8 updateFlags) const
         *data << uint32(WorldTimer::getMSTime());
 }
 
-void Object::BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, UpdateMask* updateMask, Player* target) const
+void Object::BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, UpdateMask* updateMask, Player* target, ValuesUpdateCache::ViewerFieldList* viewerFields) const
 {
     if (!target)
         return;
 
-    bool IsActivateToQuest = false;
-    bool IsPerCasterAuraState = false;
+    if (isType(TYPEMASK_GAMEOBJECT) && !((GameObject*)this)->IsTransport())
+    {
+        updateMask->SetBit(GAMEOBJECT_DYN_FLAGS);
 
-    if (updatetype == UPDATETYPE_CREATE_OBJECT || updatetype == UPDATETYPE_CREATE_OBJECT2)
+        if (updatetype == UPDATETYPE_VALUES)
+            updateMask->SetBit(GAMEOBJECT_ANIMPROGRESS);
+    }
+
+    MANGOS_ASSERT(updateMask && updateMask->GetCount() == m_valuesCount);
+
+    *data << (uint8)updateMask->GetBlockCount();
+    for (uint32 block = 0; block < updateMask->GetBlockCount(); ++block)
+        *data << updateMask->GetBlock(block);
+
+    // only the set bits are visited, unchanged parts of the mask cost one word test each
+    updateMask->VisitSetBits([&](uint32 index)
     {
-        if (isType(TYPEMASK_GAMEOBJECT) && !((GameObject*)this)->IsTransport())
+        bool perViewer = false;
+        uint32 value = GetUpdateFieldValue(uint16(index), target, perViewer);
+
+        if (perViewer && viewerFields)
+            viewerFields->push_back(std::make_pair(data->wpos(), uint16(index)));
+
+        *data << value;
+    });
+}
+
+enum UnitUpdateFieldKind
+{
+    UNIT_FIELD_KIND_PLAIN,                                  // sent as stored
+    UNIT_FIELD_KIND_NPC_FLAGS,
+    UNIT_FIELD_KIND_ATTACK_TIME,                            // float sent as uint32, negative as 0
+    UNIT_FIELD_KIND_FLOAT,                                  // float sent as uint32
+    UNIT_FIELD_KIND_HEALTH,
+    UNIT_FIELD_KIND_FOG_STAT,
+    UNIT_FIELD_KIND_FLAGS,
+    UNIT_FIELD_KIND_DYNAMIC_FLAGS,
+    UNIT_FIELD_KIND_FACTION,
+};
+
+// Special handling of unit and player update fields, looked up per index instead of testing every range for every field
+class UnitUpdateFieldKinds
+{
+    public:
+        static UnitUpdateFieldKind Get(uint16 index)
         {
-            if (((GameObject*)this)->ActivateToQuest(target) || target->isGameMaster())
-                IsActivateToQuest = true;
+            return index < PLAYER_END ? UnitUpdateFieldKind(s_instance.m_kinds[index]) : UNIT_FIELD_KIND_PLAIN;
+        }
 
-            updateMask->SetBit(GAMEOBJECT_DYN_FLAGS);
+    private:
+        UnitUpdateFieldKinds()
+        {
+            for (uint16 index = 0; index < PLAYER_END; ++index)
+                m_kinds[index] = uint8(Classify(index));
         }
-    }
-    else                                                    // case UPDATETYPE_VALUES
-    {
-        if (isType(TYPEMASK_GAMEOBJECT) && !((GameObject*)this)->IsTransport())
+
+        static constexpr bool IsFogOfWarStat(uint16 index)
         {
-            if (((GameObject*)this)->ActivateToQuest(target) || target->isGameMaster())
-                IsActivateToQuest = true;
+            return index == UNIT_FIELD_MINDAMAGE || index == UNIT_FIELD_MAXDAMAGE ||
+                   index == UNIT_FIELD_MINOFFHANDDAMAGE || index == UNIT_FIELD_MAXOFFHANDDAMAGE ||
+                   (index >= UNIT_FIELD_STAT0 && index < UNIT_FIELD_BASE_MANA) ||
+                   index == UNIT_FIELD_BASE_HEALTH || index == UNIT_FIELD_ATTACK_POWER ||
+                   index == UNIT_FIELD_ATTACK_POWER_MODS || index == UNIT_FIELD_ATTACK_POWER_MULTIPLIER ||
+                   index == UNIT_FIELD_RANGED_ATTACK_POWER || index == UNIT_FIELD_RANGED_ATTACK_POWER_MODS ||
+                   index == UNIT_FIELD_RANGED_ATTACK_POWER_MULTIPLIER || index == UNIT_FIELD_MINRANGEDDAMAGE ||
+                   index == UNIT_FIELD_MAXRANGEDDAMAGE || (index >= UNIT_FIELD_POWER_COST_MODIFIER && index <= UNIT_FIELD_POWER_COST_MULTIPLIER_06);
+        }
 
-            updateMask->SetBit(GAMEOBJECT_DYN_FLAGS);
-            updateMask->SetBit(GAMEOBJECT_ANIMPROGRESS);
+        // order matters, the first matching kind wins
+        static constexpr UnitUpdateFieldKind Classify(uint16 index)
+        {
+            return index == UNIT_NPC_FLAGS ? UNIT_FIELD_KIND_NPC_FLAGS :
+                   (index >= UNIT_FIELD_BASEATTACKTIME && index <= UNIT_FIELD_RANGEDATTACKTIME) ? UNIT_FIELD_KIND_ATTACK_TIME :
+                   ((index >= PLAYER_FIELD_NEGSTAT0 && index <= PLAYER_FIELD_NEGSTAT4) ||
+                    (index >= PLAYER_FIELD_RESISTANCEBUFFMODSPOSITIVE && index <= (PLAYER_FIELD_RESISTANCEBUFFMODSPOSITIVE + 6)) ||
+                    (index >= PLAYER_FIELD_RESISTANCEBUFFMODSNEGATIVE && index <= (PLAYER_FIELD_RESISTANCEBUFFMODSNEGATIVE + 6)) ||
+                    (index >= PLAYER_FIELD_POSSTAT0 && index <= PLAYER_FIELD_POSSTAT4)) ? UNIT_FIELD_KIND_FLOAT :
+                   (index == UNIT_FIELD_HEALTH || index == UNIT_FIELD_MAXHEALTH) ? UNIT_FIELD_KIND_HEALTH :
+                   IsFogOfWarStat(index) ? UNIT_FIELD_KIND_FOG_STAT :
+                   index == UNIT_FIELD_FLAGS ? UNIT_FIELD_KIND_FLAGS :
+                   index == UNIT_DYNAMIC_FLAGS ? UNIT_FIELD_KIND_DYNAMIC_FLAGS :
+                   index == UNIT_FIELD_FACTIONTEMPLATE ? UNIT_FIELD_KIND_FACTION :
+                   UNIT_FIELD_KIND_PLAIN;
         }
-    }
 
-    MANGOS_ASSERT(updateMask && updateMask->GetCount() == m_valuesCount);
+        uint8 m_kinds[PLAYER_END];
 
-    *data << (uint8)updateMask->GetBlockCount();
-    data->append(updateMask->GetMask(), updateMask->GetLength());
+        static UnitUpdateFieldKinds const s_instance;
+};
+
+UnitUpdateFieldKinds const UnitUpdateFieldKinds::s_instance;
 
-    // 2 specialized loops for speed optimization in non-unit case
+uint32 Object::GetUpdateFieldValue(uint16 index, Player* target, bool& perViewer) const
+{
     if (isType(TYPEMASK_UNIT))                              // unit (creature/player) case
+        return GetUnitUpdateFieldValue(index, target, perViewer);
+
+    if (isType(TYPEMASK_CORPSE))                            // corpse case
     {
-        for (uint16 index = 0; index < m_valuesCount; ++index)
+        if (index == CORPSE_FIELD_BYTES_1)
         {
-            if (updateMask->GetBit(index))
+            perViewer = true;
+            uint32 value = m_uint32Values[index];
+
+            // [XFACTION]: Alter race field if detected crossfaction group interaction:
+            if (sWorld.getConfig(CONFIG_BOOL_ALLOW_TWO_SIDE_INTERACTION_GROUP))
             {
-                if (index == UNIT_NPC_FLAGS)
+                Corpse const* thisCorpse = static_cast<Corpse const*>(this);
+                ObjectGuid const& ownerGuid = thisCorpse->GetOwnerGuid();
+                Group const* targetGroup = target->GetGroup();
+
+                if (ownerGuid != target->GetObjectGuid() && targetGroup && targetGroup->IsMember(ownerGuid))
                 {
-                    uint32 appendValue = m_uint32Values[index];
+                    const uint8 targetRace = target->getRace();
 
-                    if (GetTypeId() == TYPEID_UNIT)
-                    {
-                        if (appendValue & UNIT_NPC_FLAG_TRAINER)
-                        {
-                            if (!((Creature*)this)->IsTrainerOf(target, false))
-                                appendValue &= ~UNIT_NPC_FLAG_TRAINER;
-                        }
+                    if (Player::TeamForRace(thisCorpse->getRace()) != Player::TeamForRace(targetRace))
+                        value = ((value &~ uint32(0xFF << 8)) | (uint32(targetRace) << 8));
+                }
+            }
 
-                        if (appendValue & UNIT_NPC_FLAG_STABLEMASTER)
-                        {
-                            if (target->getClass() != CLASS_HUNTER)
-                                appendValue &= ~UNIT_NPC_FLAG_STABLEMASTER;
-                        }
+            return value;
+        }
 
-                        if (appendValue & UNIT_NPC_FLAG_FLIGHTMASTER)
-                        {
-                            QuestRelationsMapBounds bounds = sObjectMgr.GetCreatureQuestRelationsMapBounds(((Creature*)this)->GetEntry());
-                            for (QuestRelationsMap::const_iterator itr = bounds.first; itr != bounds.second; ++itr)
-                            {
-                                Quest const* pQuest = sObjectMgr.GetQuestTemplate(itr->second);
-                                if (target->CanSeeStartQuest(pQuest))
-                                {
-                                    appendValue &= ~UNIT_NPC_FLAG_FLIGHTMASTER;
-                                    break;
-                                }
-                            }
-
-                            bounds = sObjectMgr.GetCreatureQuestInvolvedRelationsMapBounds(((Creature*)this)->GetEntry());
-                            for (QuestRelationsMap::const_iterator itr = bounds.first; itr != bounds.second; ++itr)
-                            {
-                                Quest const* pQuest = sObjectMgr.GetQuestTemplate(itr->second);
-                                if (target->CanRewardQuest(pQuest, false))
-                                {
-                                    appendValue &= ~UNIT_NPC_FLAG_FLIGHTMASTER;
-                                    break;
-                                }
-                            }
-                        }
-                    }
+        return m_uint32Values[index];                       // other cases
+    }
 
-                    *data << uint32(appendValue);
-                }
-                // FIXME: Some values at server stored in float format but must be sent to client in uint32 format
-                else if (index >= UNIT_FIELD_BASEATTACKTIME && index <= UNIT_FIELD_RANGEDATTACKTIME)
-                {
-                    // convert from float to uint32 and send
-                    *data << uint32(m_floatValues[index] < 0 ? 0 : m_floatValues[index]);
-                }
+    if (isType(TYPEMASK_GAMEOBJECT))                        // gameobject case
+    {
+        if (index == GAMEOBJECT_DYN_FLAGS)
+        {
+            perViewer = true;
+            GameObject const* gameObject = static_cast<GameObject const*>(this);
 
-                // there are some float values which may be negative or can't get negative due to other checks
-                else if ((index >= PLAYER_FIELD_NEGSTAT0    && index <= PLAYER_FIELD_NEGSTAT4) ||
-                         (index >= PLAYER_FIELD_RESISTANCEBUFFMODSPOSITIVE  && index <= (PLAYER_FIELD_RESISTANCEBUFFMODSPOSITIVE + 6)) ||
-                         (index >= PLAYER_FIELD_RESISTANCEBUFFMODSNEGATIVE  && index <= (PLAYER_FIELD_RESISTANCEBUFFMODSNEGATIVE + 6)) ||
-                         (index >= PLAYER_FIELD_POSSTAT0    && index <= PLAYER_FIELD_POSSTAT4))
-                {
-                    *data << uint32(m_floatValues[index]);
-                }
-                else if (index == UNIT_FIELD_HEALTH || index == UNIT_FIELD_MAXHEALTH)
-                {
-                    uint32 value = m_uint32Values[index];
+            if (gameObject->IsTransport() || (!gameObject->ActivateToQuest(target) && !target->isGameMaster()))
+                return 0;                                   // disable quest object
 
-                    // Fog of War: replace absolute health values with percentages for non-allied units according to settings
-                    if (!static_cast<const Unit*>(this)->IsFogOfWarVisibleHealth(target))
-                    {
-                        switch (index)
-                        {
-                            case UNIT_FIELD_HEALTH:     value = uint32(ceil((100.0 * value) / m_uint32Values[UNIT_FIELD_MAXHEALTH]));   break;
-                            case UNIT_FIELD_MAXHEALTH:  value = 100;                                                                    break;
-                        }
-                    }
+            switch (gameObject->GetGoType())
+            {
+                case GAMEOBJECT_TYPE_QUESTGIVER:
+                case GAMEOBJECT_TYPE_CHEST:
+                    if (gameObject->GetLootState() == GO_READY || gameObject->GetLootState() == GO_ACTIVATED)
+                        return GO_DYNFLAG_LO_ACTIVATE | GO_DYNFLAG_LO_SPARKLE;
+                    return 0;
+                case GAMEOBJECT_TYPE_GENERIC:
+                case GAMEOBJECT_TYPE_SPELL_FOCUS:
+                case GAMEOBJECT_TYPE_GOOBER:
+                    return GO_DYNFLAG_LO_ACTIVATE;
+                default:
+                    return 0;                               // unknown, not happen.
+            }
+        }
 
-                    *data << value;
-                }
-                // Fog of War: hide stat values for non-allied units according to settings
-                else if ((index == UNIT_FIELD_RANGEDATTACKTIME ||
-                          index == UNIT_FIELD_MINDAMAGE || index == UNIT_FIELD_MAXDAMAGE ||
-                          index == UNIT_FIELD_MINOFFHANDDAMAGE || index == UNIT_FIELD_MAXOFFHANDDAMAGE ||
-                          (index >= UNIT_FIELD_STAT0 && index < UNIT_FIELD_BASE_MANA) ||
-                          index == UNIT_FIELD_BASE_HEALTH || index == UNIT_FIELD_ATTACK_POWER ||
-                          index == UNIT_FIELD_ATTACK_POWER_MODS || index == UNIT_FIELD_ATTACK_POWER_MULTIPLIER ||
-                          index == UNIT_FIELD_RANGED_ATTACK_POWER || index == UNIT_FIELD_RANGED_ATTACK_POWER_MODS ||
-                          index == UNIT_FIELD_RANGED_ATTACK_POWER_MULTIPLIER || index == UNIT_FIELD_MINRANGEDDAMAGE ||
-                          index == UNIT_FIELD_MAXRANGEDDAMAGE || (index >= UNIT_FIELD_POWER_COST_MODIFIER && index <= UNIT_FIELD_POWER_COST_MULTIPLIER_06)) &&
-                          !static_cast<const Unit*>(this)->IsFogOfWarVisibleStats(target))
-                {
-                    *data << uint32(0);
-                }
+        return m_uint32Values[index];                       // other cases
+    }
 
-                // Gamemasters should be always able to select units - remove not selectable flag
-                else if (index == UNIT_FIELD_FLAGS && target->isGameMaster())
-                {
-                    *data << (m_uint32Values[index] & ~UNIT_FLAG_NOT_SELECTABLE);
-                }
-                // Hide lootable animation for unallowed players
-                // Handle tapped flag
-                else if (index == UNIT_DYNAMIC_FLAGS && GetTypeId() == TYPEID_UNIT)
-                {
-                    Creature* creature = (Creature*)this;
-                    uint32 dynflagsValue = m_uint32Values[index];
-                    bool setTapFlags = false;
+    // other objects case (no special index checks), send in current format (float as float, uint32 as uint32)
+    return m_uint32Values[index];
+}
 
-                    if (creature->isAlive())
-                    {
-                        // creature is alive so, not lootable
-                        dynflagsValue = dynflagsValue & ~UNIT_DYNFLAG_LOOTABLE;
+uint32 Object::GetUnitUpdateFieldValue(uint16 index, Player* target, bool& perViewer) const
+{
+    switch (UnitUpdateFieldKinds::Get(index))
+    {
+        case UNIT_FIELD_KIND_NPC_FLAGS:
+        {
+            if (GetTypeId() != TYPEID_UNIT)
+                return m_uint32Values[index];
 
-                        if (creature->isInCombat())
-                        {
-                            // as creature is in combat we have to manage tap flags
-                            setTapFlags = true;
-                        }
-                        else
-                        {
-                            // creature is not in combat so its not tapped
-                            dynflagsValue = dynflagsValue & ~UNIT_DYNFLAG_TAPPED;
-                            //sLog.outString(">> %s is not in combat so not tapped by %s", this->GetGuidStr().c_str(), target->GetGuidStr().c_str());
-                        }
-                    }
-                    else
-                    {
-                        // check loot flag
-                        if (creature->m_loot && creature->m_loot->CanLoot(target))
-                        {
-                            // creature is dead and this player can loot it
-                            dynflagsValue = dynflagsValue | UNIT_DYNFLAG_LOOTABLE;
-                            //sLog.outString(">> %s is lootable for %s", this->GetGuidStr().c_str(), target->GetGuidStr().c_str());
-                        }
-                        else
-                        {
-                            // creature is dead but this player cannot loot it
-                            dynflagsValue = dynflagsValue & ~UNIT_DYNFLAG_LOOTABLE;
-                            //sLog.outString(">> %s is not lootable for %s", this->GetGuidStr().c_str(), target->GetGuidStr().c_str());
-                        }
+            perViewer = true;
+            uint32 appendValue = m_uint32Values[index];
 
-                        // as creature is died we have to manage tap flags
-                        setTapFlags = true;
-                    }
+            if (appendValue & UNIT_NPC_FLAG_TRAINER)
+            {
+                if (!((Creature*)this)->IsTrainerOf(target, false))
+                    appendValue &= ~UNIT_NPC_FLAG_TRAINER;
+            }
+
+            if (appendValue & UNIT_NPC_FLAG_STABLEMASTER)
+            {
+                if (target->getClass() != CLASS_HUNTER)
+                    appendValue &= ~UNIT_NPC_FLAG_STABLEMASTER;
+            }
 
-                    // check tap flags
-                    if (setTapFlags)
+            if (appendValue & UNIT_NPC_FLAG_FLIGHTMASTER)
+            {
+                QuestRelationsMapBounds bounds = sObjectMgr.GetCreatureQuestRelationsMapBounds(((Creature*)this)->GetEntry());
+                for (QuestRelationsMap::const_iterator itr = bounds.first; itr != bounds.second; ++itr)
+                {
+                    Quest const* pQuest = sObjectMgr.GetQuestTemplate(itr->second);
+                    if (target->CanSeeStartQuest(pQuest))
                     {
-                        if (creature->IsTappedBy(target))
-                        {
-                            // creature is in combat or died and tapped by this player
-                            dynflagsValue = dynflagsValue & ~UNIT_DYNFLAG_TAPPED;
-                            //sLog.outString(">> %s is tapped by %s", this->GetGuidStr().c_str(), target->GetGuidStr().c_str());
-                        }
-                        else
-                        {
-                            // creature is in combat or died but not tapped by this player
-                            dynflagsValue = dynflagsValue | UNIT_DYNFLAG_TAPPED;
-                            //sLog.outString(">> %s is not tapped by %s", this->GetGuidStr().c_str(), target->GetGuidStr().c_str());
-                        }
+                        appendValue &= ~UNIT_NPC_FLAG_FLIGHTMASTER;
+                        break;
                     }
+                }
 
-                    if (GetTypeId() == TYPEID_UNIT || GetTypeId() == TYPEID_PLAYER)
+                bounds = sObjectMgr.GetCreatureQuestInvolvedRelationsMapBounds(((Creature*)this)->GetEntry());
+                for (QuestRelationsMap::const_iterator itr = bounds.first; itr != bounds.second; ++itr)
+                {
+                    Quest const* pQuest = sObjectMgr.GetQuestTemplate(itr->second);
+                    if (target->CanRewardQuest(pQuest, false))
                     {
-                        Unit* unit = (Unit*)this; // hunters mark effects should only be visible to owners and not all players
-                        if (!unit->HasAuraTypeWithCaster(SPELL_AURA_MOD_STALKED, target->GetObjectGuid()))
-                            dynflagsValue &= ~UNIT_DYNFLAG_TRACK_UNIT;
+                        appendValue &= ~UNIT_NPC_FLAG_FLIGHTMASTER;
+                        break;
                     }
-
-                    *data << dynflagsValue;
                 }
-                else if (index == UNIT_FIELD_FACTIONTEMPLATE)
+            }
+
+            return appendValue;
+        }
+        // FIXME: Some values at server stored in float format but must be sent to client in uint32 format
+        case UNIT_FIELD_KIND_ATTACK_TIME:
+            return uint32(m_floatValues[index] < 0 ? 0 : m_floatValues[index]);
+        // there are some float values which may be negative or can't get negative due to other checks
+        case UNIT_FIELD_KIND_FLOAT:
+            return uint32(m_floatValues[index]);
+        case UNIT_FIELD_KIND_HEALTH:
+        {
+            perViewer = true;
+            uint32 value = m_uint32Values[index];
+
+            // Fog of War: replace absolute health values with percentages for non-allied units according to settings
+            if (!static_cast<const Unit*>(this)->IsFogOfWarVisibleHealth(target))
+            {
+                switch (index)
                 {
-                    uint32 value = m_uint32Values[index];
+                    case UNIT_FIELD_HEALTH:     value = uint32(ceil((100.0 * value) / m_uint32Values[UNIT_FIELD_MAXHEALTH]));   break;
+                    case UNIT_FIELD_MAXHEALTH:  value = 100;                                                                    break;
+                }
+            }
 
-                    // [XFACTION]: Alter faction if detected crossfaction group interaction when updating faction field:
-                    if (this != target && GetTypeId() == TYPEID_PLAYER)
-                    {
-                        Player const* thisPlayer = static_cast<Player const*>(this);
+            return value;
+        }
+        // Fog of War: hide stat values for non-allied units according to settings
+        case UNIT_FIELD_KIND_FOG_STAT:
+            perViewer = true;
+            return static_cast<const Unit*>(this)->IsFogOfWarVisibleStats(target) ? m_uint32Values[index] : 0;
+        // Gamemasters should be always able to select units - remove not selectable flag
+        case UNIT_FIELD_KIND_FLAGS:
+            perViewer = true;
+            return target->isGameMaster() ? (m_uint32Values[index] & ~UNIT_FLAG_NOT_SELECTABLE) : m_uint32Values[index];
+        // Hide lootable animation for unallowed players
+        // Handle tapped flag
+        case UNIT_FIELD_KIND_DYNAMIC_FLAGS:
+        {
+            if (GetTypeId() != TYPEID_UNIT)
+                return m_uint32Values[index];
 
-                        if (sWorld.getConfig(CONFIG_BOOL_ALLOW_TWO_SIDE_INTERACTION_GROUP) && target->IsInGroup(thisPlayer))
-                        {
-                            const uint32 targetTeam = target->GetTeam();
-
-                            if (thisPlayer->GetTeam() != targetTeam && value == Player::getFactionForRace(thisPlayer->getRace()))
-                            {
-                                switch (targetTeam)
-                                {
-                                    case ALLIANCE:  value = 1054;   break;  // "Alliance Generic"
-                                    case HORDE:     value = 1495;   break;  // "Horde Generic"
-                                }
-                            }
-                        }
-                    }
+            perViewer = true;
+            Creature* creature = (Creature*)this;
+            uint32 dynflagsValue = m_uint32Values[index];
+            bool setTapFlags = false;
+
+            if (creature->isAlive())
+            {
+                // creature is alive so, not lootable
+                dynflagsValue = dynflagsValue & ~UNIT_DYNFLAG_LOOTABLE;
 
-                    *data << value;
+                if (creature->isInCombat())
+                {
+                    // as creature is in combat we have to manage tap flags
+                    setTapFlags = true;
                 }
-                else                                        // Unhandled index, just send
+                else
                 {
-                    // send in current format (float as float, uint32 as uint32)
-                    *data << m_uint32Values[index];
+                    // creature is not in combat so its not tapped
+                    dynflagsValue = dynflagsValue & ~UNIT_DYNFLAG_TAPPED;
+                    //sLog.outString(">> %s is not in combat so not tapped by %s", this->GetGuidStr().c_str(), target->GetGuidStr().c_str());
                 }
             }
-        }
-    }
-    else if (isType(TYPEMASK_CORPSE))                       // corpse case
-    {
-        for (uint16 index = 0; index < m_valuesCount; ++index)
-        {
-            if (updateMask->GetBit(index))
+            else
             {
-                if (index == CORPSE_FIELD_BYTES_1)
+                // check loot flag
+                if (creature->m_loot && creature->m_loot->CanLoot(target))
                 {
-                    uint32 value = m_uint32Values[index];
-
-                    // [XFACTION]: Alter race field if detected crossfaction group interaction:
-                    if (sWorld.getConfig(CONFIG_BOOL_ALLOW_TWO_SIDE_INTERACTION_GROUP))
-                    {
-                        Corpse const* thisCorpse = static_cast<Corpse const*>(this);
-                        ObjectGuid const& ownerGuid = thisCorpse->GetOwnerGuid();
-                        Group const* targetGroup = target->GetGroup();
-
-                        if (ownerGuid != target->GetObjectGuid() && targetGroup && targetGroup->IsMember(ownerGuid))
-                        {
-                            const uint8 targetRace = target->getRace();
+                    // creature is dead and this player can loot it
+                    dynflagsValue = dynflagsValue | UNIT_DYNFLAG_LOOTABLE;
+                    //sLog.outString(">> %s is lootable for %s", this->GetGuidStr().c_str(), target->GetGuidStr().c_str());
+                }
+                else
+                {
+                    // creature is dead but this player cannot loot it
+                    dynflagsValue = dynflagsValue & ~UNIT_DYNFLAG_LOOTABLE;
+                    //sLog.outString(">> %s is not lootable for %s", this->GetGuidStr().c_str(), target->GetGuidStr().c_str());
+                }
 
-                            if (Player::TeamForRace(thisCorpse->getRace()) != Player::TeamForRace(targetRace))
-                                value = ((value &~ uint32(0xFF << 8)) | (uint32(targetRace) << 8));
-                        }
-                    }
+                // as creature is died we have to manage tap flags
+                setTapFlags = true;
+            }
 
-                    *data << value;
+            // check tap flags
+            if (setTapFlags)
+            {
+                if (creature->IsTappedBy(target))
+                {
+                    // creature is in combat or died and tapped by this player
+                    dynflagsValue = dynflagsValue & ~UNIT_DYNFLAG_TAPPED;
+                    //sLog.outString(">> %s is tapped by %s", this->GetGuidStr().c_str(), target->GetGuidStr().c_str());
                 }
                 else
-                    *data << m_uint32Values[index];         // other cases
+                {
+                    // creature is in combat or died but not tapped by this player
+                    dynflagsValue = dynflagsValue | UNIT_DYNFLAG_TAPPED;
+                    //sLog.outString(">> %s is not tapped by %s", this->GetGuidStr().c_str(), target->GetGuidStr().c_str());
+                }
             }
+
+            if (GetTypeId() == TYPEID_UNIT || GetTypeId() == TYPEID_PLAYER)
+            {
+                Unit* unit = (Unit*)this; // hunters mark effects should only be visible to owners and not all players
+                if (!unit->HasAuraTypeWithCaster(SPELL_AURA_MOD_STALKED, target->GetObjectGuid()))
+                    dynflagsValue &= ~UNIT_DYNFLAG_TRACK_UNIT;
+            }
+
+            return dynflagsValue;
         }
-    }
-    else if (isType(TYPEMASK_GAMEOBJECT))                   // gameobject case
-    {
-        for (uint16 index = 0; index < m_valuesCount; ++index)
+        case UNIT_FIELD_KIND_FACTION:
         {
-            if (updateMask->GetBit(index))
+            perViewer = true;
+            uint32 value = m_uint32Values[index];
+
+            // [XFACTION]: Alter faction if detected crossfaction group interaction when updating faction field:
+            if (this != target && GetTypeId() == TYPEID_PLAYER)
             {
-                // send in current format (float as float, uint32 as uint32)
-                if (index == GAMEOBJECT_DYN_FLAGS)
+                Player const* thisPlayer = static_cast<Player const*>(this);
+
+                if (sWorld.getConfig(CONFIG_BOOL_ALLOW_TWO_SIDE_INTERACTION_GROUP) && target->IsInGroup(thisPlayer))
                 {
-                    if (IsActivateToQuest)
+                    const uint32 targetTeam = target->GetTeam();
+
+                    if (thisPlayer->GetTeam() != targetTeam && value == Player::getFactionForRace(thisPlayer->getRace()))
                     {
-                        GameObject const* gameObject = static_cast<GameObject const*>(this);
-                        switch (((GameObject*)this)->GetGoType())
+                        switch (targetTeam)
                         {
-                            case GAMEOBJECT_TYPE_QUESTGIVER:
-                            case GAMEOBJECT_TYPE_CHEST:
-                                if (gameObject->GetLootState() == GO_READY || gameObject->GetLootState() == GO_ACTIVATED)
-                                    *data << uint16(GO_DYNFLAG_LO_ACTIVATE | GO_DYNFLAG_LO_SPARKLE);
-                                else
-                                    *data << uint16(0);
-                                *data << uint16(0);
-                                break;
-                            case GAMEOBJECT_TYPE_GENERIC:
-                            case GAMEOBJECT_TYPE_SPELL_FOCUS:
-                            case GAMEOBJECT_TYPE_GOOBER:
-                                *data << uint16(GO_DYNFLAG_LO_ACTIVATE);
-                                *data << uint16(0);
-                                break;
-                            default:
-                                *data << uint32(0);         // unknown, not happen.
-                                break;
+                            case ALLIANCE:  value = 1054;   break;  // "Alliance Generic"
+                            case HORDE:     value = 1495;   break;  // "Horde Generic"
                         }
                     }
-                    else
-                        *data << uint32(0);                 // disable quest object
                 }
-                else
-                    *data << m_uint32Values[index];         // other cases
-            }
-        }
-    }
-    else                                                    // other objects case (no special index checks)
-    {
-        for (uint16 index = 0; index < m_valuesCount; ++index)
-        {
-            if (updateMask->GetBit(index))
-            {
-                // send in current format (float as float, uint32 as uint32)
-                *data << m_uint32Values[index];
             }
+
+            return value;
         }
+        default:                                            // Unhandled index, send in current format (float as float, uint32 as uint32)
+            return m_uint32Values[index];
     }
 }
 
 void Object::ClearUpdateMask(bool remove)
 {
     if (m_uint32Values)
-    {
-        for (uint16 index = 0; index < m_valuesCount; ++index)
-            m_changedValues[index] = false;
-    }
+        m_changedValues.Clear();
 
     if (m_objectUpdated)
     {
@@ -682,9 +738,7 @@ bool Object::LoadValues(const char* data)
 
 void Object::_SetUpdateBits(UpdateMask* updateMask, Player* /*target*/) const
 {
-    for (uint16 index = 0; index < m_valuesCount; ++index)
-        if (m_changedValues[index])
-            updateMask->SetBit(index);
+    *updateMask |= m_changedValues;
 }
 
 void Object::_SetCreateBits(UpdateMask* updateMask, Player* /*target*/) const
@@ -701,7 +755,7 @@ void Object::SetInt32Value(uint16 index, int32 value)
     if (m_int32Values[index] != value)
     {
         m_int32Values[index] = value;
-        m_changedValues[index] = true;
+        m_changedValues.SetBit(index);
         MarkForClientUpdate();
     }
 }
@@ -713,7 +767,7 @@ void Object::SetUInt32Value(uint16 index, uint32 value)
     if (m_uint32Values[index] != value)
     {
         m_uint32Values[index] = value;
-        m_changedValues[index] = true;
+        m_changedValues.SetBit(index);
         MarkForClientUpdate();
     }
 }
@@ -725,8 +779,8 @@ void Object::SetUInt64Value(uint16 index, const uint64& value)
     {
         m_uint32Values[index] = *((uint32*)&value);
         m_uint32Values[index + 1] = *(((uint32*)&value) + 1);
-        m_changedValues[index] = true;
-        m_changedValues[index + 1] = true;
+        m_changedValues.SetBit(index);
+        m_changedValues.SetBit(index + 1);
         MarkForClientUpdate();
     }
 }
@@ -738,7 +792,7 @@ void Object::SetFloatValue(uint16 index, float value)
     if (m_floatValues[index] != value)
     {
         m_floatValues[index] = value;
-        m_changedValues[index] = true;
+        m_changedValues.SetBit(index);
         MarkForClientUpdate();
     }
 }
@@ -757,7 +811,7 @@ void Object::SetByteValue(uint16 index, uint8 offset, uint8 value)
     {
         m_uint32Values[index] &= ~uint32(uint32(0xFF) << (offset * 8));
         m_uint32Values[index] |= uint32(uint32(value) << (offset * 8));
-        m_changedValues[index] = true;
+        m_changedValues.SetBit(index);
         MarkForClientUpdate();
     }
 }
@@ -776,7 +830,7 @@ void Object::SetUInt16Value(uint16 index, uint8 offset, uint16 value)
     {
         m_uint32Values[index] &= ~uint32(uint32(0xFFFF) << (offset * 16));
         m_uint32Values[index] |= uint32(uint32(value) << (offset * 16));
-        m_changedValues[index] = true;
+        m_changedValues.SetBit(index);
         MarkForClientUpdate();
     }
 }
@@ -838,7 +892,7 @@ void Object::SetFlag(uint16 index, uint32 newFlag)
     if (oldval != newval)
     {
         m_uint32Values[index] = newval;
-        m_changedValues[index] = true;
+        m_changedValues.SetBit(index);
         MarkForClientUpdate();
     }
 }
@@ -852,7 +906,7 @@ void Object::RemoveFlag(uint16 index, uint32 oldFlag)
     if (oldval != newval)
     {
         m_uint32Values[index] = newval;
-        m_changedValues[index] = true;
+        m_changedValues.SetBit(index);
         MarkForClientUpdate();
     }
 }
@@ -870,7 +924,7 @@ void Object::SetByteFlag(uint16 index, uint8 offset, uint8 newFlag)
     if (!(uint8(m_uint32Values[index] >> (offset * 8)) & newFlag))
     {
         m_uint32Values[index] |= uint32(uint32(newFlag) << (offset * 8));
-        m_changedValues[index] = true;
+        m_changedValues.SetBit(index);
         MarkForClientUpdate();
     }
 }
@@ -888,7 +942,7 @@ void Object::RemoveByteFlag(uint16 index, uint8 offset, uint8 oldFlag)
     if (uint8(m_uint32Values[index] >> (offset * 8)) & oldFlag)
     {
         m_uint32Values[index] &= ~uint32(uint32(oldFlag) << (offset * 8));
-        m_changedValues[index] = true;
+        m_changedValues.SetBit(index);
         MarkForClientUpdate();
     }
 }
@@ -900,7 +954,7 @@ void Object::SetShortFlag(uint16 index, bool highpart, uint16 newFlag)
     if (!(uint16(m_uint32Values[index] >> (highpart ? 16 : 0)) & newFlag))
     {
         m_uint32Values[index] |= uint32(uint32(newFlag) << (highpart ? 16 : 0));
-        m_changedValues[index] = true;
+        m_changedValues.SetBit(index);
         MarkForClientUpdate();
     }
 }
@@ -912,7 +966,7 @@ void Object::RemoveShortFlag(uint16 index, bool highpart, uint16 oldFlag)
     if (uint16(m_uint32Values[index] >> (highpart ? 16 : 0)) & oldFlag)
     {
         m_uint32Values[index] &= ~uint32(uint32(oldFlag) << (highpart ? 16 : 0));
-        m_changedValues[index] = true;
+        m_changedValues.SetBit(index);
         MarkForClientUpdate();
     }
 }
@@ -934,7 +988,7 @@ bool Object::PrintEntryError(char const* descr) const
 }
 
 
-void Object::BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players) const
+void Object::BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players, ValuesUpdateCache* cache) const
 {
     UpdateDataMapType::iterator iter = update_players.find(pl);
 
@@ -945,7 +999,10 @@ void Object::BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_play
         iter = p.first;
     }
 
-    BuildValuesUpdateBlockForPlayer(&iter->second, iter->first);
+    if (cache)
+        BuildValuesUpdateBlockForPlayer(&iter->second, iter->first, *cache);
+    else
+        BuildValuesUpdateBlockForPlayer(&iter->second, iter->first);
 }
 
 void Object::AddToClientUpdateList()
@@ -980,7 +1037,7 @@ void Object::MarkForClientUpdate()
 
 void Object::ForceValuesUpdateAtIndex(uint16 index)
 {
-    m_changedValues[index] = true;
+    m_changedValues.SetBit(index);
     if (m_inWorld && !m_objectUpdated)
     {
         AddToClientUpdateList();
@@ -991,8 +1048,8 @@ void Object::ForceValuesUpdateAtIndex(uint16 index)
 WorldObject::WorldObject() :
     m_isOnEventNotified(false),
     m_currMap(nullptr), m_mapId(0),
-    m_InstanceId(0), m_isActiveObject(false),
-    m_visibilityData(this)
+    m_InstanceId(0), m_isActiveObject(false), m_updateEpoch(0),
+    m_farFlushTime(0), m_visibilityData(this)
 {
 }
 
@@ -1640,6 +1697,26 @@ void WorldObject::SendMessageToSetExcept(WorldPacket& data, Player const* skippe
     }
 }
 
+void WorldObject::SendMessageToInterestedExcept(WorldPacket const& data, Player const* skipped_receiver, float nearDistance) const
+{
+    if (!IsInWorld())
+        return;
+
+    CellArea area = Cell::CalculateCellArea(GetPositionX(), GetPositionY(), GetMap()->GetVisibilityDistance());
+    GetMap()->VisitCameras(area, [&](Camera* camera)
+    {
+        Player* owner = camera->GetOwner();
+        if (owner == skipped_receiver)
+            return;
+
+        if (!camera->GetBody()->IsWithinDist(this, nearDistance, false) && owner->GetSelectionGuid() != GetObjectGuid())
+            return;
+
+        if (WorldSession* session = owner->GetSession())
+            session->SendPacket(data);
+    });
+}
+
 void WorldObject::SendObjectDeSpawnAnim(ObjectGuid guid) const
 {
     WorldPacket data(SMSG_GAMEOBJECT_DESPAWN_ANIM, 8);
@@ -2045,33 +2122,96 @@ struct WorldObjectChangeAccumulator
 {
     UpdateDataMapType& i_updateDatas;
     WorldObject& i_object;
-    WorldObjectChangeAccumulator(WorldObject& obj, UpdateDataMapType& d) : i_updateDatas(d), i_object(obj)
+    ValuesUpdateCache i_cache;                              // all other viewers get the same fields
+    ValuesUpdateCache i_farCache;                           // viewers in the far band when no flush is due
+    float i_farDistance;                                    // 0 when every viewer gets all changes
+    bool i_farHasChanges;                                   // changes left for far viewers
+    bool i_farSkipped;                                      // a far viewer did not get the coalesced fields
+    WorldObjectChangeAccumulator(WorldObject& obj, UpdateDataMapType& d, float farDistance, bool farHasChanges) :
+        i_updateDatas(d), i_object(obj), i_farDistance(farDistance), i_farHasChanges(farHasChanges), i_farSkipped(false)
     {
+        i_farCache.farBand = true;
+
         // send self fields changes in another way, otherwise
         // with new camera system when player's camera too far from player, camera wouldn't receive packets and changes from player
         if (i_object.isType(TYPEMASK_PLAYER))
             i_object.BuildUpdateDataForPlayer((Player*)&i_object, i_updateDatas);
     }
 
-    void Visit(CameraMapType& m)
+    void Visit(Camera* camera)
     {
-        for (auto& iter : m)
+        Player* owner = camera->GetOwner();
+        if (owner == &i_object || !owner->HaveAtClient(&i_object))
+            return;
+
+        if (i_farDistance > 0.0f && !camera->GetBody()->IsWithinDist(&i_object, i_farDistance, false) &&
+                owner->GetSelectionGuid() != i_object.GetObjectGuid())
         {
-            Player* owner = iter.getSource()->GetOwner();
-            if (owner != &i_object && owner->HaveAtClient(&i_object))
-                i_object.BuildUpdateDataForPlayer(owner, i_updateDatas);
+            i_farSkipped = true;
+            if (i_farHasChanges)
+                i_object.BuildUpdateDataForPlayer(owner, i_updateDatas, &i_farCache);
+            return;
         }
-    }
 
-    template<class SKIP> void Visit(GridRefManager<SKIP>&) {}
+        i_object.BuildUpdateDataForPlayer(owner, i_updateDatas, &i_cache);
+    }
 };
 
 void WorldObject::BuildUpdateData(UpdateDataMapType& update_players)
 {
-    WorldObjectChangeAccumulator notifier(*this, update_players);
-    Cell::VisitWorldObjects(this, notifier, GetVisibilityData().GetVisibilityDistance());
+    // viewers in the far band of a unit get its coalesced fields only when a flush is due, death is always sent
+    float farDistance = isType(TYPEMASK_UNIT) ? GetMap()->GetInterestFarDistance() : 0.0f;
+    if (farDistance > 0.0f)
+    {
+        if (!m_farPendingValues.GetCount())
+            m_farPendingValues.SetCount(m_valuesCount);
+
+        uint32 now = WorldTimer::getMSTime();
+        if (WorldTimer::getMSTimeDiff(m_farFlushTime, now) >= sWorld.getConfig(CONFIG_UINT32_INTEREST_FAR_INTERVAL) ||
+                !static_cast<Unit*>(this)->isAlive())
+        {
+            m_changedValues |= m_farPendingValues;
+            m_farPendingValues.Clear();
+            m_farFlushTime = now;
+            farDistance = 0.0f;
+        }
+    }
+
+    if (!m_changedValues.IsEmpty())
+    {
+        bool farHasChanges = true;
+        if (farDistance > 0.0f)
+        {
+            UpdateMask farChanges = m_changedValues;
+            RemoveFarCoalescedBits(farChanges);
+            farHasChanges = !farChanges.IsEmpty();
+        }
+
+        WorldObjectChangeAccumulator notifier(*this, update_players, farDistance, farHasChanges);
+        CellArea area = Cell::CalculateCellArea(GetPositionX(), GetPositionY(), GetVisibilityData().GetVisibilityDistance() + GetObjectBoundingRadius());
+        GetMap()->VisitCameras(area, [&notifier](Camera* camera)
+        {
+            notifier.Visit(camera);
+        });
+
+        if (notifier.i_farSkipped)
+        {
+            m_changedValues.VisitSetBits([this](uint32 index)
+            {
+                if ((index >= UNIT_FIELD_HEALTH && index <= UNIT_FIELD_MAXPOWER5) || (index >= UNIT_FIELD_AURA && index <= UNIT_FIELD_AURASTATE))
+                    m_farPendingValues.SetBit(index);
+            });
+        }
+    }
 
     ClearUpdateMask(false);
+
+    // come back every tick until the pending fields are flushed
+    if (!m_farPendingValues.IsEmpty() && IsInWorld())
+    {
+        m_objectUpdated = true;
+        GetMap()->DeferUpdateObject(this);
+    }
 }
 
 bool WorldObject::IsControlledByPlayer() const
@@ -23,6 +23,7 @@
 #include "ByteBuffer.h"
 #include "Entities/UpdateFields.h"
 #include "Entities/UpdateData.h"
+#include "Entities/UpdateMask.h"
 #include "Entities/ObjectGuid.h"
 #include "Entities/EntitiesMgr.h"
 #include "Globals/SharedDefines.h"
@@ -126,7 +127,6 @@ class Player;
 class Unit;
 class Group;
 class Map;
-class UpdateMask;
 class InstanceData;
 class TerrainInfo;
 struct MangosStringLocale;
@@ -322,6 +322,20 @@ struct WorldLocation
 };
 
 
+// Values update block of one object shared by all viewers seeing the same changes in a tick.
+// The block is serialized for the first viewer, for the others only the viewer dependent fields are rewritten.
+struct ValuesUpdateCache
+{
+    typedef std::vector<std::pair<size_t, uint16> > ViewerFieldList;     // block position, field index
+
+    ValuesUpdateCache() : built(false), farBand(false) {}
+
+    bool built;
+    bool farBand;                                           // viewers beyond the interest far distance, coalesced fields left out
+    ByteBuffer block;
+    ViewerFieldList viewerFields;
+};
+
 // use this class to measure time between world update ticks
 // essential for units updating their spells after cells become active
 class WorldUpdateCounter
@@ -396,6 +410,7 @@ class Object
         void SendForcedObjectUpdate();
 
         void BuildValuesUpdateBlockForPlayer(UpdateData* data, Player* target) const;
+        void BuildValuesUpdateBlockForPlayer(UpdateData* data, Player* target, ValuesUpdateCache& cache) const;
         void BuildForcedValuesUpdateBlockForPlayer(UpdateData* data, Player* target) const;
         void BuildOutOfRangeUpdateBlock(UpdateData* data) const;
         void BuildMovementUpdateBlock(UpdateData* data, uint8 flags = 0) const;
@@ -605,8 +620,12 @@ class Object
         virtual void _SetCreateBits(UpdateMask* updateMask, Player* target) const;
 
         void BuildMovementUpdate(ByteBuffer* data, uint8 updateFlags) const;
-        void BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, UpdateMask* updateMask, Player* target) const;
-        void BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players) const;
+        void BuildValuesUpdate(uint8 updatetype, ByteBuffer* data, UpdateMask* updateMask, Player* target, ValuesUpdateCache::ViewerFieldList* viewerFields = nullptr) const;
+        void BuildUpdateDataForPlayer(Player* pl, UpdateDataMapType& update_players, ValuesUpdateCache* cache = nullptr) const;
+
+        // value of an update field as sent to target, perViewer is set when it can differ between viewers
+        uint32 GetUpdateFieldValue(uint16 index, Player* target, bool& perViewer) const;
+        uint32 GetUnitUpdateFieldValue(uint16 index, Player* target, bool& perViewer) const;
 
         uint16 m_objectType;
 
@@ -620,7 +639,7 @@ class Object
             float*  m_floatValues;
         };
 
-        std::vector<bool> m_changedValues;
+        UpdateMask m_changedValues;                         // fields changed since the last client update
 
         uint16 m_valuesCount;
 
@@ -825,6 +844,8 @@ class WorldObject : public Object
         virtual void SendMessageToSet(WorldPacket const& data, bool self) const;
         virtual void SendMessageToSetInRange(WorldPacket const& data, float dist, bool self) const;
         void SendMessageToSetExcept(WorldPacket& data, Player const* skipped_receiver) const;
+        // like SendMessageToSetExcept, but only to viewers within nearDistance or targeting this object
+        void SendMessageToInterestedExcept(WorldPacket const& data, Player const* skipped_receiver, float nearDistance) const;
 
         void MonsterSay(const char* text, uint32 language, Unit const* target = nullptr) const;
         void MonsterYell(const char* text, uint32 language, Unit const* target = nullptr) const;
@@ -881,6 +902,15 @@ class WorldObject : public Object
 
         ViewPoint& GetViewPoint() { return m_viewPoint; }
 
+        // stamp the object for a map update pass, false if it was already collected in that pass
+        bool MarkForUpdate(uint32 epoch)
+        {
+            if (m_updateEpoch == epoch)
+                return false;
+            m_updateEpoch = epoch;
+            return true;
+        }
+
         // ASSERT print helper
         bool PrintCoordinatesError(float x, float y, float z, char const* descr) const;
 
@@ -949,6 +979,10 @@ class WorldObject : public Object
         Position m_position;
         ViewPoint m_viewPoint;
         bool m_isActiveObject;
+        uint32 m_updateEpoch;                               // last map update pass the object was collected in
+
+        UpdateMask m_farPendingValues;                      // coalesced fields changed since the last far band flush
+        uint32 m_farFlushTime;
 };
 
 #endif
@@ -194,6 +194,68 @@ typedef std::set<ObjectGuid> GuidSet;
 typedef std::list<ObjectGuid> GuidList;
 typedef std::vector<ObjectGuid> GuidVector;
 
+// Set of guids kept as a sorted vector: lookups touch contiguous memory and copies are a single allocation
+class FlatGuidSet
+{
+    public:
+        typedef GuidVector::const_iterator iterator;
+        typedef GuidVector::const_iterator const_iterator;
+
+        const_iterator begin() const { return m_guids.begin(); }
+        const_iterator end() const { return m_guids.end(); }
+        bool empty() const { return m_guids.empty(); }
+        size_t size() const { return m_guids.size(); }
+        void clear() { m_guids.clear(); }
+
+        const_iterator find(ObjectGuid const& guid) const
+        {
+            const_iterator itr = std::lower_bound(m_guids.begin(), m_guids.end(), guid);
+            return itr != m_guids.end() && *itr == guid ? itr : m_guids.end();
+        }
+
+        bool insert(ObjectGuid const& guid)
+        {
+            GuidVector::iterator itr = std::lower_bound(m_guids.begin(), m_guids.end(), guid);
+            if (itr != m_guids.end() && *itr == guid)
+                return false;
+
+            m_guids.insert(itr, guid);
+            return true;
+        }
+
+        bool erase(ObjectGuid const& guid)
+        {
+            GuidVector::iterator itr = std::lower_bound(m_guids.begin(), m_guids.end(), guid);
+            if (itr == m_guids.end() || *itr != guid)
+                return false;
+
+            m_guids.erase(itr);
+            return true;
+        }
+
+        const_iterator erase(const_iterator itr) { return m_guids.erase(itr); }
+
+        // removes a sorted batch of guids in one pass instead of one shift per guid
+        template<class SortedGuids>
+        void EraseSorted(SortedGuids const& sortedGuids)
+        {
+            GuidVector::iterator out = m_guids.begin();
+            typename SortedGuids::const_iterator remove = sortedGuids.begin();
+            for (GuidVector::iterator itr = m_guids.begin(); itr != m_guids.end(); ++itr)
+            {
+                while (remove != sortedGuids.end() && *remove < *itr)
+                    ++remove;
+
+                if (remove == sortedGuids.end() || *itr < *remove)
+                    *out++ = *itr;
+            }
+            m_guids.erase(out, m_guids.end());
+        }
+
+    private:
+        GuidVector m_guids;
+};
+
 // minimum buffer size for packed guid is 9 bytes
 #define PACKED_GUID_MIN_BUFFER_SIZE 9
 
@@ -28,6 +28,7 @@
 #include "Guilds/GuildMgr.h"
 #include "Entities/GossipDef.h"
 #include "Social/SocialMgr.h"
+#include "Maps/Map.h"
 
 // Charters ID in item_template
 #define GUILD_CHARTER               5863
@@ -316,30 +317,47 @@ void WorldSession::HandlePetitionSignOpcode(WorldPacket& recv_data)
 
     uint32 petitionLowGuid = petitionGuid.GetCounter();
 
-    QueryResult* result = CharacterDatabase.PQuery(
-                              "SELECT ownerguid, "
-                              "  (SELECT COUNT(playerguid) FROM petition_sign WHERE petition_sign.petitionguid = '%u') AS signs "
-                              "FROM petition WHERE petitionguid = '%u'", petitionLowGuid, petitionLowGuid);
+    // everything needed to sign in one query, the result is continued in the signer's session
+    // so a map change meanwhile still gets the sign applied or answered
+    ObjectGuid const signerGuid = _player->GetObjectGuid();
+    CharacterDatabase.AsyncPQuery(GetQueryResultQueue(), [this, signerGuid, petitionGuid](QueryResult* result)
+    {
+        // nobody left to answer once the signer logged out
+        if (!GetPlayer() || GetPlayer()->GetObjectGuid() != signerGuid)
+            return;
+
+        HandlePetitionSign(result, petitionGuid);
+    },
+    "SELECT ownerguid, "
+    "  (SELECT COUNT(playerguid) FROM petition_sign WHERE petition_sign.petitionguid = '%u') AS signs, "
+    "  (SELECT race FROM characters WHERE characters.guid = petition.ownerguid) AS race, "
+    "  (SELECT COUNT(playerguid) FROM petition_sign WHERE player_account = '%u' AND petition_sign.petitionguid = '%u') AS account_signs "
+    "FROM petition WHERE petitionguid = '%u'", petitionLowGuid, GetAccountId(), petitionLowGuid, petitionLowGuid);
+}
 
+void WorldSession::HandlePetitionSign(QueryResult* result, ObjectGuid petitionGuid)
+{
     if (!result)
     {
         sLog.outError("any petition on server...");
         return;
     }
 
+    uint32 petitionLowGuid = petitionGuid.GetCounter();
+
     Field* fields = result->Fetch();
     uint32 ownerLowGuid = fields[0].GetUInt32();
     ObjectGuid ownerGuid = ObjectGuid(HIGHGUID_PLAYER, ownerLowGuid);
     uint8 signs = fields[1].GetUInt8();
-
-    delete result;
+    Team ownerTeam = fields[2].IsNULL() ? TEAM_NONE : Player::TeamForRace(fields[2].GetUInt8());
+    bool signedByAccount = fields[3].GetUInt32() != 0;
 
     if (ownerGuid == _player->GetObjectGuid())
         return;
 
     // not let enemies sign guild charter
     if (!sWorld.getConfig(CONFIG_BOOL_ALLOW_TWO_SIDE_INTERACTION_GUILD) &&
-            GetPlayer()->GetTeam() != sObjectMgr.GetPlayerTeamByGUID(ownerGuid))
+            GetPlayer()->GetTeam() != ownerTeam)
     {
         SendGuildCommandResult(GUILD_CREATE_S, "", ERR_GUILD_NOT_ALLIED);
         return;
@@ -361,11 +379,8 @@ void WorldSession::HandlePetitionSignOpcode(WorldPacket& recv_data)
 
     // client doesn't allow to sign petition two times by one character, but not check sign by another character from same account
     // not allow sign another player from already sign player account
-    result = CharacterDatabase.PQuery("SELECT playerguid FROM petition_sign WHERE player_account = '%u' AND petitionguid = '%u'", GetAccountId(), petitionLowGuid);
-
-    if (result)
+    if (signedByAccount)
     {
-        delete result;
         WorldPacket data(SMSG_PETITION_SIGN_RESULTS, (8 + 8 + 4));
         data << ObjectGuid(petitionGuid);
         data << ObjectGuid(_player->GetObjectGuid());
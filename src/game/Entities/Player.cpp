@@ -15306,7 +15306,9 @@ void Player::SaveToDB()
     DEBUG_FILTER_LOG(LOG_FILTER_PLAYER_STATS, "The value of player %s at save: ", m_name.c_str());
     outDebugStatsValues();
 
-    CharacterDatabase.BeginTransaction();
+    // saves of different characters may commit in parallel. item_instance and mail rows only move to another
+    // character through trade, mail and auction transactions, those are unkeyed and so ordered with all saves
+    CharacterDatabase.BeginTransaction(GetGUIDLow());
 
     UpdateHonor();
 
@@ -17569,13 +17571,13 @@ void Player::UpdateVisibilityOf(WorldObject const* viewPoint, WorldObject* targe
 }
 
 template<class T>
-inline void UpdateVisibilityOf_helper(GuidSet& s64, T* target)
+inline void UpdateVisibilityOf_helper(FlatGuidSet& s64, T* target)
 {
     s64.insert(target->GetObjectGuid());
 }
 
 template<>
-inline void UpdateVisibilityOf_helper(GuidSet& s64, GameObject* target)
+inline void UpdateVisibilityOf_helper(FlatGuidSet& s64, GameObject* target)
 {
     if (!target->IsTransport())
         s64.insert(target->GetObjectGuid());
@@ -18245,7 +18247,7 @@ void Player::UpdateEverything()
     UpdateData updateDataCreature;
     UpdateData updateDataRest;
     WorldPacket packet;
-    for (GuidSet::const_iterator itr = m_clientGUIDs.begin(); itr != m_clientGUIDs.end(); ++itr)
+    for (FlatGuidSet::const_iterator itr = m_clientGUIDs.begin(); itr != m_clientGUIDs.end(); ++itr)
     {
         if (WorldObject* obj = GetMap()->GetWorldObject(*itr))
         {
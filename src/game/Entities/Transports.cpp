@@ -531,14 +531,18 @@ void Transport::UpdateForMap(Map const* targetMap)
 
     if (GetMapId() == targetMap->GetId())
     {
+        // transport create block does not depend on the viewer, build and compress it once for all players
+        WorldPacket packet;
         for (const auto& itr : pl)
         {
             if (this != itr.getSource()->GetTransport())
             {
-                UpdateData transData;
-                BuildCreateUpdateBlockForPlayer(&transData, itr.getSource());
-                WorldPacket packet;
-                transData.BuildPacket(packet, true);
+                if (packet.empty())
+                {
+                    UpdateData transData;
+                    BuildCreateUpdateBlockForPlayer(&transData, itr.getSource());
+                    transData.BuildPacket(packet, true);
+                }
                 itr.getSource()->SendDirectMessage(packet);
             }
         }
@@ -296,6 +296,7 @@ Unit::Unit() :
     m_combatData(new CombatData(this)),
     m_spellUpdateHappening(false),
     m_spellProcsHappening(false),
+    m_aiUpdateDiff(0),
     m_auraUpdateMask(0),
     m_ignoreRangedTargets(false),
     m_combatManager(this)
@@ -465,7 +466,16 @@ void Unit::Update(const uint32 diff)
     i_motionMaster.UpdateMotion(diff);
 
     if (AI() && isAlive())
-        AI()->UpdateAI(diff);   // AI not react good at real update delays (while freeze in non-active part of map)
+    {
+        // overloaded maps update idle creatures less often, the AI gets the whole elapsed time
+        m_aiUpdateDiff += diff;
+        uint32 interval = GetTypeId() == TYPEID_UNIT && !isInCombat() && !GetMasterGuid() ? GetMap()->GetOverloadGovernor().GetIdleAIInterval() : 0;
+        if (m_aiUpdateDiff >= interval)
+        {
+            AI()->UpdateAI(m_aiUpdateDiff);   // AI not react good at real update delays (while freeze in non-active part of map)
+            m_aiUpdateDiff = 0;
+        }
+    }
 
     GetCombatManager().Update(diff);
 
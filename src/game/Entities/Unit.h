@@ -2550,6 +2550,8 @@ class Unit : public WorldObject
         bool m_spellUpdateHappening;
         // Need to safeguard aura proccing in Unit::ProcDamageAndSpell
         bool m_spellProcsHappening;
+        // time not yet passed to UpdateAI, see OverloadGovernor::GetIdleAIInterval
+        uint32 m_aiUpdateDiff;
         std::vector<SpellAuraHolder*> m_delayedSpellAuraHolders;
 
         bool m_noThreat;
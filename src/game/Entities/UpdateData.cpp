@@ -36,6 +36,11 @@ void UpdateData::AddOutOfRangeGUID(GuidSet& guids)
     m_outOfRangeGUIDs.insert(guids.begin(), guids.end());
 }
 
+void UpdateData::AddOutOfRangeGUID(FlatGuidSet const& guids)
+{
+    m_outOfRangeGUIDs.insert(guids.begin(), guids.end());
+}
+
 void UpdateData::AddOutOfRangeGUID(ObjectGuid const& guid)
 {
     m_outOfRangeGUIDs.insert(guid);
@@ -47,60 +52,89 @@ void UpdateData::AddUpdateBlock(const ByteBuffer& block)
     ++m_blockCount;
 }
 
-void UpdateData::Compress(void* dst, uint32* dst_size, void* src, int src_size)
+// deflate state of one thread, zlib allocates ~256KB for it so it is reset between packets instead of recreated
+class UpdateCompressor
 {
-    z_stream c_stream;
+    public:
+        UpdateCompressor() : m_initialized(false), m_level(0) {}
+        ~UpdateCompressor()
+        {
+            if (m_initialized)
+                deflateEnd(&m_stream);
+        }
+
+        z_stream* Prepare(int level)
+        {
+            if (!m_initialized)
+            {
+                m_stream.zalloc = (alloc_func)nullptr;
+                m_stream.zfree = (free_func)nullptr;
+                m_stream.opaque = (voidpf)nullptr;
+
+                int z_res = deflateInit(&m_stream, level);
+                if (z_res != Z_OK)
+                {
+                    sLog.outError("Can't compress update packet (zlib: deflateInit) Error code: %i (%s)", z_res, zError(z_res));
+                    return nullptr;
+                }
+
+                m_initialized = true;
+                m_level = level;
+            }
+            else if (m_level != level)
+            {
+                // stream is reset after every packet, so no pending output can be flushed here
+                int z_res = deflateParams(&m_stream, level, Z_DEFAULT_STRATEGY);
+                if (z_res != Z_OK)
+                {
+                    sLog.outError("Can't compress update packet (zlib: deflateParams) Error code: %i (%s)", z_res, zError(z_res));
+                    return nullptr;
+                }
+
+                m_level = level;
+            }
+
+            return &m_stream;
+        }
+
+    private:
+        z_stream m_stream;
+        bool m_initialized;
+        int m_level;
+};
 
-    c_stream.zalloc = (alloc_func)nullptr;
-    c_stream.zfree = (free_func)nullptr;
-    c_stream.opaque = (voidpf)nullptr;
+void UpdateData::Compress(void* dst, uint32* dst_size, void* src, int src_size)
+{
+    static thread_local UpdateCompressor compressor;
 
     // default Z_BEST_SPEED (1)
-    int z_res = deflateInit(&c_stream, sWorld.getConfig(CONFIG_UINT32_COMPRESSION));
-    if (z_res != Z_OK)
-    {
-        sLog.outError("Can't compress update packet (zlib: deflateInit) Error code: %i (%s)", z_res, zError(z_res));
-        *dst_size = 0;
-        return;
-    }
-
-    c_stream.next_out = (Bytef*)dst;
-    c_stream.avail_out = *dst_size;
-    c_stream.next_in = (Bytef*)src;
-    c_stream.avail_in = (uInt)src_size;
-
-    z_res = deflate(&c_stream, Z_NO_FLUSH);
-    if (z_res != Z_OK)
+    z_stream* c_stream = compressor.Prepare(sWorld.getConfig(CONFIG_UINT32_COMPRESSION));
+    if (!c_stream)
     {
-        sLog.outError("Can't compress update packet (zlib: deflate) Error code: %i (%s)", z_res, zError(z_res));
         *dst_size = 0;
         return;
     }
 
-    if (c_stream.avail_in != 0)
-    {
-        sLog.outError("Can't compress update packet (zlib: deflate not greedy)");
-        *dst_size = 0;
-        return;
-    }
+    c_stream->next_out = (Bytef*)dst;
+    c_stream->avail_out = *dst_size;
+    c_stream->next_in = (Bytef*)src;
+    c_stream->avail_in = (uInt)src_size;
 
-    z_res = deflate(&c_stream, Z_FINISH);
+    int z_res = deflate(c_stream, Z_FINISH);
     if (z_res != Z_STREAM_END)
     {
         sLog.outError("Can't compress update packet (zlib: deflate should report Z_STREAM_END instead %i (%s)", z_res, zError(z_res));
         *dst_size = 0;
-        return;
     }
+    else
+        *dst_size = c_stream->total_out;
 
-    z_res = deflateEnd(&c_stream);
+    z_res = deflateReset(c_stream);
     if (z_res != Z_OK)
     {
-        sLog.outError("Can't compress update packet (zlib: deflateEnd) Error code: %i (%s)", z_res, zError(z_res));
+        sLog.outError("Can't compress update packet (zlib: deflateReset) Error code: %i (%s)", z_res, zError(z_res));
         *dst_size = 0;
-        return;
     }
-
-    *dst_size = c_stream.total_out;
 }
 
 bool UpdateData::BuildPacket(WorldPacket& packet, bool hasTransport)
@@ -125,7 +159,7 @@ bool UpdateData::BuildPacket(WorldPacket& packet, bool hasTransport)
 
     size_t pSize = buf.wpos();                              // use real used data size
 
-    if (pSize > 100)                                        // compress large packets
+    if (pSize > sWorld.getConfig(CONFIG_UINT32_COMPRESSION_THRESHOLD))  // compress large packets
     {
         uint32 destsize = compressBound(pSize);
         packet.resize(destsize + sizeof(uint32));
@@ -53,6 +53,7 @@ class UpdateData
         UpdateData();
 
         void AddOutOfRangeGUID(GuidSet& guids);
+        void AddOutOfRangeGUID(FlatGuidSet const& guids);
         void AddOutOfRangeGUID(ObjectGuid const& guid);
         void AddUpdateBlock(const ByteBuffer& block);
         bool BuildPacket(WorldPacket& packet, bool hasTransport = false);
@@ -21,6 +21,10 @@
 
 #include "Errors.h"
 
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 class UpdateMask
 {
     public:
@@ -34,23 +38,54 @@ class UpdateMask
 
         void SetBit(uint32 index)
         {
-            ((uint8*)mUpdateMask)[ index >> 3 ] |= 1 << (index & 0x7);
+            mUpdateMask[index >> 5] |= 1u << (index & 0x1F);
         }
 
         void UnsetBit(uint32 index)
         {
-            ((uint8*)mUpdateMask)[ index >> 3 ] &= (0xff ^ (1 << (index & 0x7)));
+            mUpdateMask[index >> 5] &= ~(1u << (index & 0x1F));
         }
 
         bool GetBit(uint32 index) const
         {
-            return (((uint8*)mUpdateMask)[ index >> 3 ] & (1 << (index & 0x7))) != 0;
+            return (mUpdateMask[index >> 5] & (1u << (index & 0x1F))) != 0;
         }
 
         uint32 GetBlockCount() const { return mBlocks; }
         uint32 GetLength() const { return mBlocks << 2; }
         uint32 GetCount() const { return mCount; }
-        uint8* GetMask() const { return (uint8*)mUpdateMask; }
+        uint32 GetBlock(uint32 block) const { return mUpdateMask[block]; }
+
+        bool IsEmpty() const
+        {
+            for (uint32 i = 0; i < mBlocks; ++i)
+                if (mUpdateMask[i])
+                    return false;
+            return true;
+        }
+
+        // calls visit(index) for every set bit in ascending order, skipping empty blocks whole
+        template<typename Visitor>
+        void VisitSetBits(Visitor&& visit) const
+        {
+            for (uint32 block = 0; block < mBlocks; ++block)
+            {
+                for (uint32 bits = mUpdateMask[block]; bits; bits &= bits - 1)
+                    visit((block << 5) + LowestBit(bits));
+            }
+        }
+
+        // index of the lowest set bit, bits must not be 0
+        static uint32 LowestBit(uint32 bits)
+        {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward(&index, bits);
+            return uint32(index);
+#else
+            return uint32(__builtin_ctz(bits));
+#endif
+        }
 
         void SetCount(uint32 valuesCount)
         {
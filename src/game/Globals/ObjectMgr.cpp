@@ -1419,6 +1419,10 @@ int32 ObjectMgr::GetPlayerMapIdByGUID(ObjectGuid const& guid) const
 // name must be checked to correctness (if received) before call this function
 ObjectGuid ObjectMgr::GetPlayerGuidByName(std::string name) const
 {
+    // prevent DB access for online player
+    if (Player* player = GetPlayer(name.c_str()))
+        return player->GetObjectGuid();
+
     ObjectGuid guid;
 
     CharacterDatabase.escape_string(name);
@@ -28,17 +28,13 @@
 
 using namespace MaNGOS;
 
-void VisibleChangesNotifier::Visit(CameraMapType& m)
-{
-    for (auto& iter : m)
-    {
-        iter.getSource()->UpdateVisibilityOf(&i_object);
-    }
-}
-
 void VisibleNotifier::Notify()
 {
     Player& player = *i_camera.GetOwner();
+
+    std::sort(i_visitedGUIDs.begin(), i_visitedGUIDs.end());
+    i_clientGUIDs.EraseSorted(i_visitedGUIDs);
+
     // at this moment i_clientGUIDs have guids that not iterate at grid level checks
     // but exist one case when this possible and object not out of range: transports
     if (Transport* transport = player.GetTransport())
@@ -56,25 +52,23 @@ void VisibleNotifier::Notify()
     }
 
     // Far objects update on player notify
-    for (GuidSet::iterator itr = i_clientGUIDs.begin(); itr != i_clientGUIDs.end();)
+    for (FlatGuidSet::const_iterator itr = i_clientGUIDs.begin(); itr != i_clientGUIDs.end();)
     {
-        GuidSet::iterator current = itr++;
-        if (WorldObject* obj = player.GetMap()->GetWorldObject(*current))
+        WorldObject* obj = player.GetMap()->GetWorldObject(*itr);
+        if (obj && obj->GetVisibilityData().IsVisibilityOverridden())
         {
-            if (!obj->GetVisibilityData().IsVisibilityOverridden())
-                continue;
-
             player.UpdateVisibilityOf(&player, obj);
-            i_clientGUIDs.erase(current);
+            itr = i_clientGUIDs.erase(itr);
         }
+        else
+            ++itr;
     }
 
     // generate outOfRange for not iterate objects
     i_data.AddOutOfRangeGUID(i_clientGUIDs);
-    for (GuidSet::iterator itr = i_clientGUIDs.begin(); itr != i_clientGUIDs.end(); ++itr)
+    player.m_clientGUIDs.EraseSorted(i_clientGUIDs);
+    for (FlatGuidSet::const_iterator itr = i_clientGUIDs.begin(); itr != i_clientGUIDs.end(); ++itr)
     {
-        player.m_clientGUIDs.erase(*itr);
-
         DEBUG_FILTER_LOG(LOG_FILTER_VISIBILITY_CHANGES, "%s is out of range (no in active cells set) now for %s",
                          itr->GetString().c_str(), player.GetGuidStr().c_str());
     }
@@ -108,7 +102,7 @@ void MessageDeliverer::Visit(CameraMapType& m)
         if (i_toSelf || owner != &i_player)
         {
             if (WorldSession* session = owner->GetSession())
-                session->SendPacket(i_message);
+                i_message.SendTo(*session);
         }
     }
 }
@@ -123,7 +117,7 @@ void MessageDelivererExcept::Visit(CameraMapType& m)
             continue;
 
         if (WorldSession* session = owner->GetSession())
-            session->SendPacket(i_message);
+            i_message.SendTo(*session);
     }
 }
 
@@ -132,7 +126,7 @@ void ObjectMessageDeliverer::Visit(CameraMapType& m)
     for (auto& iter : m)
     {
         if (WorldSession* session = iter.getSource()->GetOwner()->GetSession())
-            session->SendPacket(i_message);
+            i_message.SendTo(*session);
     }
 }
 
@@ -147,7 +141,7 @@ void MessageDistDeliverer::Visit(CameraMapType& m)
                 (!i_dist || iter.getSource()->GetBody()->IsWithinDist(&i_player, i_dist)))
         {
             if (WorldSession* session = owner->GetSession())
-                session->SendPacket(i_message);
+                i_message.SendTo(*session);
         }
     }
 }
@@ -159,7 +153,7 @@ void ObjectMessageDistDeliverer::Visit(CameraMapType& m)
         if (!i_dist || iter.getSource()->GetBody()->IsWithinDist(&i_object, i_dist))
         {
             if (WorldSession* session = iter.getSource()->GetOwner()->GetSession())
-                session->SendPacket(i_message);
+                i_message.SendTo(*session);
         }
     }
 }
@@ -168,7 +162,8 @@ template<class T>
 void ObjectUpdater::Visit(GridRefManager<T>& m)
 {
     for (auto& iter : m)
-        m_objectToUpdateSet.emplace(iter.getSource());
+        if (iter.getSource()->MarkForUpdate(m_epoch))
+            m_objectsToUpdate.push_back(iter.getSource());
 }
 
 bool CannibalizeObjectCheck::operator()(Corpse* u)
@@ -36,7 +36,8 @@ namespace MaNGOS
     {
         Camera& i_camera;
         UpdateData i_data;
-        GuidSet i_clientGUIDs;
+        FlatGuidSet i_clientGUIDs;                          // known at client before the visit
+        GuidVector i_visitedGUIDs;                          // removed from i_clientGUIDs in one batch at Notify
         WorldObjectSet i_visibleNow;
 
         explicit VisibleNotifier(Camera& c) : i_camera(c), i_clientGUIDs(c.GetOwner()->m_clientGUIDs) {}
@@ -45,19 +46,10 @@ namespace MaNGOS
         void Notify(void);
     };
 
-    struct VisibleChangesNotifier
-    {
-        WorldObject& i_object;
-
-        explicit VisibleChangesNotifier(WorldObject& object) : i_object(object) {}
-        template<class T> void Visit(GridRefManager<T>&) {}
-        void Visit(CameraMapType&);
-    };
-
     struct MessageDeliverer
     {
         Player const& i_player;
-        WorldPacket const& i_message;
+        BroadcastPacket i_message;
         bool i_toSelf;
         MessageDeliverer(Player const& pl, WorldPacket const& msg, bool to_self) : i_player(pl), i_message(msg), i_toSelf(to_self) {}
         void Visit(CameraMapType& m);
@@ -66,7 +58,7 @@ namespace MaNGOS
 
     struct MessageDelivererExcept
     {
-        WorldPacket const&  i_message;
+        BroadcastPacket i_message;
         Player const* i_skipped_receiver;
 
         MessageDelivererExcept(WorldPacket const& msg, Player const* skipped)
@@ -78,7 +70,7 @@ namespace MaNGOS
 
     struct ObjectMessageDeliverer
     {
-        WorldPacket const& i_message;
+        BroadcastPacket i_message;
         explicit ObjectMessageDeliverer(WorldPacket const& msg) : i_message(msg) {}
         void Visit(CameraMapType& m);
         template<class SKIP> void Visit(GridRefManager<SKIP>&) {}
@@ -87,7 +79,7 @@ namespace MaNGOS
     struct MessageDistDeliverer
     {
         Player const& i_player;
-        WorldPacket const& i_message;
+        BroadcastPacket i_message;
         bool i_toSelf;
         bool i_ownTeamOnly;
         float i_dist;
@@ -101,7 +93,7 @@ namespace MaNGOS
     struct ObjectMessageDistDeliverer
     {
         WorldObject const& i_object;
-        WorldPacket const& i_message;
+        BroadcastPacket i_message;
         float i_dist;
         ObjectMessageDistDeliverer(WorldObject const& obj, WorldPacket const& msg, float dist) : i_object(obj), i_message(msg), i_dist(dist) {}
         void Visit(CameraMapType& m);
@@ -110,7 +102,7 @@ namespace MaNGOS
 
     struct ObjectUpdater
     {
-        ObjectUpdater(WorldObjectUnSet& otus, const uint32& diff) : m_objectToUpdateSet(otus), m_timeDiff(diff) {}
+        ObjectUpdater(WorldObjectVector& objects, uint32 epoch) : m_objectsToUpdate(objects), m_epoch(epoch) {}
         template<class T> void Visit(GridRefManager<T>& m);
         void Visit(PlayerMapType&) {}
         void Visit(CorpseMapType&) {}
@@ -118,8 +110,8 @@ namespace MaNGOS
         void Visit(CreatureMapType&);
 
         private:
-            WorldObjectUnSet& m_objectToUpdateSet;
-            uint32 m_timeDiff;
+            WorldObjectVector& m_objectsToUpdate;
+            uint32 m_epoch;
     };
 
     struct PlayerVisitObjectsNotifier
@@ -36,14 +36,15 @@ inline void MaNGOS::VisibleNotifier::Visit(GridRefManager<T>& m)
     for (typename GridRefManager<T>::iterator iter = m.begin(); iter != m.end(); ++iter)
     {
         i_camera.UpdateVisibilityOf(iter->getSource(), i_data, i_visibleNow);
-        i_clientGUIDs.erase(iter->getSource()->GetObjectGuid());
+        i_visitedGUIDs.push_back(iter->getSource()->GetObjectGuid());
     }
 }
 
 inline void MaNGOS::ObjectUpdater::Visit(CreatureMapType& m)
 {
     for (auto& iter : m)
-        m_objectToUpdateSet.emplace(iter.getSource());
+        if (iter.getSource()->MarkForUpdate(m_epoch))
+            m_objectsToUpdate.push_back(iter.getSource());
 }
 
 inline void UnitVisitObjectsNotifierWorker(Unit* unitA, Unit* unitB)
@@ -642,6 +642,7 @@ void Group::UpdateOfflineLeader(time_t time, uint32 delay)
 
 void Group::BroadcastPacket(WorldPacket& packet, bool ignorePlayersInBGRaid, int group, ObjectGuid ignore)
 {
+    ::BroadcastPacket broadcast(packet);
     for (GroupReference* itr = GetFirstMember(); itr != nullptr; itr = itr->next())
     {
         Player* pl = itr->getSource();
@@ -649,7 +650,7 @@ void Group::BroadcastPacket(WorldPacket& packet, bool ignorePlayersInBGRaid, int
             continue;
 
         if (pl->GetSession() && (group == -1 || itr->getSubGroup() == group))
-            pl->GetSession()->SendPacket(packet);
+            broadcast.SendTo(*pl->GetSession());
     }
 }
 
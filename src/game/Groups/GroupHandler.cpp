@@ -509,7 +509,8 @@ void WorldSession::HandleGroupChangeSubGroupOpcode(WorldPacket& recv_data)
         group->ChangeMembersGroup(player, groupNr);
     else
     {
-        if (ObjectGuid guid = sObjectMgr.GetPlayerGuidByName(name))
+        // offline members are known to the group, no need to ask the DB
+        if (ObjectGuid guid = group->GetMemberGuid(name))
             group->ChangeMembersGroup(guid, groupNr);
     }
 }
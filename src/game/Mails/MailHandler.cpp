@@ -70,52 +70,105 @@ bool WorldSession::CheckMailBox(ObjectGuid guid) const
  */
 void WorldSession::HandleSendMail(WorldPacket& recv_data)
 {
-    ObjectGuid mailboxGuid;
-    ObjectGuid itemGuid;
+    SendMailRequest request;
     uint64 unk3;
-    std::string receiver, subject, body;
-    uint32 unk1, unk2, money, COD;
     uint8 unk4;
-    recv_data >> mailboxGuid;
-    recv_data >> receiver;
+    recv_data >> request.mailbox;
+    recv_data >> request.receiver;
 
-    recv_data >> subject;
+    recv_data >> request.subject;
 
-    recv_data >> body;
+    recv_data >> request.body;
 
-    recv_data >> unk1;                                      // stationery?
-    recv_data >> unk2;                                      // 0x00000000
+    recv_data >> request.unk1;                              // stationery?
+    recv_data >> request.unk2;                              // 0x00000000
 
-    recv_data >> itemGuid;
+    recv_data >> request.item;
 
-    recv_data >> money >> COD;                              // money and cod
+    recv_data >> request.money >> request.COD;              // money and cod
     recv_data >> unk3;                                      // const 0
     recv_data >> unk4;                                      // const 0
 
     // packet read complete, now do check
 
-    if (!CheckMailBox(mailboxGuid))
+    if (!CheckMailBox(request.mailbox))
         return;
 
-    if (receiver.empty())
+    if (request.receiver.empty())
         return;
 
-    Player* pl = _player;
+    if (!normalizePlayerName(request.receiver))
+    {
+        HandleSendMailTo(request, ObjectGuid(), nullptr, TEAM_NONE, 0, 0);
+        return;
+    }
+
+    // online receiver needs no DB access
+    if (Player* receive = sObjectMgr.GetPlayer(request.receiver.c_str()))
+    {
+        HandleSendMailTo(request, receive->GetObjectGuid(), receive, receive->GetTeam(), receive->GetSession()->GetAccountId(), receive->GetMailSize());
+        return;
+    }
+
+    // offline receiver, everything needed about it in one query instead of blocking the world thread once per value
+    std::string name = request.receiver;
+    CharacterDatabase.escape_string(name);
+
+    // continued in this session, the result of a session gone meanwhile is dropped with it
+    ObjectGuid const senderGuid = _player->GetObjectGuid();
+    CharacterDatabase.AsyncPQuery(GetQueryResultQueue(), [this, senderGuid, request](QueryResult* result)
+    {
+        // the sender may have logged out or left the mailbox meanwhile
+        if (!GetPlayer() || GetPlayer()->GetObjectGuid() != senderGuid || !GetPlayer()->IsInWorld())
+            return;
+
+        if (!CheckMailBox(request.mailbox))
+            return;
+
+        if (!result)
+        {
+            HandleSendMailTo(request, ObjectGuid(), nullptr, TEAM_NONE, 0, 0);
+            return;
+        }
 
-    ObjectGuid rc;
-    if (normalizePlayerName(receiver))
-        rc = sObjectMgr.GetPlayerGuidByName(receiver);
+        Field* fields = result->Fetch();
+        ObjectGuid rc = ObjectGuid(HIGHGUID_PLAYER, fields[0].GetUInt32());
+
+        // the receiver may have logged in meanwhile
+        if (Player* receive = sObjectMgr.GetPlayer(rc))
+            HandleSendMailTo(request, rc, receive, receive->GetTeam(), receive->GetSession()->GetAccountId(), receive->GetMailSize());
+        else
+            HandleSendMailTo(request, rc, nullptr, Player::TeamForRace(fields[1].GetUInt8()), fields[2].GetUInt32(), fields[3].GetUInt32());
+    },
+    //        0     1     2        3
+    "SELECT guid, race, account, (SELECT COUNT(*) FROM mail WHERE receiver = characters.guid) "
+    "FROM characters WHERE name = '%s'", name.c_str());
+}
+
+/**
+ * Sends the mail of a CMSG_SEND_MAIL once its receiver is known.
+ *
+ * @param request the mail as sent by the client.
+ * @param rc the receiver, empty when there is no character of that name.
+ * @param receive the receiver if online.
+ * @param rc_team the team of the receiver.
+ * @param rc_account the account of the receiver.
+ * @param mails_count the number of mails the receiver has.
+ */
+void WorldSession::HandleSendMailTo(SendMailRequest const& request, ObjectGuid rc, Player* receive, Team rc_team, uint32 rc_account, uint32 mails_count)
+{
+    Player* pl = _player;
 
     if (!rc)
     {
         DETAIL_LOG("%s is sending mail to %s (GUID: nonexistent!) with subject %s and body %s includes %u items, %u copper and %u COD copper with unk1 = %u, unk2 = %u",
-                   pl->GetGuidStr().c_str(), receiver.c_str(), subject.c_str(), body.c_str(), itemGuid ? 1 : 0, money, COD, unk1, unk2);
+                   pl->GetGuidStr().c_str(), request.receiver.c_str(), request.subject.c_str(), request.body.c_str(), request.item ? 1 : 0, request.money, request.COD, request.unk1, request.unk2);
         pl->SendMailResult(0, MAIL_SEND, MAIL_ERR_RECIPIENT_NOT_FOUND);
         return;
     }
 
     DETAIL_LOG("%s is sending mail to %s with subject %s and body %s includes %u items, %u copper and %u COD copper with unk1 = %u, unk2 = %u",
-               pl->GetGuidStr().c_str(), rc.GetString().c_str(), subject.c_str(), body.c_str(), itemGuid ? 1 : 0, money, COD, unk1, unk2);
+               pl->GetGuidStr().c_str(), rc.GetString().c_str(), request.subject.c_str(), request.body.c_str(), request.item ? 1 : 0, request.money, request.COD, request.unk1, request.unk2);
 
     if (pl->GetObjectGuid() == rc)
     {
@@ -123,6 +176,9 @@ void WorldSession::HandleSendMail(WorldPacket& recv_data)
         return;
     }
 
+    uint32 const money = request.money;
+    uint32 const COD = request.COD;
+
     if (money && COD) // cannot send money in a COD mail
     {
         // TODO: Add hack logging since this is not normally possible
@@ -138,27 +194,6 @@ void WorldSession::HandleSendMail(WorldPacket& recv_data)
         return;
     }
 
-    Player* receive = sObjectMgr.GetPlayer(rc);
-
-    Team rc_team;
-    uint8 mails_count = 0;                                  // do not allow to send to one player more than 100 mails
-
-    if (receive)
-    {
-        rc_team = receive->GetTeam();
-        mails_count = receive->GetMailSize();
-    }
-    else
-    {
-        rc_team = sObjectMgr.GetPlayerTeamByGUID(rc);
-        if (QueryResult* result = CharacterDatabase.PQuery("SELECT COUNT(*) FROM mail WHERE receiver = '%u'", rc.GetCounter()))
-        {
-            Field* fields = result->Fetch();
-            mails_count = fields[0].GetUInt32();
-            delete result;
-        }
-    }
-
     // do not allow to have more than 100 mails in mailbox.. mails count is in opcode uint8!!! - so max can be 255..
     if (mails_count > 100)
     {
@@ -173,15 +208,11 @@ void WorldSession::HandleSendMail(WorldPacket& recv_data)
         return;
     }
 
-    uint32 rc_account = receive
-                        ? receive->GetSession()->GetAccountId()
-                        : sObjectMgr.GetPlayerAccountIdByGUID(rc);
-
     Item* item = nullptr;
 
-    if (itemGuid)
+    if (request.item)
     {
-        item = pl->GetItemByGuid(itemGuid);
+        item = pl->GetItemByGuid(request.item);
 
         // prevent sending bag with items (cheat: can be placed in bag after adding equipped empty bag to mail)
         if (!item)
@@ -215,43 +246,34 @@ void WorldSession::HandleSendMail(WorldPacket& recv_data)
 
     bool needItemDelay = false;
 
-    MailDraft draft(subject, body);
+    MailDraft draft(request.subject, request.body);
 
-    if (itemGuid || money > 0)
+    if (item)
     {
-        uint32 rc_account = 0;
-        if (receive)
-            rc_account = receive->GetSession()->GetAccountId();
-        else
-            rc_account = sObjectMgr.GetPlayerAccountIdByGUID(rc);
-
-        if (item)
+        if (GetSecurity() > SEC_PLAYER && sWorld.getConfig(CONFIG_BOOL_GM_LOG_TRADE))
         {
-            if (GetSecurity() > SEC_PLAYER && sWorld.getConfig(CONFIG_BOOL_GM_LOG_TRADE))
-            {
-                sLog.outCommand(GetAccountId(), "GM %s (Account: %u) mail item: %s (Entry: %u Count: %u) to player: %s (Account: %u)",
-                                GetPlayerName(), GetAccountId(), item->GetProto()->Name1, item->GetEntry(), item->GetCount(), receiver.c_str(), rc_account);
-            }
+            sLog.outCommand(GetAccountId(), "GM %s (Account: %u) mail item: %s (Entry: %u Count: %u) to player: %s (Account: %u)",
+                            GetPlayerName(), GetAccountId(), item->GetProto()->Name1, item->GetEntry(), item->GetCount(), request.receiver.c_str(), rc_account);
+        }
 
-            pl->MoveItemFromInventory(item->GetBagSlot(), item->GetSlot(), true);
-            CharacterDatabase.BeginTransaction();
-            item->DeleteFromInventoryDB();                  // deletes item from character's inventory
-            item->SaveToDB();                               // recursive and not have transaction guard into self, item not in inventory and can be save standalone
-            // owner in data will set at mail receive and item extracting
-            CharacterDatabase.PExecute("UPDATE item_instance SET owner_guid = '%u' WHERE guid='%u'", rc.GetCounter(), item->GetGUIDLow());
-            CharacterDatabase.CommitTransaction();
+        pl->MoveItemFromInventory(item->GetBagSlot(), item->GetSlot(), true);
+        CharacterDatabase.BeginTransaction();
+        item->DeleteFromInventoryDB();                      // deletes item from character's inventory
+        item->SaveToDB();                                   // recursive and not have transaction guard into self, item not in inventory and can be save standalone
+        // owner in data will set at mail receive and item extracting
+        CharacterDatabase.PExecute("UPDATE item_instance SET owner_guid = '%u' WHERE guid='%u'", rc.GetCounter(), item->GetGUIDLow());
+        CharacterDatabase.CommitTransaction();
 
-            draft.AddItem(item);
+        draft.AddItem(item);
 
-            // if item send to character at another account, then apply item delivery delay
-            needItemDelay = pl->GetSession()->GetAccountId() != rc_account;
-        }
+        // if item send to character at another account, then apply item delivery delay
+        needItemDelay = pl->GetSession()->GetAccountId() != rc_account;
+    }
 
-        if (money > 0 &&  GetSecurity() > SEC_PLAYER && sWorld.getConfig(CONFIG_BOOL_GM_LOG_TRADE))
-        {
-            sLog.outCommand(GetAccountId(), "GM %s (Account: %u) mail money: %u to player: %s (Account: %u)",
-                            GetPlayerName(), GetAccountId(), money, receiver.c_str(), rc_account);
-        }
+    if (money > 0 &&  GetSecurity() > SEC_PLAYER && sWorld.getConfig(CONFIG_BOOL_GM_LOG_TRADE))
+    {
+        sLog.outCommand(GetAccountId(), "GM %s (Account: %u) mail money: %u to player: %s (Account: %u)",
+                        GetPlayerName(), GetAccountId(), money, request.receiver.c_str(), rc_account);
     }
 
     // If theres is an item, there is a one hour delivery delay if sent to another account's character.
@@ -261,7 +283,7 @@ void WorldSession::HandleSendMail(WorldPacket& recv_data)
     draft
     .SetMoney(money)
     .SetCOD(COD)
-    .SendMailTo(MailReceiver(receive, rc), pl, body.empty() ? MAIL_CHECK_MASK_COPIED : MAIL_CHECK_MASK_HAS_BODY, deliver_delay);
+    .SendMailTo(MailReceiver(receive, rc), pl, request.body.empty() ? MAIL_CHECK_MASK_COPIED : MAIL_CHECK_MASK_HAS_BODY, deliver_delay);
 
     CharacterDatabase.BeginTransaction();
     pl->SaveInventoryAndGoldToDB();
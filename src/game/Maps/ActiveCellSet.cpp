@@ -0,0 +1,109 @@
+/*
+* This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include "Maps/ActiveCellSet.h"
+
+static inline bool IsInArea(CellArea const& area, uint32 x, uint32 y)
+{
+    return x >= area.low_bound.x_coord && x <= area.high_bound.x_coord &&
+           y >= area.low_bound.y_coord && y <= area.high_bound.y_coord;
+}
+
+void ActiveCellSet::SetAnchor(uint64 anchor, CellArea const& area)
+{
+    auto itr = m_anchors.find(anchor);
+    if (itr == m_anchors.end())
+    {
+        Anchor& added = m_anchors[anchor];
+        added.area = area;
+        added.generation = m_generation;
+        ChangeArea(area, nullptr, true);
+        return;
+    }
+
+    Anchor& current = itr->second;
+    current.generation = m_generation;
+
+    if (current.area.low_bound == area.low_bound && current.area.high_bound == area.high_bound)
+        return;
+
+    ChangeArea(area, &current.area, true);
+    ChangeArea(current.area, &area, false);
+    current.area = area;
+}
+
+void ActiveCellSet::EndUpdate()
+{
+    for (auto itr = m_anchors.begin(); itr != m_anchors.end();)
+    {
+        if (itr->second.generation != m_generation)
+        {
+            ChangeArea(itr->second.area, nullptr, false);
+            itr = m_anchors.erase(itr);
+        }
+        else
+            ++itr;
+    }
+}
+
+void ActiveCellSet::ChangeArea(CellArea const& area, CellArea const* exclude, bool add)
+{
+    for (uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
+    {
+        for (uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
+        {
+            if (exclude && IsInArea(*exclude, x, y))
+                continue;
+
+            uint32 cellId = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
+            if (add)
+                AddRef(cellId);
+            else
+                RemoveRef(cellId);
+        }
+    }
+}
+
+void ActiveCellSet::AddRef(uint32 cellId)
+{
+    CellRef& ref = m_refs[cellId];
+    if (ref.count++)
+        return;
+
+    ref.index = m_cells.size();
+    m_cells.push_back(cellId);
+    m_active.set(cellId);
+}
+
+void ActiveCellSet::RemoveRef(uint32 cellId)
+{
+    auto itr = m_refs.find(cellId);
+    MANGOS_ASSERT(itr != m_refs.end());
+
+    if (--itr->second.count)
+        return;
+
+    // swap with the last cell to keep the list dense
+    uint32 last = m_cells.back();
+    m_cells[itr->second.index] = last;
+    m_refs[last].index = itr->second.index;
+    m_cells.pop_back();
+
+    m_active.reset(cellId);
+    m_refs.erase(itr);
+}
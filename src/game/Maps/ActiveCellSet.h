@@ -0,0 +1,76 @@
+/*
+* This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef _ACTIVE_CELL_SET_H_INCLUDED
+#define _ACTIVE_CELL_SET_H_INCLUDED
+
+#include "Common.h"
+#include "Grids/Cell.h"
+
+#include <bitset>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Cells of a map that get their objects updated, kept across ticks.
+ *
+ * Every anchor (player, far sight viewpoint or active object, identified by its guid) holds a reference on
+ * the cells of its visibility area. Map::Update reports the current area of every anchor between BeginUpdate()
+ * and EndUpdate(): unchanged areas cost a comparison, moved ones only touch the cells entered and left, anchors
+ * not reported anymore release their cells at EndUpdate(). GetCells() lists every active cell once.
+ */
+class ActiveCellSet
+{
+    public:
+        typedef std::vector<uint32> CellList;
+
+        ActiveCellSet() : m_generation(0) {}
+
+        void BeginUpdate() { ++m_generation; }
+        void SetAnchor(uint64 anchor, CellArea const& area);
+        void EndUpdate();
+
+        bool IsActive(uint32 cellId) const { return m_active.test(cellId); }
+        CellList const& GetCells() const { return m_cells; }
+
+    private:
+        struct Anchor
+        {
+            CellArea area;
+            uint32 generation;
+        };
+
+        struct CellRef
+        {
+            uint32 count;
+            uint32 index;                                   // position in m_cells
+        };
+
+        void AddRef(uint32 cellId);
+        void RemoveRef(uint32 cellId);
+        // reference (add) or release the cells of area that are not part of exclude
+        void ChangeArea(CellArea const& area, CellArea const* exclude, bool add);
+
+        uint32 m_generation;
+        std::unordered_map<uint64, Anchor> m_anchors;
+        std::unordered_map<uint32, CellRef> m_refs;
+        CellList m_cells;
+        std::bitset<TOTAL_NUMBER_OF_CELLS_PER_MAP * TOTAL_NUMBER_OF_CELLS_PER_MAP> m_active;
+};
+
+#endif
@@ -0,0 +1,69 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "Maps/CameraIndex.h"
+#include "Entities/Camera.h"
+
+void CameraIndex::Place(Camera* camera, CellPair const& cell)
+{
+    if (camera->m_indexSlot < m_cameras.size() && m_cameras[camera->m_indexSlot].camera == camera)
+    {
+        Entry& entry = m_cameras[camera->m_indexSlot];
+        if (entry.cellX == cell.x_coord && entry.cellY == cell.y_coord)
+            return;
+
+        RemoveFromCell(camera, CellId(entry.cellX, entry.cellY));
+        entry.cellX = cell.x_coord;
+        entry.cellY = cell.y_coord;
+    }
+    else
+    {
+        camera->m_indexSlot = uint32(m_cameras.size());
+        m_cameras.push_back({ camera, cell.x_coord, cell.y_coord });
+    }
+
+    m_cells[CellId(cell.x_coord, cell.y_coord)].push_back(camera);
+}
+
+void CameraIndex::Remove(Camera* camera)
+{
+    uint32 slot = camera->m_indexSlot;
+    if (slot >= m_cameras.size() || m_cameras[slot].camera != camera)
+        return;
+
+    RemoveFromCell(camera, CellId(m_cameras[slot].cellX, m_cameras[slot].cellY));
+
+    // keep the list dense, the last camera takes the freed slot
+    m_cameras[slot] = m_cameras.back();
+    m_cameras[slot].camera->m_indexSlot = slot;
+    m_cameras.pop_back();
+
+    camera->m_indexSlot = Camera::NOT_INDEXED;
+}
+
+void CameraIndex::RemoveFromCell(Camera* camera, uint32 cellId)
+{
+    auto itr = m_cells.find(cellId);
+    if (itr == m_cells.end())
+        return;
+
+    std::vector<Camera*>& cameras = itr->second;
+    cameras.erase(std::find(cameras.begin(), cameras.end(), camera));
+    if (cameras.empty())
+        m_cells.erase(itr);
+}
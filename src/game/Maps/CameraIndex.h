@@ -0,0 +1,90 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _CAMERA_INDEX_H_INCLUDED
+#define _CAMERA_INDEX_H_INCLUDED
+
+#include "Common.h"
+#include "Grids/Cell.h"
+
+#include <unordered_map>
+#include <vector>
+
+class Camera;
+
+/**
+ * Cameras of a map bucketed by the cell of their viewpoint.
+ *
+ * Answers "which cameras may see a point" without walking the grid containers of every cell in range: only
+ * cells holding cameras are stored, and when the map has fewer cameras than the queried area has cells the flat
+ * camera list is scanned instead. Cameras update their entry whenever they are linked into another cell.
+ * Not synchronized itself, Map wraps every access in its partition lock.
+ */
+class CameraIndex
+{
+    public:
+        void Place(Camera* camera, CellPair const& cell);
+        void Remove(Camera* camera);
+
+        // calls visit(camera) for every camera whose viewpoint stands in a cell of area
+        template<typename Visitor>
+        void Visit(CellArea const& area, Visitor&& visit) const
+        {
+            uint32 width = area.high_bound.x_coord - area.low_bound.x_coord + 1;
+            uint32 height = area.high_bound.y_coord - area.low_bound.y_coord + 1;
+
+            if (m_cameras.size() <= width * height)
+            {
+                for (Entry const& entry : m_cameras)
+                    if (entry.cellX >= area.low_bound.x_coord && entry.cellX <= area.high_bound.x_coord &&
+                            entry.cellY >= area.low_bound.y_coord && entry.cellY <= area.high_bound.y_coord)
+                        visit(entry.camera);
+                return;
+            }
+
+            for (uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
+            {
+                for (uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
+                {
+                    auto itr = m_cells.find(CellId(x, y));
+                    if (itr == m_cells.end())
+                        continue;
+
+                    for (Camera* camera : itr->second)
+                        visit(camera);
+                }
+            }
+        }
+
+        size_t GetCount() const { return m_cameras.size(); }
+
+    private:
+        struct Entry
+        {
+            Camera* camera;
+            uint32 cellX, cellY;
+        };
+
+        static uint32 CellId(uint32 x, uint32 y) { return (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x; }
+        void RemoveFromCell(Camera* camera, uint32 cellId);
+
+        std::vector<Entry> m_cameras;                       // slot of a camera is kept in Camera::m_indexSlot
+        std::unordered_map<uint32, std::vector<Camera*> > m_cells;
+};
+
+#endif
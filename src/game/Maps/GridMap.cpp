@@ -697,6 +697,7 @@ TerrainInfo::TerrainInfo(uint32 mapid) : m_mapId(mapid)
         {
             m_GridMaps[i][k] = nullptr;
             m_GridRef[i][k] = 0;
+            m_PreloadedMaps[i][k] = nullptr;
         }
     }
 
@@ -715,6 +716,10 @@ TerrainInfo::~TerrainInfo()
         for (auto& m_GridMap : m_GridMaps)
             delete m_GridMap[k];
 
+    for (int k = 0; k < MAX_NUMBER_OF_GRIDS; ++k)
+        for (auto& m_PreloadedMap : m_PreloadedMaps)
+            delete m_PreloadedMap[k];
+
     VMAP::VMapFactory::createOrGetVMapManager()->unloadMap(m_mapId);
     MMAP::MMapFactory::createOrGetMMapManager()->unloadMap(m_mapId);
 }
@@ -751,6 +756,50 @@ void TerrainInfo::Unload(const uint32 x, const uint32 y)
     }
 }
 
+void TerrainInfo::Preload(const uint32 x, const uint32 y, std::vector<std::string>& models)
+{
+    MANGOS_ASSERT(x < MAX_NUMBER_OF_GRIDS);
+    MANGOS_ASSERT(y < MAX_NUMBER_OF_GRIDS);
+
+    bool needMap;
+    {
+        LOCK_GUARD lock(m_mutex);
+        needMap = !m_GridMaps[x][y] && !m_PreloadedMaps[x][y];
+    }
+
+    if (needMap)
+    {
+        GridMap* map = LoadGridMap(x, y);
+
+        LOCK_GUARD lock(m_mutex);
+        if (!m_GridMaps[x][y] && !m_PreloadedMaps[x][y])
+            m_PreloadedMaps[x][y] = map;
+        else
+            delete map;
+    }
+
+    // loaded state of vmaps and mmaps is owned by the map thread, both preloads are harmless for loaded tiles
+    VMAP::VMapFactory::createOrGetVMapManager()->preloadTileModels((sWorld.GetDataPath() + "vmaps").c_str(), m_mapId, x, y, models);
+    if (sWorld.getConfig(CONFIG_BOOL_MMAP_ENABLED))
+        MMAP::MMapFactory::createOrGetMMapManager()->preloadTile(m_mapId, x, y);
+}
+
+void TerrainInfo::DropPreload(const uint32 x, const uint32 y, std::vector<std::string> const& models)
+{
+    MANGOS_ASSERT(x < MAX_NUMBER_OF_GRIDS);
+    MANGOS_ASSERT(y < MAX_NUMBER_OF_GRIDS);
+
+    {
+        LOCK_GUARD lock(m_mutex);
+        delete m_PreloadedMaps[x][y];
+        m_PreloadedMaps[x][y] = nullptr;
+    }
+
+    // a loaded tile holds its own model references
+    VMAP::VMapFactory::createOrGetVMapManager()->releaseTileModels(models);
+    MMAP::MMapFactory::createOrGetMMapManager()->dropPreloadedTile(m_mapId, x, y);
+}
+
 // call this method only
 void TerrainInfo::CleanUpGrids(const uint32 diff)
 {
@@ -1138,22 +1187,11 @@ GridMap* TerrainInfo::LoadMapAndVMap(const uint32 x, const uint32 y, bool mapOnl
         // double checked lock pattern
         if (!m_GridMaps[x][y])
         {
-            GridMap* map = new GridMap();
+            // use the map read ahead by the grid preloader, if any
+            std::swap(m_GridMaps[x][y], m_PreloadedMaps[x][y]);
 
-            // map file name
-            int len = sWorld.GetDataPath().length() + strlen("maps/%03u%02u%02u.map") + 1;
-            char* tmp = new char[len];
-            snprintf(tmp, len, (char*)(sWorld.GetDataPath() + "maps/%03u%02u%02u.map").c_str(), m_mapId, x, y);
-            DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "Loading map %s", tmp);
-
-            if (!map->loadData(tmp))
-            {
-                sLog.outError("Error load map file: %s", tmp);
-                //assert(false);
-            }
-
-            delete[] tmp;
-            m_GridMaps[x][y] = map;
+            if (!m_GridMaps[x][y])
+                m_GridMaps[x][y] = LoadGridMap(x, y);
         }
     }
 
@@ -1194,6 +1232,26 @@ GridMap* TerrainInfo::LoadMapAndVMap(const uint32 x, const uint32 y, bool mapOnl
     return  m_GridMaps[x][y];
 }
 
+GridMap* TerrainInfo::LoadGridMap(const uint32 x, const uint32 y) const
+{
+    GridMap* map = new GridMap();
+
+    // map file name
+    int len = sWorld.GetDataPath().length() + strlen("maps/%03u%02u%02u.map") + 1;
+    char* tmp = new char[len];
+    snprintf(tmp, len, (char*)(sWorld.GetDataPath() + "maps/%03u%02u%02u.map").c_str(), m_mapId, x, y);
+    DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "Loading map %s", tmp);
+
+    if (!map->loadData(tmp))
+    {
+        sLog.outError("Error load map file: %s", tmp);
+        //assert(false);
+    }
+
+    delete[] tmp;
+    return map;
+}
+
 float TerrainInfo::GetWaterLevel(float x, float y, float z, float* pGround /*= nullptr*/) const
 {
     if (const_cast<TerrainInfo*>(this)->GetGrid(x, y))
@@ -177,16 +177,22 @@ class TerrainInfo : public Referencable<std::atomic_long>
     protected:
         friend class Map;
         friend class ObjectMgr;
+        friend class GridPreloader;
         // load/unload terrain data
         GridMap* Load(const uint32 x, const uint32 y, bool mapOnly = false);
         void Unload(const uint32 x, const uint32 y);
 
+        // read map, vmap models and mmap tile of a grid ahead of Load, safe outside of the map thread
+        void Preload(const uint32 x, const uint32 y, std::vector<std::string>& models);
+        void DropPreload(const uint32 x, const uint32 y, std::vector<std::string> const& models);
+
     private:
         TerrainInfo(const TerrainInfo&);
         TerrainInfo& operator=(const TerrainInfo&);
 
         GridMap* GetGrid(const float x, const float y, bool loadOnlyMap = false);
         GridMap* LoadMapAndVMap(const uint32 x, const uint32 y, bool mapOnly = false);
+        GridMap* LoadGridMap(const uint32 x, const uint32 y) const;
 
         int RefGrid(const uint32& x, const uint32& y);
         int UnrefGrid(const uint32& x, const uint32& y);
@@ -195,6 +201,7 @@ class TerrainInfo : public Referencable<std::atomic_long>
 
         GridMap* m_GridMaps[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
         int16 m_GridRef[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
+        GridMap* m_PreloadedMaps[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];    // guarded by m_mutex
 
         // global garbage collection timer
         ShortIntervalTimer i_timer;
@@ -0,0 +1,137 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "Maps/GridPreloader.h"
+#include "Maps/GridMap.h"
+#include "Log.h"
+#include "Timer.h"
+#include "Policies/Singleton.h"
+
+INSTANTIATE_SINGLETON_1(GridPreloader);
+
+void GridPreloader::Start(uint32 threads, uint32 holdTime)
+{
+    m_holdTime = holdTime;
+    m_stop = false;
+
+    for (uint32 i = 0; i < threads; ++i)
+        m_workers.push_back(std::thread(&GridPreloader::WorkerThread, this));
+
+    if (threads)
+        sLog.outString("Grid preloader started with %u threads", threads);
+}
+
+void GridPreloader::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+
+    for (auto& worker : m_workers)
+        worker.join();
+    m_workers.clear();
+
+    for (auto& entry : m_entries)
+        Release(entry.second);
+
+    m_entries.clear();
+    m_queue.clear();
+}
+
+void GridPreloader::Request(TerrainInfo* terrain, uint32 x, uint32 y)
+{
+    uint64 key = (uint64(terrain->GetMapId()) << 16) | (x << 8) | y;
+
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        if (m_stop)
+            return;
+
+        Entry& entry = m_entries[key];
+        entry.requestTime = WorldTimer::getMSTime();
+        if (entry.terrain)
+            return;
+
+        terrain->AddRef();
+        entry.terrain = terrain;
+        entry.x = x;
+        entry.y = y;
+        m_queue.push_back(key);
+    }
+
+    m_condition.notify_one();
+}
+
+void GridPreloader::Update()
+{
+    std::vector<Entry> expired;
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        uint32 now = WorldTimer::getMSTime();
+        for (auto itr = m_entries.begin(); itr != m_entries.end();)
+        {
+            if (itr->second.loaded && WorldTimer::getMSTimeDiff(itr->second.requestTime, now) >= m_holdTime)
+            {
+                expired.push_back(std::move(itr->second));
+                itr = m_entries.erase(itr);
+            }
+            else
+                ++itr;
+        }
+    }
+
+    for (auto& entry : expired)
+        Release(entry);
+}
+
+void GridPreloader::WorkerThread()
+{
+    while (true)
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        while (!m_stop && m_queue.empty())
+            m_condition.wait(lock);
+
+        if (m_stop)
+            return;
+
+        // entries are only erased once loaded, so the reference stays valid while unlocked
+        Entry& entry = m_entries[m_queue.front()];
+        m_queue.pop_front();
+        lock.unlock();
+
+        std::vector<std::string> models;
+        entry.terrain->Preload(entry.x, entry.y, models);
+
+        lock.lock();
+        entry.models.swap(models);
+        entry.loaded = true;
+        entry.requestTime = WorldTimer::getMSTime();
+    }
+}
+
+void GridPreloader::Release(Entry& entry)
+{
+    entry.terrain->DropPreload(entry.x, entry.y, entry.models);
+
+    if (entry.terrain->Release())
+        sTerrainMgr.UnloadTerrain(entry.terrain->GetMapId());
+}
@@ -0,0 +1,79 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _GRID_PRELOADER_H_INCLUDED
+#define _GRID_PRELOADER_H_INCLUDED
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+
+#include <mutex>
+#include <thread>
+#include <deque>
+#include <condition_variable>
+
+class TerrainInfo;
+
+// Background threads reading terrain, vmap models and mmap tiles of grids a map expects to load soon.
+// Maps request grids predicted from player movement, the map thread then only links the read data in.
+// Data nobody used within the hold time is released again.
+class GridPreloader
+{
+    public:
+        GridPreloader() : m_holdTime(0), m_stop(false) {}
+        ~GridPreloader() { Stop(); }
+
+        void Start(uint32 threads, uint32 holdTime);
+        void Stop();
+
+        bool IsEnabled() const { return !m_workers.empty(); }
+
+        // queue a terrain grid (terrain coordinates), called from map threads
+        void Request(TerrainInfo* terrain, uint32 x, uint32 y);
+
+        // release expired preloads, called from the world thread
+        void Update();
+
+    private:
+        struct Entry
+        {
+            Entry() : terrain(nullptr), x(0), y(0), loaded(false), requestTime(0) {}
+
+            TerrainInfo* terrain;                           // referenced while the entry exists
+            uint32 x, y;
+            bool loaded;
+            uint32 requestTime;                             // last request or load, the hold time starts here
+            std::vector<std::string> models;                // vmap models referenced by the preload
+        };
+
+        void WorkerThread();
+        static void Release(Entry& entry);
+
+        uint32 m_holdTime;
+        bool m_stop;
+
+        std::mutex m_lock;
+        std::condition_variable m_condition;
+        std::unordered_map<uint64, Entry> m_entries;
+        std::deque<uint64> m_queue;
+        std::vector<std::thread> m_workers;
+};
+
+#define sGridPreloader MaNGOS::Singleton<GridPreloader>::Instance()
+
+#endif
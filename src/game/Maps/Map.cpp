@@ -38,11 +38,17 @@
 #include "Weather/Weather.h"
 #include "Grids/ObjectGridLoader.h"
 #include "AI/ScriptDevAI/ScriptDevAIMgr.h"
+#include "Maps/MapWorkers.h"
+#include "Maps/GridPreloader.h"
+#include "Movement/MoveSpline.h"
 
 Map::~Map()
 {
     UnloadAll(true);
 
+    for (auto grid : m_gridPool)
+        delete grid;
+
     if (!m_scriptSchedule.empty())
         sScriptMgr.DecreaseScheduledScriptCount(m_scriptSchedule.size());
 
@@ -63,6 +69,35 @@ Map::~Map()
     m_weatherSystem = nullptr;
 }
 
+static char const* MapUpdatePhaseNames[MAP_PHASE_COUNT] =
+{
+    "dynamic tree",
+    "sessions",
+    "players",
+    "messages",
+    "cell visits",
+    "objects",
+    "send updates",
+    "grid states",
+    "scripts",
+    "instance data",
+    "weather",
+};
+
+static uint32 const GRID_PRELOAD_INTERVAL = 1000;          // ms between two grid preload predictions
+static size_t const MAX_POOLED_GRIDS = 8;                   // unloaded NGrids kept per map for reuse
+
+// shared by all maps, so an object changing map can never carry the epoch of the pass it joins
+static std::atomic<uint32> s_updateEpoch(0);
+
+static uint32 NextUpdateEpoch()
+{
+    uint32 epoch = ++s_updateEpoch;
+    if (!epoch)                                             // 0 is the stamp of never collected objects
+        epoch = ++s_updateEpoch;
+    return epoch;
+}
+
 uint32 Map::GetCurrentMSTime() const
 {
     return World::GetCurrentMSTime();
@@ -75,7 +110,7 @@ TimePoint Map::GetCurrentClockTime() const
 
 uint32 Map::GetCurrentDiff() const
 {
-    return World::GetCurrentDiff();
+    return m_currentDiff;
 }
 
 void Map::LoadMapAndVMap(int gx, int gy)
@@ -90,12 +125,15 @@ void Map::LoadMapAndVMap(int gx, int gy)
 Map::Map(uint32 id, time_t expiry, uint32 InstanceId)
     : i_mapEntry(sMapStore.LookupEntry(id)),
       i_id(id), i_InstanceId(InstanceId), m_unloadTimer(0),
-      m_VisibleDistance(DEFAULT_VISIBILITY_DISTANCE), m_persistentState(nullptr),
-      m_activeNonPlayersIter(m_activeNonPlayers.end()), m_onEventNotifiedIter(m_onEventNotifiedObjects.end()),
+      m_VisibleDistance(DEFAULT_VISIBILITY_DISTANCE), m_interestFarDistance(0.0f), m_persistentState(nullptr),
+      m_onEventNotifiedIter(m_onEventNotifiedObjects.end()),
       i_gridExpiry(expiry), m_TerrainData(sTerrainMgr.LoadTerrain(id)),
-      i_data(nullptr), i_script_id(0),
-      m_cycleCounter(0), m_updateTimeMin(INT_MAX), m_updateTimeMax(0), m_updateTimeTotal(0)
+      m_initTransportsTime(0), m_updateEpoch(0), m_updatingPartitions(false), i_data(nullptr), i_script_id(0),
+      m_pendingDiff(0), m_currentDiff(0),
+      m_cycleCounter(0), m_updateTimeMin(INT_MAX), m_updateTimeMax(0), m_updateTimeLast(0), m_updateTimeTotal(0),
+      m_tickProfiler(MapUpdatePhaseNames, MAP_PHASE_COUNT)
 {
+    m_preloadTimer.SetInterval(GRID_PRELOAD_INTERVAL);
     m_weatherSystem = new WeatherSystem(this);
 }
 
@@ -132,6 +170,13 @@ void Map::InitVisibilityDistance()
 {
     // init visibility for continents
     m_VisibleDistance = World::GetMaxVisibleDistanceOnContinents();
+    m_interestFarDistance = sWorld.getConfig(CONFIG_FLOAT_INTEREST_FAR_DISTANCE_CONTINENTS);
+}
+
+void Map::ResetVisibilityDistance()
+{
+    InitVisibilityDistance();
+    m_VisibleDistance *= m_overloadGovernor.GetVisibilityFactor();
 }
 
 // Template specialization of utility methods
@@ -231,8 +276,7 @@ void Map::EnsureGridCreated(const GridPair& p)
 {
     if (!getNGrid(p.x_coord, p.y_coord))
     {
-        setNGrid(new NGridType(p.x_coord * MAX_NUMBER_OF_GRIDS + p.y_coord, p.x_coord, p.y_coord, i_gridExpiry, sWorld.getConfig(CONFIG_BOOL_GRID_UNLOAD)),
-                 p.x_coord, p.y_coord);
+        setNGrid(AcquireNGrid(p), p.x_coord, p.y_coord);
 
         // build a linkage between this map and NGridType
         buildNGridLinkage(getNGrid(p.x_coord, p.y_coord));
@@ -365,6 +409,8 @@ Map::Add(T* obj)
 {
     MANGOS_ASSERT(obj);
 
+    std::unique_lock<std::recursive_mutex> guard = LockPartitionedUpdate();
+
     CellPair p = MaNGOS::ComputeCellPair(obj->GetPositionX(), obj->GetPositionY());
     if (p.x_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP || p.y_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP)
     {
@@ -555,26 +601,116 @@ bool Map::loaded(const GridPair& p) const
     return (getNGrid(p.x_coord, p.y_coord) && isGridObjectDataLoaded(p.x_coord, p.y_coord));
 }
 
-void Map::VisitNearbyCellsOf(WorldObject* obj, TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer> &gridVisitor, TypeContainerVisitor<MaNGOS::ObjectUpdater, WorldTypeMapContainer> &worldVisitor)
+/// Reference the cells around players, far sight viewpoints and active objects, only moved areas change the set
+void Map::UpdateActiveCells()
+{
+    m_activeCells.BeginUpdate();
+
+    for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
+    {
+        Player* player = m_mapRefIter->getSource();
+        if (!player->IsInWorld() || !player->IsPositionValid())
+            continue;
+
+        m_activeCells.SetAnchor(player->GetObjectGuid().GetRawValue(), Cell::CalculateCellArea(player->GetPositionX(), player->GetPositionY(), GetVisibilityDistance()));
+
+        // If player is using far sight, update the cells around that object too
+        if (WorldObject* viewPoint = GetWorldObject(player->GetFarSightGuid()))
+            m_activeCells.SetAnchor(viewPoint->GetObjectGuid().GetRawValue(), Cell::CalculateCellArea(viewPoint->GetPositionX(), viewPoint->GetPositionY(), GetVisibilityDistance()));
+    }
+
+    // non-player active objects
+    for (auto obj : m_activeNonPlayers)
+        if (obj->IsInWorld() && obj->IsPositionValid())
+            m_activeCells.SetAnchor(obj->GetObjectGuid().GetRawValue(), Cell::CalculateCellArea(obj->GetPositionX(), obj->GetPositionY(), GetVisibilityDistance()));
+
+    m_activeCells.EndUpdate();
+}
+
+void Map::PreloadGrids(uint32 diff)
+{
+    if (!sGridPreloader.IsEnabled())
+        return;
+
+    m_preloadTimer.Update(diff);
+    if (!m_preloadTimer.Passed())
+        return;
+
+    float elapsed = m_preloadTimer.GetCurrent() / float(IN_MILLISECONDS);
+    float lookahead = sWorld.getConfig(CONFIG_UINT32_GRID_PRELOAD_LOOKAHEAD) / float(IN_MILLISECONDS);
+    m_preloadTimer.SetCurrent(0);
+
+    std::unordered_map<uint64, Position> positions;
+    for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
+    {
+        Player* player = m_mapRefIter->getSource();
+        if (!player->IsInWorld() || !player->IsPositionValid())
+            continue;
+
+        float x = player->GetPositionX();
+        float y = player->GetPositionY();
+        positions[player->GetObjectGuid().GetRawValue()] = Position(x, y, player->GetPositionZ(), player->GetOrientation());
+
+        // flight paths are known ahead, follow the spline for the lookahead distance
+        if (player->IsTaxiFlying() && player->movespline->Initialized() && !player->movespline->Finalized())
+        {
+            Movement::MoveSpline::MySpline::ControlArray const& path = player->movespline->_Spline().getPoints();
+            float distance = player->movespline->Speed() * lookahead;
+            for (size_t i = player->movespline->_currentSplineIdx() + 1; i < path.size() && distance > 0.0f; ++i)
+            {
+                PreloadGridsAlong(x, y, path[i].x, path[i].y);
+                distance -= std::sqrt((path[i].x - x) * (path[i].x - x) + (path[i].y - y) * (path[i].y - y));
+                x = path[i].x;
+                y = path[i].y;
+            }
+            continue;
+        }
+
+        // otherwise extrapolate the movement since the previous pass
+        auto itr = m_preloadPositions.find(player->GetObjectGuid().GetRawValue());
+        if (itr == m_preloadPositions.end() || elapsed <= 0.0f)
+            continue;
+
+        float dx = (x - itr->second.x) / elapsed * lookahead;
+        float dy = (y - itr->second.y) / elapsed * lookahead;
+        if (dx * dx + dy * dy >= SIZE_OF_GRID_CELL * SIZE_OF_GRID_CELL)
+            PreloadGridsAlong(x, y, x + dx, y + dy);
+    }
+
+    m_preloadPositions.swap(positions);
+}
+
+void Map::PreloadGridsAlong(float x1, float y1, float x2, float y2)
 {
-    // lets update mobs/objects in ALL visible cells around player!
-    CellArea area = Cell::CalculateCellArea(obj->GetPositionX(), obj->GetPositionY(), GetVisibilityDistance());
+    // sample every half grid and cover the visibility distance around each sample, like cell loading does
+    float length = std::sqrt((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1));
+    uint32 steps = uint32(length / (SIZE_OF_GRIDS / 2)) + 1;
+    float radius = GetVisibilityDistance();
 
-    for (uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
+    for (uint32 i = 1; i <= steps; ++i)
     {
-        for (uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
+        float x = x1 + (x2 - x1) * i / steps;
+        float y = y1 + (y2 - y1) * i / steps;
+        if (!MaNGOS::IsValidMapCoord(x, y))
+            break;
+
+        float lowX = x - radius, lowY = y - radius, highX = x + radius, highY = y + radius;
+        MaNGOS::NormalizeMapCoord(lowX);
+        MaNGOS::NormalizeMapCoord(lowY);
+        MaNGOS::NormalizeMapCoord(highX);
+        MaNGOS::NormalizeMapCoord(highY);
+
+        GridPair low = MaNGOS::ComputeGridPair(lowX, lowY);
+        GridPair high = MaNGOS::ComputeGridPair(highX, highY);
+        for (uint32 gridX = low.x_coord; gridX <= high.x_coord; ++gridX)
         {
-            // marked cells are those that have been visited
-            // don't visit the same cell twice
-            uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
-            if (!isCellMarked(cell_id))
+            for (uint32 gridY = low.y_coord; gridY <= high.y_coord; ++gridY)
             {
-                markCell(cell_id);
-                CellPair pair(x, y);
-                Cell cell(pair);
-                cell.SetNoCreate();
-                Visit(cell, gridVisitor);
-                Visit(cell, worldVisitor);
+                // terrain coordinates, see EnsureGridCreated
+                int gx = (MAX_NUMBER_OF_GRIDS - 1) - gridX;
+                int gy = (MAX_NUMBER_OF_GRIDS - 1) - gridY;
+                if (!m_bLoadedGrids[gx][gy])
+                    sGridPreloader.Request(m_TerrainData, gx, gy);
             }
         }
     }
@@ -584,7 +720,12 @@ void Map::Update(const uint32& t_diff)
 {
     std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
 
+    m_currentDiff = t_diff;
+
+    m_tickProfiler.StartTick();
+
     m_dyn_tree.update(t_diff);
+    m_tickProfiler.Mark(MAP_PHASE_DYN_TREE);
 
     /// update worldsessions for existing players
     for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
@@ -598,6 +739,7 @@ void Map::Update(const uint32& t_diff)
             pSession->Update(updater);
         }
     }
+    m_tickProfiler.Mark(MAP_PHASE_SESSIONS);
 
     /// update players at tick
     for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
@@ -606,9 +748,7 @@ void Map::Update(const uint32& t_diff)
         if (plr && plr->IsInWorld())
             plr->Update(t_diff);
     }
-
-    /// update active cells around players and active objects
-    resetMarkedCells();
+    m_tickProfiler.Mark(MAP_PHASE_PLAYERS);
 
     {
         std::lock_guard<std::mutex> guard(m_messageMutex);
@@ -617,72 +757,44 @@ void Map::Update(const uint32& t_diff)
 
         m_messageVector.clear();
     }
+    m_tickProfiler.Mark(MAP_PHASE_MESSAGES);
 
-    WorldObjectUnSet objToUpdate;
-    MaNGOS::ObjectUpdater obj_updater(objToUpdate, t_diff);
-    TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer  > grid_object_update(obj_updater);    // For creature
-    TypeContainerVisitor<MaNGOS::ObjectUpdater, WorldTypeMapContainer > world_object_update(obj_updater);   // For pets
+    /// update active cells around players and active objects
+    UpdateActiveCells();
+    PreloadGrids(t_diff);
+    m_updateEpoch = NextUpdateEpoch();
 
-    // the player iterator is stored in the map object
-    // to make sure calls to Map::Remove don't invalidate it
-    for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
+    if (CanUpdateCellsInPartitions())
     {
-        Player* player = m_mapRefIter->getSource();
-        if (!player->IsInWorld() || !player->IsPositionValid())
-            continue;
-
-        VisitNearbyCellsOf(player, grid_object_update, world_object_update);
-
-        // If player is using far sight, visit that object too
-        if (WorldObject* viewPoint = GetWorldObject(player->GetFarSightGuid()))
-            VisitNearbyCellsOf(viewPoint, grid_object_update, world_object_update);
+        UpdateCellsInPartitions(t_diff);
+        m_tickProfiler.Mark(MAP_PHASE_OBJECTS);
     }
-
-    // non-player active objects
-    if (!m_activeNonPlayers.empty())
+    else
     {
-        for (m_activeNonPlayersIter = m_activeNonPlayers.begin(); m_activeNonPlayersIter != m_activeNonPlayers.end();)
-        {
-            // skip not in world
-            WorldObject* obj = *m_activeNonPlayersIter;
-
-            // step before processing, in this case if Map::Remove remove next object we correctly
-            // step to next-next, and if we step to end() then newly added objects can wait next update.
-            ++m_activeNonPlayersIter;
-
-            if (!obj->IsInWorld() || !obj->IsPositionValid())
-                continue;
+        MaNGOS::ObjectUpdater obj_updater(m_objectsToUpdate, m_updateEpoch);
+        TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer  > grid_object_update(obj_updater);    // For creature
+        TypeContainerVisitor<MaNGOS::ObjectUpdater, WorldTypeMapContainer > world_object_update(obj_updater);   // For pets
 
-            // lets update mobs/objects in ALL visible cells around player!
-            CellArea area = Cell::CalculateCellArea(obj->GetPositionX(), obj->GetPositionY(), GetVisibilityDistance());
-
-            for (uint32 x = area.low_bound.x_coord; x <= area.high_bound.x_coord; ++x)
-            {
-                for (uint32 y = area.low_bound.y_coord; y <= area.high_bound.y_coord; ++y)
-                {
-                    // marked cells are those that have been visited
-                    // don't visit the same cell twice
-                    uint32 cell_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
-                    if (!isCellMarked(cell_id))
-                    {
-                        markCell(cell_id);
-                        CellPair pair(x, y);
-                        Cell cell(pair);
-                        cell.SetNoCreate();
-                        Visit(cell, grid_object_update);
-                        Visit(cell, world_object_update);
-                    }
-                }
-            }
+        for (uint32 cell_id : m_activeCells.GetCells())
+        {
+            CellPair pair(cell_id % TOTAL_NUMBER_OF_CELLS_PER_MAP, cell_id / TOTAL_NUMBER_OF_CELLS_PER_MAP);
+            Cell cell(pair);
+            cell.SetNoCreate();
+            Visit(cell, grid_object_update);
+            Visit(cell, world_object_update);
         }
-    }
+        m_tickProfiler.Mark(MAP_PHASE_CELL_VISITS);
 
-    // update all objects
-    for (auto wObj : objToUpdate)
-        wObj->Update(t_diff);
+        // update all objects
+        for (auto wObj : m_objectsToUpdate)
+            wObj->Update(t_diff);
+        m_objectsToUpdate.clear();
+        m_tickProfiler.Mark(MAP_PHASE_OBJECTS);
+    }
 
     // Send world objects and item update field changes
     SendObjectUpdates();
+    m_tickProfiler.Mark(MAP_PHASE_SEND_UPDATES);
 
     // Don't unload grids if it's battleground, since we may have manually added GOs,creatures, those doesn't load from DB at grid re-load !
     // This isn't really bother us, since as soon as we have instanced BG-s, the whole map unloads as the BG gets ended
@@ -696,14 +808,21 @@ void Map::Update(const uint32& t_diff)
             MANGOS_ASSERT(grid->GetGridState() >= 0 && grid->GetGridState() < MAX_GRID_STATE);
             sMapMgr.UpdateGridState(grid->GetGridState(), *this, *grid, *info, grid->getX(), grid->getY(), t_diff);
         }
+        m_tickProfiler.Mark(MAP_PHASE_GRID_STATES);
     }
 
     ///- Process necessary scripts
     if (!m_scriptSchedule.empty())
+    {
         ScriptsProcess();
+        m_tickProfiler.Mark(MAP_PHASE_SCRIPTS);
+    }
 
     if (i_data)
+    {
         i_data->Update(t_diff);
+        m_tickProfiler.Mark(MAP_PHASE_INSTANCE_DATA);
+    }
 
     std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
     long long duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
@@ -714,10 +833,154 @@ void Map::Update(const uint32& t_diff)
     if (duration > m_updateTimeMax)
         m_updateTimeMax = duration;
 
+    m_updateTimeLast = duration;
     m_updateTimeTotal += duration;
     ++m_cycleCounter;
 
+    OverloadStage oldStage = m_overloadGovernor.GetStage();
+    if (m_overloadGovernor.Update(uint32(duration), t_diff))
+    {
+        sLog.outString("Map %u (Instance: %u) overload stage %s -> %s (update %u ms, budget %u ms)", GetId(), GetInstanceId(),
+                       OverloadGovernor::GetStageName(oldStage), OverloadGovernor::GetStageName(m_overloadGovernor.GetStage()),
+                       uint32(duration), OverloadGovernor::GetConfig().tickBudget);
+        ResetVisibilityDistance();
+    }
+
     m_weatherSystem->UpdateWeathers(t_diff);
+    m_tickProfiler.Mark(MAP_PHASE_WEATHER);
+
+    // what this update sent to its players goes out now, sockets of other maps may still be written to
+    for (const auto& itr : m_mapRefManager)
+        itr.getSource()->GetSession()->FlushSocket();
+
+    m_tickProfiler.EndTick();
+}
+
+uint32 Map::GetPredictedUpdateTime() const
+{
+    // never updated yet, players are the best hint for the work to come
+    if (!m_cycleCounter)
+        return m_mapRefManager.getSize();
+
+    // recent spikes count more than the long term average
+    return std::max(uint32(m_updateTimeTotal / m_cycleCounter), uint32(m_updateTimeLast));
+}
+
+bool Map::CanUpdateCellsInPartitions() const
+{
+    return IsContinent() && sWorld.getConfig(CONFIG_BOOL_MAP_PARALLEL_CONTINENTS) && sMapMgr.GetMapUpdater();
+}
+
+/**
+ * Update objects in active cells on several map update threads.
+ *
+ * Active cells are grouped into partitions, cells closer than twice the longest reach of an object (visibility,
+ * yell range) or MapUpdate.Parallel.PartitionGap cells if larger always end in the same partition. Each partition is
+ * updated by exactly one thread, so objects interacting with each other are always updated by the same thread.
+ * Work crossing partitions is handled as following:
+ *  - creature moves into another cell only change its position, grid containers and visibility are updated after all partitions finished
+ *  - grid container reads (Map::Visit) and writes (Add, Remove, player relocation) are serialized by LockPartitionedUpdate
+ *  - camera index visits and camera moves between cells are serialized by LockPartitionedUpdate
+ *  - AddObjectToRemoveList, client update list, scripts, spawns and despawns are serialized by LockPartitionedUpdate
+ */
+void Map::UpdateCellsInPartitions(uint32 diff)
+{
+    std::vector<uint32> activeCells(m_activeCells.GetCells());
+
+    if (activeCells.empty())
+        return;
+
+    // objects of two partitions must never reach the same object, so partitions are at least twice the longest
+    // reach apart: visibility notifiers and far interest updates, yells and grid searches up to the yell range
+    float const reach = std::max({ GetVisibilityDistance(), GetInterestFarDistance(), sWorld.getConfig(CONFIG_FLOAT_LISTEN_RANGE_YELL) });
+    int32 const gap = std::max(int32(sWorld.getConfig(CONFIG_UINT32_MAP_PARTITION_GAP)), int32(ceil(2 * reach / SIZE_OF_GRID_CELL)));
+
+    // group cells into partitions, cells within gap distance of each other are connected
+    std::sort(activeCells.begin(), activeCells.end());
+    std::vector<bool> assigned(activeCells.size(), false);
+    std::vector<CellPartitions::Partition> partitions;
+    std::vector<uint32> openCells;
+
+    for (size_t i = 0; i < activeCells.size(); ++i)
+    {
+        if (assigned[i])
+            continue;
+
+        partitions.push_back(CellPartitions::Partition());
+        CellPartitions::Partition& partition = partitions.back();
+
+        assigned[i] = true;
+        openCells.push_back(activeCells[i]);
+
+        while (!openCells.empty())
+        {
+            uint32 cell_id = openCells.back();
+            openCells.pop_back();
+
+            int32 cell_x = int32(cell_id % TOTAL_NUMBER_OF_CELLS_PER_MAP);
+            int32 cell_y = int32(cell_id / TOTAL_NUMBER_OF_CELLS_PER_MAP);
+            partition.push_back(CellPair(cell_x, cell_y));
+
+            for (int32 x = std::max(cell_x - gap, 0); x <= std::min(cell_x + gap, int32(TOTAL_NUMBER_OF_CELLS_PER_MAP) - 1); ++x)
+            {
+                for (int32 y = std::max(cell_y - gap, 0); y <= std::min(cell_y + gap, int32(TOTAL_NUMBER_OF_CELLS_PER_MAP) - 1); ++y)
+                {
+                    uint32 near_id = (y * TOTAL_NUMBER_OF_CELLS_PER_MAP) + x;
+                    if (!IsCellActive(near_id))
+                        continue;
+
+                    size_t index = std::lower_bound(activeCells.begin(), activeCells.end(), near_id) - activeCells.begin();
+                    if (!assigned[index])
+                    {
+                        assigned[index] = true;
+                        openCells.push_back(near_id);
+                    }
+                }
+            }
+        }
+    }
+
+    // biggest partitions first, so the small ones fill the gaps at the end
+    std::sort(partitions.begin(), partitions.end(), [](CellPartitions::Partition const& a, CellPartitions::Partition const& b)
+    {
+        return a.size() > b.size();
+    });
+
+    std::shared_ptr<CellPartitions> cellPartitions = std::make_shared<CellPartitions>(std::move(partitions), diff, m_updateEpoch);
+
+    // the map thread takes part in the update, so it never waits for a partition nobody claimed
+    size_t crawlers = std::min<size_t>(cellPartitions->size() - 1, sWorld.getConfig(CONFIG_UINT32_NUM_MAP_THREADS));
+    if (crawlers > 0)
+    {
+        m_updatingPartitions = true;
+
+        MapUpdater* updater = sMapMgr.GetMapUpdater();
+        for (size_t i = 0; i < crawlers; ++i)
+            updater->schedule_update(new GridCrawler(*this, cellPartitions, *updater));
+    }
+
+    cellPartitions->Process(*this);
+    cellPartitions->Wait();
+
+    if (crawlers > 0)
+    {
+        m_updatingPartitions = false;
+        ApplyDeferredRelocations();
+    }
+}
+
+void Map::ApplyDeferredRelocations()
+{
+    for (auto& guid : m_deferredRelocations)
+    {
+        Creature* creature = GetAnyTypeCreature(guid);
+        if (!creature || !creature->IsInWorld())
+            continue;
+
+        CreatureRelocation(creature, creature->GetPositionX(), creature->GetPositionY(), creature->GetPositionZ(), creature->GetOrientation());
+    }
+
+    m_deferredRelocations.clear();
 }
 
 void Map::Remove(Player* player, bool remove)
@@ -776,6 +1039,8 @@ template<class T>
 void
 Map::Remove(T* obj, bool remove)
 {
+    std::unique_lock<std::recursive_mutex> guard = LockPartitionedUpdate();
+
     CellPair p = MaNGOS::ComputeCellPair(obj->GetPositionX(), obj->GetPositionY());
     if (p.x_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP || p.y_coord >= TOTAL_NUMBER_OF_CELLS_PER_MAP)
     {
@@ -819,6 +1084,9 @@ Map::PlayerRelocation(Player* player, float x, float y, float z, float orientati
 {
     MANGOS_ASSERT(player);
 
+    // a player may be moved by a creature of a partition, e.g. by a teleport spell
+    std::unique_lock<std::recursive_mutex> guard = LockPartitionedUpdate();
+
     CellPair old_val = MaNGOS::ComputeCellPair(player->GetPositionX(), player->GetPositionY());
     CellPair new_val = MaNGOS::ComputeCellPair(x, y);
 
@@ -857,6 +1125,16 @@ void Map::CreatureRelocation(Creature* creature, float x, float y, float z, floa
 {
     Cell new_cell(MaNGOS::ComputeCellPair(x, y));
 
+    // grid containers are shared by all partitions, so cell changes are applied after all of them are updated
+    if (m_updatingPartitions && creature->GetCurrentCell() != new_cell)
+    {
+        creature->Relocate(x, y, z, ang);
+
+        std::lock_guard<std::mutex> guard(m_relocationLock);
+        m_deferredRelocations.insert(creature->GetObjectGuid());
+        return;
+    }
+
     // do move or do move to respawn or remove creature if previous all fail
     if (CreatureCellRelocation(creature, new_cell))
     {
@@ -945,7 +1223,7 @@ bool Map::UnloadGrid(const uint32& x, const uint32& y, bool pForce)
         RemoveAllObjectsInRemoveList();
 
         unloader.UnloadN();
-        delete getNGrid(x, y);
+        ReleaseNGrid(getNGrid(x, y));
         setNGrid(nullptr, x, y);
     }
 
@@ -964,6 +1242,28 @@ bool Map::UnloadGrid(const uint32& x, const uint32& y, bool pForce)
     return true;
 }
 
+NGridType* Map::AcquireNGrid(const GridPair& p)
+{
+    uint32 id = p.x_coord * MAX_NUMBER_OF_GRIDS + p.y_coord;
+    if (m_gridPool.empty())
+        return new NGridType(id, p.x_coord, p.y_coord, i_gridExpiry, sWorld.getConfig(CONFIG_BOOL_GRID_UNLOAD));
+
+    NGridType* grid = m_gridPool.back();
+    m_gridPool.pop_back();
+    grid->Reuse(id, p.x_coord, p.y_coord, i_gridExpiry, sWorld.getConfig(CONFIG_BOOL_GRID_UNLOAD));
+    return grid;
+}
+
+void Map::ReleaseNGrid(NGridType* grid)
+{
+    grid->unlink();
+
+    if (m_gridPool.size() < MAX_POOLED_GRIDS)
+        m_gridPool.push_back(grid);
+    else
+        delete grid;
+}
+
 void Map::UnloadAll(bool pForce)
 {
     for (GridRefManager<NGridType>::iterator i = GridRefManager<NGridType>::begin(); i != GridRefManager<NGridType>::end();)
@@ -979,12 +1279,14 @@ const char* Map::GetMapName() const
     return i_mapEntry ? i_mapEntry->name[sWorld.GetDefaultDbcLocale()] : "UNNAMEDMAP\x0";
 }
 
-void Map::UpdateObjectVisibility(WorldObject* obj, Cell cell, const CellPair& cellpair)
+void Map::UpdateObjectVisibility(WorldObject* obj, Cell /*cell*/, const CellPair& /*cellpair*/)
 {
-    cell.SetNoCreate();
-    MaNGOS::VisibleChangesNotifier notifier(*obj);
-    TypeContainerVisitor<MaNGOS::VisibleChangesNotifier, WorldTypeMapContainer > player_notifier(notifier);
-    cell.Visit(cellpair, player_notifier, *this, *obj, obj->GetVisibilityData().GetVisibilityDistance());
+    // same cells the grid visit covered, but only cells holding cameras are looked at
+    CellArea area = Cell::CalculateCellArea(obj->GetPositionX(), obj->GetPositionY(), obj->GetVisibilityData().GetVisibilityDistance() + obj->GetObjectBoundingRadius());
+    VisitCameras(area, [obj](Camera* camera)
+    {
+        camera->UpdateVisibilityOf(obj);
+    });
 }
 
 void Map::SendInitSelf(Player* player) const
@@ -1032,6 +1334,18 @@ void Map::SendInitTransports(Player* player) const
     if (tmap.find(player->GetMapId()) == tmap.end())
         return;
 
+    // the packet only differs for players on a transport, everyone else entering in the same tick gets the same one
+    bool shared = !player->GetTransport();
+    if (shared)
+    {
+        std::lock_guard<std::mutex> guard(m_initTransportsLock);
+        if (m_initTransportsPacket && m_initTransportsTime == WorldTimer::tickTime())
+        {
+            player->GetSession()->SendPacket(*m_initTransportsPacket);
+            return;
+        }
+    }
+
     UpdateData transData;
 
     MapManager::TransportSet& tset = tmap[player->GetMapId()];
@@ -1051,6 +1365,13 @@ void Map::SendInitTransports(Player* player) const
     WorldPacket packet;
     transData.BuildPacket(packet, hasTransport);
     player->GetSession()->SendPacket(packet);
+
+    if (shared)
+    {
+        std::lock_guard<std::mutex> guard(m_initTransportsLock);
+        m_initTransportsPacket.reset(new WorldPacket(packet));
+        m_initTransportsTime = WorldTimer::tickTime();
+    }
 }
 
 void Map::SendRemoveTransports(Player* player) const
@@ -1092,6 +1413,7 @@ void Map::AddObjectToRemoveList(WorldObject* obj)
 
     obj->CleanupsBeforeDelete();                            // remove or simplify at least cross referenced links
 
+    std::unique_lock<std::recursive_mutex> guard = LockPartitionedUpdate();
     i_objectsToRemove.insert(obj);
     // DEBUG_LOG("Object (GUID: %u TypeId: %u ) added to removing list.",obj->GetGUIDLow(),obj->GetTypeId());
 }
@@ -1205,6 +1527,8 @@ bool Map::ActiveObjectsNearGrid(uint32 x, uint32 y) const
 
 void Map::AddToActive(WorldObject* obj)
 {
+    std::unique_lock<std::recursive_mutex> guard = LockPartitionedUpdate();
+
     m_activeNonPlayers.insert(obj);
     Cell cell = Cell(MaNGOS::ComputeCellPair(obj->GetPositionX(), obj->GetPositionY()));
     EnsureGridLoaded(cell);
@@ -1233,16 +1557,9 @@ void Map::AddToActive(WorldObject* obj)
 
 void Map::RemoveFromActive(WorldObject* obj)
 {
-    // Map::Update for active object in proccess
-    if (m_activeNonPlayersIter != m_activeNonPlayers.end())
-    {
-        ActiveNonPlayers::iterator itr = m_activeNonPlayers.find(obj);
-        if (itr == m_activeNonPlayersIter)
-            ++m_activeNonPlayersIter;
-        m_activeNonPlayers.erase(itr);
-    }
-    else
-        m_activeNonPlayers.erase(obj);
+    std::unique_lock<std::recursive_mutex> guard = LockPartitionedUpdate();
+
+    m_activeNonPlayers.erase(obj);
 
     // also allow unloading spawn grid
     if (obj->GetTypeId() == TYPEID_UNIT)
@@ -1412,6 +1729,7 @@ void DungeonMap::InitVisibilityDistance()
 {
     // init visibility distance for instances
     m_VisibleDistance = World::GetMaxVisibleDistanceInInstances();
+    m_interestFarDistance = sWorld.getConfig(CONFIG_FLOAT_INTEREST_FAR_DISTANCE_INSTANCES);
 }
 
 /*
@@ -1703,6 +2021,7 @@ void BattleGroundMap::InitVisibilityDistance()
 {
     // init visibility distance for BG
     m_VisibleDistance = World::GetMaxVisibleDistanceInBG();
+    m_interestFarDistance = sWorld.getConfig(CONFIG_FLOAT_INTEREST_FAR_DISTANCE_BGARENAS);
 }
 
 bool BattleGroundMap::CanEnter(Player* player)
@@ -1769,6 +2088,8 @@ bool Map::ScriptsStart(ScriptMapMapName const& scripts, uint32 id, Object* sourc
     ObjectGuid targetGuid = target ? target->GetObjectGuid() : ObjectGuid();
     ObjectGuid ownerGuid  = source->isType(TYPEMASK_ITEM) ? ((Item*)source)->GetOwnerGuid() : ObjectGuid();
 
+    std::unique_lock<std::recursive_mutex> guard = LockPartitionedUpdate();
+
     if (execParams)                                         // Check if the execution should be uniquely
     {
         for (ScriptScheduleMap::const_iterator searchItr = m_scriptSchedule.begin(); searchItr != m_scriptSchedule.end(); ++searchItr)
@@ -1825,6 +2146,8 @@ void Map::ScriptCommandStart(ScriptInfo const& script, uint32 delay, Object* sou
 
     ScriptAction sa("Internal Activate Command used for spell", this, sourceGuid, targetGuid, ownerGuid, &script);
 
+    std::unique_lock<std::recursive_mutex> guard = LockPartitionedUpdate();
+
     if (delay)
     {
         m_scriptSchedule.emplace(GetCurrentClockTime() + std::chrono::milliseconds(delay), sa);
@@ -2012,6 +2335,8 @@ void Map::SendObjectUpdates()
         obj->BuildUpdateData(update_players);
     }
 
+    i_objectsToClientUpdate.swap(i_objectsToDeferredClientUpdate);
+
     WorldPacket packet;                                     // here we allocate a std::vector with a size of 0x10000
     for (auto& update_player : update_players)
     {
@@ -2024,6 +2349,8 @@ void Map::SendObjectUpdates()
 uint32 Map::GenerateLocalLowGuid(HighGuid guidhigh)
 {
     // TODO: for map local guid counters possible force reload map instead shutdown server at guid counter overflow
+    std::unique_lock<std::recursive_mutex> guard = LockPartitionedUpdate();
+
     switch (guidhigh)
     {
         case HIGHGUID_UNIT:
@@ -2455,15 +2782,18 @@ void Map::OnEventHappened(uint16 event_id, bool activate, bool resume)
 
 uint32 Map::SpawnedCountForEntry(uint32 entry)
 {
+    std::unique_lock<std::recursive_mutex> guard = LockPartitionedUpdate();
     return m_spawnedCount[entry].size();
 }
 
 void Map::AddToSpawnCount(const ObjectGuid& guid)
 {
+    std::unique_lock<std::recursive_mutex> guard = LockPartitionedUpdate();
     m_spawnedCount[guid.GetEntry()].insert(guid);
 }
 
 void Map::RemoveFromSpawnCount(const ObjectGuid& guid)
 {
+    std::unique_lock<std::recursive_mutex> guard = LockPartitionedUpdate();
     m_spawnedCount[guid.GetEntry()].erase(guid);
 }
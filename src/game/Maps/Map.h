@@ -29,15 +29,21 @@
 #include "Entities/Object.h"
 #include "Globals/SharedDefines.h"
 #include "Maps/GridMap.h"
+#include "Maps/ActiveCellSet.h"
+#include "Maps/CameraIndex.h"
 #include "GameSystem/GridRefManager.h"
 #include "MapRefManager.h"
 #include "DBScripts/ScriptMgr.h"
 #include "Entities/CreatureLinkingMgr.h"
 #include "vmap/DynamicTree.h"
+#include "World/TickProfiler.h"
+#include "World/OverloadGovernor.h"
 
+#include <atomic>
 #include <bitset>
 #include <functional>
 #include <list>
+#include <memory>
 
 struct CreatureInfo;
 class Creature;
@@ -93,6 +99,23 @@ struct WorldTemplate
 
 #define MIN_UNLOAD_DELAY      1                             // immediate unload
 
+// Map::Update phases recorded by the map's TickProfiler
+enum MapUpdatePhase
+{
+    MAP_PHASE_DYN_TREE,
+    MAP_PHASE_SESSIONS,
+    MAP_PHASE_PLAYERS,
+    MAP_PHASE_MESSAGES,
+    MAP_PHASE_CELL_VISITS,                                  // with parallel continent updates counted in MAP_PHASE_OBJECTS
+    MAP_PHASE_OBJECTS,
+    MAP_PHASE_SEND_UPDATES,
+    MAP_PHASE_GRID_STATES,
+    MAP_PHASE_SCRIPTS,
+    MAP_PHASE_INSTANCE_DATA,
+    MAP_PHASE_WEATHER,
+    MAP_PHASE_COUNT
+};
+
 class Map : public GridRefManager<NGridType>
 {
         friend class MapReference;
@@ -122,7 +145,6 @@ class Map : public GridRefManager<NGridType>
 
         static void DeleteFromWorld(Player* pl);        // player object will deleted at call
 
-        void VisitNearbyCellsOf(WorldObject* obj, TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer> &gridVisitor, TypeContainerVisitor<MaNGOS::ObjectUpdater, WorldTypeMapContainer> &worldVisitor);
         virtual void Update(const uint32&);
 
         void MessageBroadcast(Player const*, WorldPacket const&, bool to_self);
@@ -141,6 +163,10 @@ class Map : public GridRefManager<NGridType>
         float GetVisibilityDistance() const { return m_VisibleDistance; }
         // function for setting up visibility distance for maps on per-type/per-Id basis
         virtual void InitVisibilityDistance();
+        // InitVisibilityDistance reduced by the overload stage
+        void ResetVisibilityDistance();
+        // observers beyond this distance get heartbeats and non critical values at Interest.FarInterval, 0 disables
+        float GetInterestFarDistance() const { return m_interestFarDistance; }
 
         void PlayerRelocation(Player*, float x, float y, float z, float orientation);
         void CreatureRelocation(Creature* creature, float x, float y, float z, float ang);
@@ -199,9 +225,27 @@ class Map : public GridRefManager<NGridType>
 
         void UpdateObjectVisibility(WorldObject* obj, Cell cell, const CellPair& cellpair);
 
-        void resetMarkedCells() { marked_cells.reset(); }
-        bool isCellMarked(uint32 pCellId) const { return marked_cells.test(pCellId); }
-        void markCell(uint32 pCellId) { marked_cells.set(pCellId); }
+        // camera index access, other partitions may place or remove cameras meanwhile
+        template<typename Visitor>
+        void VisitCameras(CellArea const& area, Visitor&& visit)
+        {
+            std::unique_lock<std::recursive_mutex> guard = LockPartitionedUpdate();
+            m_cameraIndex.Visit(area, std::forward<Visitor>(visit));
+        }
+
+        void PlaceCamera(Camera* camera, CellPair const& cell)
+        {
+            std::unique_lock<std::recursive_mutex> guard = LockPartitionedUpdate();
+            m_cameraIndex.Place(camera, cell);
+        }
+
+        void RemoveCamera(Camera* camera)
+        {
+            std::unique_lock<std::recursive_mutex> guard = LockPartitionedUpdate();
+            m_cameraIndex.Remove(camera);
+        }
+
+        bool IsCellActive(uint32 cellId) const { return m_activeCells.IsActive(cellId); }
 
         bool HavePlayers() const { return !m_mapRefManager.isEmpty(); }
         uint32 GetPlayersCountExceptGMs() const;
@@ -254,12 +298,22 @@ class Map : public GridRefManager<NGridType>
 
         void AddUpdateObject(Object* obj)
         {
+            std::unique_lock<std::recursive_mutex> guard = LockPartitionedUpdate();
             i_objectsToClientUpdate.insert(obj);
         }
 
         void RemoveUpdateObject(Object* obj)
         {
+            std::unique_lock<std::recursive_mutex> guard = LockPartitionedUpdate();
             i_objectsToClientUpdate.erase(obj);
+            i_objectsToDeferredClientUpdate.erase(obj);
+        }
+
+        // object built its update but has fields left for later, queued again for the next SendObjectUpdates
+        void DeferUpdateObject(Object* obj)
+        {
+            std::unique_lock<std::recursive_mutex> guard = LockPartitionedUpdate();
+            i_objectsToDeferredClientUpdate.insert(obj);
         }
 
         // DynObjects currently
@@ -318,6 +372,14 @@ class Map : public GridRefManager<NGridType>
         uint32 GetUpdateTimeMin() { return m_updateTimeMin; }
         uint32 GetUpdateTimeMax() { return m_updateTimeMax; }
         uint32 GetUpdateTimeAvg() { return uint32(m_updateTimeTotal / m_cycleCounter); }
+        uint32 GetPredictedUpdateTime() const;
+        TickProfiler const& GetTickProfiler() const { return m_tickProfiler; }
+        OverloadGovernor const& GetOverloadGovernor() const { return m_overloadGovernor; }
+
+        // maps without players may skip ticks (MapUpdate.IdleInterval), the skipped time goes to their next update
+        void AddPendingDiff(uint32 diff) { m_pendingDiff += diff; }
+        uint32 GetPendingDiff() const { return m_pendingDiff; }
+        uint32 TakePendingDiff() { uint32 diff = m_pendingDiff; m_pendingDiff = 0; return diff; }
 
         uint32 GetCurrentMSTime() const;
         TimePoint GetCurrentClockTime() const;
@@ -346,6 +408,10 @@ class Map : public GridRefManager<NGridType>
 
         void buildNGridLinkage(NGridType* pNGridType) { pNGridType->link(this); }
 
+        // unloaded grids are kept for reuse instead of being freed
+        NGridType* AcquireNGrid(const GridPair& p);
+        void ReleaseNGrid(NGridType* grid);
+
         NGridType* getNGrid(uint32 x, uint32 y) const
         {
             MANGOS_ASSERT(x < MAX_NUMBER_OF_GRIDS);
@@ -359,8 +425,29 @@ class Map : public GridRefManager<NGridType>
         void setNGrid(NGridType* grid, uint32 x, uint32 y);
         void ScriptsProcess();
 
+        void UpdateActiveCells();
+
+        // request grids players are about to reach from the grid preloader
+        void PreloadGrids(uint32 diff);
+        void PreloadGridsAlong(float x1, float y1, float x2, float y2);
+
+        // parallel update of continent cells
+        bool CanUpdateCellsInPartitions() const;
+        void UpdateCellsInPartitions(uint32 diff);
+        void ApplyDeferredRelocations();
+
+        // serializes access to map wide containers while cell partitions are updated by several threads
+        std::unique_lock<std::recursive_mutex> LockPartitionedUpdate()
+        {
+            if (!m_updatingPartitions)
+                return std::unique_lock<std::recursive_mutex>();
+
+            return std::unique_lock<std::recursive_mutex>(m_partitionLock);
+        }
+
         void SendObjectUpdates();
         std::set<Object*> i_objectsToClientUpdate;
+        std::set<Object*> i_objectsToDeferredClientUpdate;
 
     protected:
         MapEntry const* i_mapEntry;
@@ -368,6 +455,7 @@ class Map : public GridRefManager<NGridType>
         uint32 i_InstanceId;
         uint32 m_unloadTimer;
         float m_VisibleDistance;
+        float m_interestFarDistance;
         MapPersistentState* m_persistentState;
 
         MapRefManager m_mapRefManager;
@@ -375,7 +463,6 @@ class Map : public GridRefManager<NGridType>
 
         typedef WorldObjectSet ActiveNonPlayers;
         ActiveNonPlayers m_activeNonPlayers;
-        ActiveNonPlayers::iterator m_activeNonPlayersIter;
         MapStoredObjectTypesContainer m_objectsStore;
         std::map<uint32, uint32> m_tempCreatures;
         std::map<uint32, uint32> m_tempPets;
@@ -395,7 +482,32 @@ class Map : public GridRefManager<NGridType>
         TerrainInfo* const m_TerrainData;
         bool m_bLoadedGrids[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
 
-        std::bitset<TOTAL_NUMBER_OF_CELLS_PER_MAP* TOTAL_NUMBER_OF_CELLS_PER_MAP> marked_cells;
+        // cells around players, far sight viewpoints and active objects, see Map::UpdateActiveCells
+        ActiveCellSet m_activeCells;
+
+        // player cameras by the cell of their viewpoint, answers visibility and update broadcast queries
+        CameraIndex m_cameraIndex;
+
+        std::vector<NGridType*> m_gridPool;
+
+        // grid preload prediction, player positions of the previous prediction pass
+        ShortIntervalTimer m_preloadTimer;
+        std::unordered_map<uint64, Position> m_preloadPositions;
+
+        // transport create packet of the tick, shared by all players entering without a transport
+        mutable std::mutex m_initTransportsLock;
+        mutable std::unique_ptr<WorldPacket> m_initTransportsPacket;
+        mutable uint32 m_initTransportsTime;
+
+        // objects collected from the active cells, stamped with the epoch of the current update pass
+        WorldObjectVector m_objectsToUpdate;
+        uint32 m_updateEpoch;
+
+        // Parallel cell update state, see Map::UpdateCellsInPartitions
+        std::atomic<bool> m_updatingPartitions;
+        std::recursive_mutex m_partitionLock;           // also guards the grid containers, readers and writers alike
+        std::mutex m_relocationLock;
+        std::set<ObjectGuid> m_deferredRelocations;
 
         WorldObjectSet i_objectsToRemove;
 
@@ -428,11 +540,17 @@ class Map : public GridRefManager<NGridType>
 
         std::unordered_map<uint32, std::set<ObjectGuid>> m_spawnedCount;
 
+        uint32 m_pendingDiff;
+        uint32 m_currentDiff;
+
         // Map update performance logging
         std::atomic<uint32> m_cycleCounter;
         std::atomic<uint32> m_updateTimeMin;
         std::atomic<uint32> m_updateTimeMax;
+        std::atomic<uint32> m_updateTimeLast;
         std::atomic<uint64> m_updateTimeTotal;
+        TickProfiler m_tickProfiler;
+        OverloadGovernor m_overloadGovernor;
 };
 
 class WorldMap : public Map
@@ -512,6 +630,9 @@ Map::Visit(const Cell& cell, TypeContainerVisitor<T, CONTAINER>& visitor)
     const uint32 cell_x = cell.CellX();
     const uint32 cell_y = cell.CellY();
 
+    // other partitions may add, remove or move objects of these containers meanwhile
+    std::unique_lock<std::recursive_mutex> guard = LockPartitionedUpdate();
+
     if (!cell.NoCreate() || loaded(GridPair(x, y)))
     {
         EnsureGridLoaded(cell);
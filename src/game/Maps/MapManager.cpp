@@ -89,7 +89,7 @@ void MapManager::UpdateGridState(grid_state_t state, Map& map, NGridType& ngrid,
 void MapManager::InitializeVisibilityDistanceInfo()
 {
     for (auto& i_map : i_maps)
-        i_map.second->InitVisibilityDistance();
+        i_map.second->ResetVisibilityDistance();
 }
 
 void MapManager::CreateContinents()
@@ -190,25 +190,54 @@ void MapManager::DeleteInstance(uint32 mapid, uint32 instanceId)
     }
 }
 
+// start the most expensive maps first, so a big continent does not hold the tick at the end
+static void SortByPredictedUpdateTime(std::vector<std::pair<uint32, Map*>>& maps)
+{
+    std::stable_sort(maps.begin(), maps.end(), [](std::pair<uint32, Map*> const& a, std::pair<uint32, Map*> const& b)
+    {
+        return a.first > b.first;
+    });
+}
+
 void MapManager::Update(uint32 diff)
 {
     i_timer.Update(diff);
     if (!i_timer.Passed())
         return;
 
+    diff = (uint32)i_timer.GetCurrent();
+
+    // nobody is watching maps without players, they only need to keep their grids and respawns going
+    uint32 idleInterval = sWorld.getConfig(CONFIG_UINT32_MAP_IDLE_UPDATE_INTERVAL);
+
+    std::vector<std::pair<uint32, Map*>> maps;
+    maps.reserve(i_maps.size());
     for (auto& map : i_maps)
     {
-        if (m_updater.activated())
-            m_updater.schedule_update(new MapUpdateWorker(*map.second, (uint32)i_timer.GetCurrent(), m_updater));
-        else
-            map.second->Update((uint32)i_timer.GetCurrent());
+        map.second->AddPendingDiff(diff);
+        if (!map.second->HavePlayers() && map.second->GetPendingDiff() < idleInterval)
+            continue;
+
+        maps.push_back(std::make_pair(map.second->GetPredictedUpdateTime(), map.second));
     }
 
     if (m_updater.activated())
+    {
+        SortByPredictedUpdateTime(maps);
+
+        for (auto& map : maps)
+            m_updater.schedule_update(new MapUpdateWorker(*map.second, map.second->TakePendingDiff(), m_updater));
+
         m_updater.wait();
+    }
+    else
+    {
+        for (auto& map : maps)
+            map.second->Update(map.second->TakePendingDiff());
+    }
 
     for (Transport* m_Transport : m_Transports)
-        m_Transport->Update((uint32)i_timer.GetCurrent());
+        m_Transport->Update(diff);
 
     // remove all maps which can be unloaded
     MapMapType::iterator iter = i_maps.begin();
@@ -216,7 +245,7 @@ void MapManager::Update(uint32 diff)
     {
         Map* pMap = iter->second;
         // check if map can be unloaded
-        if (pMap->CanUnload((uint32)i_timer.GetCurrent()))
+        if (pMap->CanUnload(diff))
         {
             pMap->UnloadAll(true);
             delete pMap;
@@ -296,6 +325,16 @@ uint32 MapManager::GetNumInstances()
     return ret;
 }
 
+OverloadStage MapManager::GetOverloadStage()
+{
+    std::lock_guard<std::mutex> lock(m_lock);
+
+    OverloadStage stage = OVERLOAD_STAGE_NONE;
+    for (auto& i_map : i_maps)
+        stage = std::max(stage, i_map.second->GetOverloadGovernor().GetStage());
+    return stage;
+}
+
 uint32 MapManager::GetNumPlayersInInstances()
 {
     std::lock_guard<std::mutex> lock(m_lock);
@@ -146,6 +146,8 @@ class MapManager : public MaNGOS::Singleton<MapManager, MaNGOS::ClassLevelLockab
         /* statistics */
         uint32 GetNumInstances();
         uint32 GetNumPlayersInInstances();
+        // highest overload stage of all maps
+        OverloadStage GetOverloadStage();
 
         uint32 GetMapUpdateMinTime(uint32 mapId, uint32 instance = 0);
         uint32 GetMapUpdateMaxTime(uint32 mapId, uint32 instance = 0);
@@ -159,6 +161,9 @@ class MapManager : public MaNGOS::Singleton<MapManager, MaNGOS::ClassLevelLockab
         void DoForAllMaps(const std::function<void(Map*)>& worker);
         void DoForAllMapsWithMapId(uint32 mapId, std::function<void(Map*)> worker);
 
+        // map update thread pool, nullptr when maps are updated in the world thread
+        MapUpdater* GetMapUpdater() { return m_updater.activated() ? &m_updater : nullptr; }
+
     private:
 
         // debugging code, should be deleted some day
@@ -19,10 +19,15 @@
 #include "MapUpdater.h"
 #include "MapWorkers.h"
 
-MapUpdater::MapUpdater(size_t num_threads) : _cancelationToken(false), pending_requests(0)
+#include <algorithm>
+
+// queue owned by the current thread, jobs scheduled from inside a job stay local until stolen
+static thread_local MapUpdater* t_updater = nullptr;
+static thread_local size_t t_queueIndex = 0;
+
+MapUpdater::MapUpdater(size_t num_threads) : _cancelationToken(false), pending_requests(0), queued_requests(0), next_queue(0)
 {
-    for (size_t i = 0; i < num_threads; ++i)
-        _workerThreads.push_back(std::thread(&MapUpdater::WorkerThread, this));
+    activate(num_threads);
 }
 
 void MapUpdater::activate(size_t num_threads)
@@ -31,21 +36,38 @@ void MapUpdater::activate(size_t num_threads)
         return;
 
     for (size_t i = 0; i < num_threads; ++i)
-        _workerThreads.push_back(std::thread(&MapUpdater::WorkerThread, this));
+        _queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue));
+
+    for (size_t i = 0; i < num_threads; ++i)
+        _workerThreads.push_back(std::thread(&MapUpdater::WorkerThread, this, i));
 }
 
 void MapUpdater::deactivate()
 {
     _cancelationToken = true;
 
-    _queue.Cancel();
+    {
+        std::lock_guard<std::mutex> lock(_idleLock);
+        _idleCondition.notify_all();
+    }
 
     for (auto& thread : _workerThreads)
         thread.join();
+
+    for (auto& queue : _queues)
+    {
+        for (Worker* worker : queue->jobs)
+            delete worker;
+
+        queue->jobs.clear();
+    }
 }
 
 void MapUpdater::wait()
 {
+    if (pending_requests == 0)
+        return;
+
     std::unique_lock<std::mutex> lock(_lock);
 
     while (pending_requests > 0)
@@ -65,36 +87,78 @@ bool MapUpdater::activated()
 
 void MapUpdater::update_finished()
 {
-    std::lock_guard<std::mutex> lock(_lock);
+    if (--pending_requests > 0)
+        return;
 
-    --pending_requests;
+    std::lock_guard<std::mutex> lock(_lock);
     _condition.notify_all();
 }
 
 void MapUpdater::schedule_update(Worker* worker)
 {
-    std::lock_guard<std::mutex> lock(_lock);
-
     ++pending_requests;
-    _queue.Push(std::move(worker));
+    ++queued_requests;
+
+    size_t index = t_updater == this ? t_queueIndex : next_queue++ % _queues.size();
+    push(*_queues[index], worker);
+
+    std::lock_guard<std::mutex> lock(_idleLock);
+    _idleCondition.notify_one();
 }
 
-void MapUpdater::WorkerThread()
+void MapUpdater::push(WorkQueue& queue, Worker* worker)
 {
-    while (true)
+    std::lock_guard<std::mutex> lock(queue.lock);
+
+    // most expensive jobs first, equal costs keep scheduling order
+    auto itr = std::upper_bound(queue.jobs.begin(), queue.jobs.end(), worker, [](Worker const* a, Worker const* b)
+    {
+        return a->cost() > b->cost();
+    });
+    queue.jobs.insert(itr, worker);
+}
+
+Worker* MapUpdater::pop(size_t index)
+{
+    // own queue first, then steal from the others
+    for (size_t i = 0; i < _queues.size(); ++i)
     {
-        Worker* request = nullptr;
+        WorkQueue& queue = *_queues[(index + i) % _queues.size()];
+
+        std::lock_guard<std::mutex> lock(queue.lock);
+        if (queue.jobs.empty())
+            continue;
 
-        _queue.WaitAndPop(request);
+        Worker* worker = queue.jobs.front();
+        queue.jobs.pop_front();
+        --queued_requests;
+        return worker;
+    }
+
+    return nullptr;
+}
 
+void MapUpdater::WorkerThread(size_t index)
+{
+    t_updater = this;
+    t_queueIndex = index;
+
+    while (true)
+    {
         if (_cancelationToken)
+            return;
+
+        if (Worker* request = pop(index))
         {
+            request->execute();
+
             delete request;
-            return;
+            continue;
         }
 
-        request->execute();
+        std::unique_lock<std::mutex> lock(_idleLock);
 
-        delete request;
+        while (queued_requests <= 0 && !_cancelationToken)
+            _idleCondition.wait(lock);
     }
-}
\ No newline at end of file
+}
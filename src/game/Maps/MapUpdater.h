@@ -20,23 +20,26 @@
 #define _MAP_UPDATER_H_INCLUDED
 
 #include "Platform/Define.h"
-#include "ProducerConsumerQueue.h"
 
 #include <mutex>
 #include <thread>
 #include <atomic>
+#include <deque>
+#include <memory>
 #include <vector>
 #include <condition_variable>
 
 class Worker;
 
+// Work stealing thread pool: every thread owns a deque ordered by predicted job cost,
+// idle threads steal the most expensive job of the other deques
 class MapUpdater
 {
     public:
-        MapUpdater() : _cancelationToken(false), pending_requests(0) {}
+        MapUpdater() : _cancelationToken(false), pending_requests(0), queued_requests(0), next_queue(0) {}
         MapUpdater(size_t num_threads);
         MapUpdater(const MapUpdater&) = delete;
-        
+
         void activate(size_t num_threads);
         void deactivate();
         void wait();
@@ -46,16 +49,32 @@ class MapUpdater
         void schedule_update(Worker* worker);
 
     private:
-        ProducerConsumerQueue<Worker *> _queue;
+        struct WorkQueue
+        {
+            std::mutex lock;
+            std::deque<Worker*> jobs;
+        };
+
+        std::vector<std::unique_ptr<WorkQueue>> _queues;
 
         std::vector<std::thread> _workerThreads;
         std::atomic<bool> _cancelationToken;
 
+        // completion latch, the lock is only taken by the last finished job and by waiting threads
+        std::atomic<size_t> pending_requests;
         std::mutex _lock;
         std::condition_variable _condition;
-        size_t pending_requests;
 
-        void WorkerThread();
+        // sleeping worker threads
+        std::atomic<int32> queued_requests;
+        std::mutex _idleLock;
+        std::condition_variable _idleCondition;
+
+        std::atomic<size_t> next_queue;
+
+        void WorkerThread(size_t index);
+        void push(WorkQueue& queue, Worker* worker);
+        Worker* pop(size_t index);
 };
 
-#endif //_MAP_UPDATER_H_INCLUDED
\ No newline at end of file
+#endif //_MAP_UPDATER_H_INCLUDED
@@ -26,11 +26,17 @@
 #include "Entities/Object.h"
 #include "Platform/Define.h"
 
+#include <limits>
+#include <memory>
+
 class Worker
 {
     public:
         Worker(MapUpdater& updater) : m_updater(updater) {}
+        virtual ~Worker() {}
         virtual void execute() {};
+        // predicted execution time in ms, expensive jobs are started first
+        virtual uint32 cost() const { return 0; }
 
     protected:
         MapUpdater& GetWorker() { return m_updater; }
@@ -52,38 +58,98 @@ class MapUpdateWorker : public Worker
             GetWorker().update_finished();
         }
 
+        uint32 cost() const override { return m_map.GetPredictedUpdateTime(); }
+
     private:
         Map& m_map;
         uint32 m_diff;
 };
 
-class GridCrawler : public Worker
+// Active cells of one map split into spatially separated partitions.
+// Shared between the map update thread and its GridCrawlers, any of them may claim the next partition.
+class CellPartitions
 {
     public:
-        GridCrawler(Map& map, std::vector<Cell> &cells, uint32 diff, MapUpdater& updater) :
-            Worker(updater), m_map(map), m_cells(cells), m_diff(diff)
+        typedef std::vector<CellPair> Partition;
+
+        CellPartitions(std::vector<Partition>&& partitions, uint32 diff, uint32 epoch) :
+            m_partitions(std::move(partitions)), m_diff(diff), m_epoch(epoch), m_nextPartition(0), m_pendingPartitions(m_partitions.size())
         {}
 
-        void execute() override
-        {
-            WorldObjectUnSet objToUpdate;
-            MaNGOS::ObjectUpdater obj_updater(objToUpdate, m_diff);
-            TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer  > grid_object_update(obj_updater);    // For creature
-            TypeContainerVisitor<MaNGOS::ObjectUpdater, WorldTypeMapContainer > world_object_update(obj_updater);   // For pets
+        size_t size() const { return m_partitions.size(); }
 
-            for (auto &cell : m_cells)
+        // update partitions until none is left to claim
+        void Process(Map& map)
+        {
+            WorldObjectVector objToUpdate;
+            for (size_t index = m_nextPartition++; index < m_partitions.size(); index = m_nextPartition++)
             {
-                m_map.Visit(cell, grid_object_update);
-                m_map.Visit(cell, world_object_update);
+                // partitions never share a cell, so the epoch stamps of one pass are never written concurrently
+                MaNGOS::ObjectUpdater obj_updater(objToUpdate, m_epoch);
+                TypeContainerVisitor<MaNGOS::ObjectUpdater, GridTypeMapContainer  > grid_object_update(obj_updater);    // For creature
+                TypeContainerVisitor<MaNGOS::ObjectUpdater, WorldTypeMapContainer > world_object_update(obj_updater);   // For pets
+
+                for (auto& pair : m_partitions[index])
+                {
+                    Cell cell(pair);
+                    cell.SetNoCreate();
+                    map.Visit(cell, grid_object_update);
+                    map.Visit(cell, world_object_update);
+                }
+
+                for (auto wObj : objToUpdate)
+                    wObj->Update(m_diff);
+                objToUpdate.clear();
+
+                if (--m_pendingPartitions == 0)
+                {
+                    std::lock_guard<std::mutex> lock(m_lock);
+                    m_condition.notify_all();
+                }
             }
+        }
+
+        // wait for partitions claimed by other threads
+        void Wait()
+        {
+            std::unique_lock<std::mutex> lock(m_lock);
+
+            while (m_pendingPartitions > 0)
+                m_condition.wait(lock);
+        }
+
+    private:
+        std::vector<Partition> m_partitions;
+        uint32 m_diff;
+        uint32 m_epoch;
+
+        std::atomic<size_t> m_nextPartition;
+        std::atomic<size_t> m_pendingPartitions;
+
+        std::mutex m_lock;
+        std::condition_variable m_condition;
+};
+
+class GridCrawler : public Worker
+{
+    public:
+        GridCrawler(Map& map, std::shared_ptr<CellPartitions> partitions, MapUpdater& updater) :
+            Worker(updater), m_map(map), m_partitions(partitions)
+        {}
+
+        void execute() override
+        {
+            m_partitions->Process(m_map);
 
             GetWorker().update_finished();
         }
 
+        // the map update thread is waiting for its partitions
+        uint32 cost() const override { return std::numeric_limits<uint32>::max(); }
+
     private:
         Map& m_map;
-        std::vector<Cell> &m_cells;
-        uint32 m_diff;
+        std::shared_ptr<CellPartitions> m_partitions;
 };
 
 
@@ -121,6 +121,9 @@ namespace MMAP
         for (auto& loadedMMap : loadedMMaps)
             delete loadedMMap.second;
 
+        for (auto& preloadedTile : m_preloadedTiles)
+            dtFree(preloadedTile.second.data);
+
         // by now we should not have maps loaded
         // if we had, tiles in MMapData->mmapLoadedTiles, their actual data is lost!
     }
@@ -212,7 +215,32 @@ namespace MMAP
             return false;
         }
 
-        // load this tile :: mmaps/MMMXXYY.mmtile
+        unsigned char* data = nullptr;
+        uint32 size = 0;
+        if (!takePreloadedTile(mapId, x, y, data, size) && !readTile(mapId, x, y, data, size))
+            return false;
+
+        dtMeshHeader* header = (dtMeshHeader*)data;
+        dtTileRef tileRef = 0;
+
+        // memory allocated for data is now managed by detour, and will be deallocated when the tile is removed
+        dtStatus dtResult = mmap->navMesh->addTile(data, size, DT_TILE_FREE_DATA, 0, &tileRef);
+        if (dtStatusFailed(dtResult))
+        {
+            sLog.outError("MMAP:loadMap: Could not load %03u%02i%02i.mmtile into navmesh", mapId, x, y);
+            dtFree(data);
+            return false;
+        }
+
+        mmap->mmapLoadedTiles.insert(std::pair<uint32, dtTileRef>(packedGridPos, tileRef));
+        ++loadedTiles;
+        DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:loadMap: Loaded mmtile %03i[%02i,%02i] into %03i[%02i,%02i]", mapId, x, y, mapId, header->x, header->y);
+        return true;
+    }
+
+    // load this tile :: mmaps/MMMXXYY.mmtile
+    bool MMapManager::readTile(uint32 mapId, int32 x, int32 y, unsigned char*& data, uint32& size) const
+    {
         uint32 pathLen = sWorld.GetDataPath().length() + strlen("mmaps/%03i%02i%02i.mmtile") + 1;
         char* fileName = new char[pathLen];
         snprintf(fileName, pathLen, (sWorld.GetDataPath() + "mmaps/%03i%02i%02i.mmtile").c_str(), mapId, x, y);
@@ -245,7 +273,7 @@ namespace MMAP
             return false;
         }
 
-        unsigned char* data = (unsigned char*)dtAlloc(fileHeader.size, DT_ALLOC_PERM);
+        data = (unsigned char*)dtAlloc(fileHeader.size, DT_ALLOC_PERM);
         MANGOS_ASSERT(data);
 
         size_t result = fread(data, fileHeader.size, 1, file);
@@ -253,29 +281,56 @@ namespace MMAP
         {
             sLog.outError("MMAP:loadMap: Bad header or data in mmap %03u%02i%02i.mmtile", mapId, x, y);
             fclose(file);
+            dtFree(data);
             return false;
         }
 
         fclose(file);
 
-        dtMeshHeader* header = (dtMeshHeader*)data;
-        dtTileRef tileRef = 0;
+        size = fileHeader.size;
+        return true;
+    }
 
-        // memory allocated for data is now managed by detour, and will be deallocated when the tile is removed
-        dtStatus dtResult = mmap->navMesh->addTile(data, fileHeader.size, DT_TILE_FREE_DATA, 0, &tileRef);
-        if (dtStatusFailed(dtResult))
+    bool MMapManager::preloadTile(uint32 mapId, int32 x, int32 y)
+    {
+        uint64 key = (uint64(mapId) << 32) | packTileID(x, y);
         {
-            sLog.outError("MMAP:loadMap: Could not load %03u%02i%02i.mmtile into navmesh", mapId, x, y);
-            dtFree(data);
-            return false;
+            std::lock_guard<std::mutex> lock(m_preloadLock);
+            if (m_preloadedTiles.find(key) != m_preloadedTiles.end())
+                return true;
         }
 
-        mmap->mmapLoadedTiles.insert(std::pair<uint32, dtTileRef>(packedGridPos, tileRef));
-        ++loadedTiles;
-        DEBUG_FILTER_LOG(LOG_FILTER_MAP_LOADING, "MMAP:loadMap: Loaded mmtile %03i[%02i,%02i] into %03i[%02i,%02i]", mapId, x, y, mapId, header->x, header->y);
+        PreloadedTile tile;
+        if (!readTile(mapId, x, y, tile.data, tile.size))
+            return false;
+
+        std::lock_guard<std::mutex> lock(m_preloadLock);
+        if (!m_preloadedTiles.insert(PreloadedTileMap::value_type(key, tile)).second)
+            dtFree(tile.data);
+        return true;
+    }
+
+    bool MMapManager::takePreloadedTile(uint32 mapId, int32 x, int32 y, unsigned char*& data, uint32& size)
+    {
+        std::lock_guard<std::mutex> lock(m_preloadLock);
+        PreloadedTileMap::iterator itr = m_preloadedTiles.find((uint64(mapId) << 32) | packTileID(x, y));
+        if (itr == m_preloadedTiles.end())
+            return false;
+
+        data = itr->second.data;
+        size = itr->second.size;
+        m_preloadedTiles.erase(itr);
         return true;
     }
 
+    void MMapManager::dropPreloadedTile(uint32 mapId, int32 x, int32 y)
+    {
+        unsigned char* data;
+        uint32 size;
+        if (takePreloadedTile(mapId, x, y, data, size))
+            dtFree(data);
+    }
+
     bool MMapManager::unloadMap(uint32 mapId, int32 x, int32 y)
     {
         // check if we have this map loaded
@@ -66,6 +66,17 @@ namespace MMAP
 
     typedef std::unordered_map<uint32, MMapData*> MMapDataSet;
 
+    // tile file read ahead of loadMap, the navmesh itself is only touched by loadMap
+    struct PreloadedTile
+    {
+        PreloadedTile() : data(nullptr), size(0) {}
+
+        unsigned char* data;
+        uint32 size;
+    };
+
+    typedef std::unordered_map<uint64, PreloadedTile> PreloadedTileMap;
+
     // singelton class
     // holds all all access to mmap loading unloading and meshes
     class MMapManager
@@ -80,6 +91,10 @@ namespace MMAP
             bool unloadMapInstance(uint32 mapId, uint32 instanceId);
             bool IsMMapIsLoaded(uint32 mapId, uint32 x, uint32 y) const;
 
+            // thread safe, used by the grid preloader
+            bool preloadTile(uint32 mapId, int32 x, int32 y);
+            void dropPreloadedTile(uint32 mapId, int32 x, int32 y);
+
             // the returned [dtNavMeshQuery const*] is NOT threadsafe
             dtNavMeshQuery const* GetNavMeshQuery(uint32 mapId, uint32 instanceId);
             dtNavMesh const* GetNavMesh(uint32 mapId);
@@ -89,9 +104,14 @@ namespace MMAP
         private:
             bool loadMapData(uint32 mapId);
             uint32 packTileID(int32 x, int32 y) const;
+            bool readTile(uint32 mapId, int32 x, int32 y, unsigned char*& data, uint32& size) const;
+            bool takePreloadedTile(uint32 mapId, int32 x, int32 y, unsigned char*& data, uint32& size);
 
             MMapDataSet loadedMMaps;
             uint32 loadedTiles;
+
+            std::mutex m_preloadLock;
+            PreloadedTileMap m_preloadedTiles;
     };
 
     // static class
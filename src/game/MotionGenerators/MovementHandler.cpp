@@ -28,6 +28,7 @@
 #include "WaypointMovementGenerator.h"
 #include "Maps/MapPersistentStateMgr.h"
 #include "Globals/ObjectMgr.h"
+#include "World/World.h"
 
 #define MOVEMENT_PACKET_TIME_DELAY 0
 
@@ -273,9 +274,37 @@ void WorldSession::HandleMovementOpcodes(WorldPacket& recv_data)
     if (plMover)
         plMover->UpdateFallInformationIfNeed(movementInfo, opcode);
 
+    // overloaded maps relay plain heartbeats less often, movement start/stop changes are always sent
+    if (opcode == MSG_MOVE_HEARTBEAT)
+    {
+        if (uint32 interval = mover->GetMap()->GetOverloadGovernor().GetHeartbeatInterval())
+        {
+            uint32 now = WorldTimer::getMSTime();
+            if (WorldTimer::getMSTimeDiff(m_heartbeatRelayTime, now) < interval)
+                return;
+
+            m_heartbeatRelayTime = now;
+        }
+    }
+
     WorldPacket data(opcode, recv_data.size());
     data << mover->GetPackGUID();             // write guid
     movementInfo.Write(data);                               // write data
+
+    // observers in the far interest band get plain heartbeats only every Interest.FarInterval
+    float farDistance = mover->GetMap()->GetInterestFarDistance();
+    if (opcode == MSG_MOVE_HEARTBEAT && farDistance > 0.0f)
+    {
+        uint32 now = WorldTimer::getMSTime();
+        if (WorldTimer::getMSTimeDiff(m_farHeartbeatRelayTime, now) < sWorld.getConfig(CONFIG_UINT32_INTEREST_FAR_INTERVAL))
+        {
+            mover->SendMessageToInterestedExcept(data, _player, farDistance);
+            return;
+        }
+
+        m_farHeartbeatRelayTime = now;
+    }
+
     mover->SendMessageToSetExcept(data, _player);
 }
 
@@ -0,0 +1,88 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "Server/PacketPool.h"
+#include "Policies/Singleton.h"
+
+INSTANTIATE_SINGLETON_1(PacketPool);
+
+PacketPool::PacketPool()
+{
+    // movement and most other client packets fit the first class, 0x2800 is the largest client packet
+    size_t const capacities[ClassCount] = { 64, 256, 1024, 0x2800 };
+
+    for (size_t i = 0; i < ClassCount; ++i)
+        m_classes[i].capacity = capacities[i];
+}
+
+PacketPool::~PacketPool()
+{
+    for (auto& sizeClass : m_classes)
+        for (WorldPacket* packet : sizeClass.free)
+            delete packet;
+}
+
+std::unique_ptr<WorldPacket> PacketPool::Acquire(uint16 opcode, size_t size)
+{
+    for (auto& sizeClass : m_classes)
+    {
+        if (size > sizeClass.capacity)
+            continue;
+
+        {
+            std::lock_guard<std::mutex> guard(sizeClass.lock);
+            if (!sizeClass.free.empty())
+            {
+                std::unique_ptr<WorldPacket> packet(sizeClass.free.back());
+                sizeClass.free.pop_back();
+                packet->SetOpcode(opcode);
+                return packet;
+            }
+        }
+
+        return std::unique_ptr<WorldPacket>(new WorldPacket(opcode, sizeClass.capacity));
+    }
+
+    return std::unique_ptr<WorldPacket>(new WorldPacket(opcode, size));
+}
+
+void PacketPool::Release(std::unique_ptr<WorldPacket> packet)
+{
+    if (!packet)
+        return;
+
+    // largest class the packet can serve
+    size_t const capacity = packet->capacity();
+    for (size_t i = ClassCount; i > 0; --i)
+    {
+        SizeClass& sizeClass = m_classes[i - 1];
+        if (capacity < sizeClass.capacity)
+            continue;
+
+        // a packet grown by a burst is not kept
+        if (i == ClassCount && capacity > sizeClass.capacity * 2)
+            return;
+
+        packet->clear();
+
+        std::lock_guard<std::mutex> guard(sizeClass.lock);
+        if (sizeClass.free.size() < MaxFreePerClass)
+            sizeClass.free.push_back(packet.release());
+        return;
+    }
+}
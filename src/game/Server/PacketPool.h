@@ -0,0 +1,60 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_PACKETPOOL_H
+#define MANGOS_PACKETPOOL_H
+
+#include "Common.h"
+#include "WorldPacket.h"
+#include "Policies/Singleton.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Client packets reused between the network threads receiving and the threads handling them.
+// Packets are kept in size classes by their storage capacity, so a reused packet never has to grow.
+class PacketPool
+{
+    public:
+        PacketPool();
+        ~PacketPool();
+
+        // empty packet with room for at least size bytes
+        std::unique_ptr<WorldPacket> Acquire(uint16 opcode, size_t size);
+
+        // return a handled packet, any packet is accepted
+        void Release(std::unique_ptr<WorldPacket> packet);
+
+    private:
+        struct SizeClass
+        {
+            size_t capacity;
+            std::mutex lock;
+            std::vector<WorldPacket*> free;
+        };
+
+        static size_t const ClassCount = 4;
+        static size_t const MaxFreePerClass = 4096;         // per class, anything above is freed
+
+        SizeClass m_classes[ClassCount];
+};
+
+#define sPacketPool MaNGOS::Singleton<PacketPool>::Instance()
+
+#endif
@@ -27,6 +27,7 @@
 #include "Server/Opcodes.h"
 #include "WorldPacket.h"
 #include "Server/WorldSession.h"
+#include "Server/PacketPool.h"
 #include "Entities/Player.h"
 #include "Globals/ObjectMgr.h"
 #include "Groups/Group.h"
@@ -96,7 +97,8 @@ WorldSession::WorldSession(uint32 id, WorldSocket* sock, AccountTypes sec, time_
     m_inQueue(false), m_playerLoading(false), m_playerLogout(false), m_playerRecentlyLogout(false), m_playerSave(false),
     m_sessionDbcLocale(sWorld.GetAvailableDbcLocale(locale)), m_sessionDbLocaleIndex(sObjectMgr.GetIndexForLocale(locale)),
     m_latency(0), m_clientTimeDelay(0), m_tutorialState(TUTORIALDATA_UNCHANGED), m_sessionState(WORLD_SESSION_STATE_CREATED),
-    m_requestSocket(nullptr) {}
+    m_requestSocket(nullptr), m_recvQueue(256), m_hasRecvOverflow(false), m_heartbeatRelayTime(0), m_farHeartbeatRelayTime(0), m_headless(false), m_sentPacketCount(0), m_sentPacketBytes(0), m_hasCoalesced(false),
+    m_queryResultQueue(std::make_shared<SqlResultQueue>()) {}
 
 /// WorldSession destructor
 WorldSession::~WorldSession()
@@ -142,7 +144,7 @@ void WorldSession::SetOffline()
 
 void WorldSession::SetOnline()
 {
-    if (_player && m_Socket && !m_Socket->IsClosed())
+    if (_player && (m_headless || (m_Socket && !m_Socket->IsClosed())))
         m_sessionState = WORLD_SESSION_STATE_READY;
 }
 
@@ -171,6 +173,106 @@ char const* WorldSession::GetPlayerName() const
 
 /// Send a packet to the client
 void WorldSession::SendPacket(WorldPacket const& packet, bool forcedSend /*= false*/) const
+{
+    if (PrepareSend(packet, forcedSend) && !CoalescePacket(packet))
+        m_Socket->SendPacket(packet);
+}
+
+/// Send a packet shared with other sessions, its payload is referenced by the socket instead of copied
+void WorldSession::SendPacket(SharedWorldPacket const& packet) const
+{
+    if (PrepareSend(*packet, false) && !CoalescePacket(*packet))
+        m_Socket->SendPacket(packet);
+}
+
+/// Movement opcodes where a newer packet of the same object supersedes an older one
+static bool IsCoalescableMovement(uint16 opcode)
+{
+    return opcode == MSG_MOVE_HEARTBEAT || opcode == SMSG_MONSTER_MOVE;
+}
+
+/// Movement opcodes which carry the full position of the moving object
+static bool IsMovementUpdate(uint16 opcode)
+{
+    return (opcode >= MSG_MOVE_START_FORWARD && opcode <= MSG_MOVE_STOP_SWIM) ||
+           opcode == MSG_MOVE_SET_FACING || opcode == MSG_MOVE_SET_PITCH || IsCoalescableMovement(opcode);
+}
+
+/// Packed guid at the start of a movement packet
+static ObjectGuid ReadLeadingPackGuid(WorldPacket const& packet)
+{
+    if (packet.empty())
+        return ObjectGuid();
+
+    uint8 const* data = packet.contents();
+    uint8 mask = data[0];
+    size_t pos = 1;
+    uint64 guid = 0;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        if (mask & (uint8(1) << i))
+        {
+            if (pos >= packet.size())
+                return ObjectGuid();
+            guid |= uint64(data[pos++]) << (i * 8);
+        }
+    }
+
+    return ObjectGuid(guid);
+}
+
+/// Hold back movement a congested client would only receive after a newer one, returns true when the packet was held
+bool WorldSession::CoalescePacket(WorldPacket const& packet) const
+{
+    if (!m_hasCoalesced && !m_Socket->IsCongested())
+        return false;
+
+    uint16 opcode = packet.GetOpcode();
+    if (!IsMovementUpdate(opcode))
+        return false;
+
+    ObjectGuid guid = ReadLeadingPackGuid(packet);
+    if (guid.IsEmpty())
+        return false;
+
+    std::lock_guard<std::mutex> guard(m_coalesceLock);
+
+    // anything sent for the object now supersedes the held position
+    if (!IsCoalescableMovement(opcode) || !m_Socket->IsCongested())
+    {
+        m_coalescedPackets.erase(guid);
+        m_hasCoalesced = !m_coalescedPackets.empty();
+        return false;
+    }
+
+    m_coalescedPackets[guid] = packet;
+    m_hasCoalesced = true;
+    return true;
+}
+
+/// Send the movement held back once the socket drained below its low watermark
+void WorldSession::SendCoalescedPackets()
+{
+    if (!m_hasCoalesced || (m_Socket && m_Socket->IsCongested()))
+        return;
+
+    std::map<ObjectGuid, WorldPacket> packets;
+    {
+        std::lock_guard<std::mutex> guard(m_coalesceLock);
+        packets.swap(m_coalescedPackets);
+        m_hasCoalesced = false;
+    }
+
+    if (!m_Socket)
+        return;
+
+    for (auto const& itr : packets)
+        m_Socket->SendPacket(itr.second);
+}
+
+/// Common part of sending a packet, returns true when it has to be written to the socket
+bool WorldSession::PrepareSend(WorldPacket const& packet, bool forcedSend) const
 {
 #ifdef BUILD_PLAYERBOT
     // Send packet to bot AI
@@ -183,12 +285,18 @@ void WorldSession::SendPacket(WorldPacket const& packet, bool forcedSend /*= fal
     }
 #endif
 
-    if (!m_Socket || (m_sessionState != WORLD_SESSION_STATE_READY && !forcedSend))
+    if (m_sessionState != WORLD_SESSION_STATE_READY && !forcedSend)
     {
         //sLog.outDebug("Refused to send %s to %s", packet.GetOpcodeName(), _player ? _player->GetName() : "UKNOWN");
-        return;
+        return false;
     }
 
+    ++m_sentPacketCount;
+    m_sentPacketBytes += packet.size();
+
+    if (!m_Socket)
+        return false;
+
 #ifdef MANGOS_DEBUG
 
     // Code for network use statistic
@@ -225,14 +333,55 @@ void WorldSession::SendPacket(WorldPacket const& packet, bool forcedSend /*= fal
 
 #endif                                                  // !MANGOS_DEBUG
 
-    m_Socket->SendPacket(packet);
+    return true;
+}
+
+void BroadcastPacket::SendTo(WorldSession& session)
+{
+    if (m_packet.size() < WorldSocket::SharedPayloadMinSize)
+    {
+        session.SendPacket(m_packet);
+        return;
+    }
+
+    if (!m_shared)
+        m_shared = std::make_shared<WorldPacket const>(m_packet);
+
+    session.SendPacket(m_shared);
 }
 
 /// Add an incoming packet to the queue
 void WorldSession::QueuePacket(std::unique_ptr<WorldPacket> new_packet)
 {
-    std::lock_guard<std::mutex> guard(m_recvQueueLock);
-    m_recvQueue.push_back(std::move(new_packet));
+    std::lock_guard<std::mutex> guard(m_recvPushLock);
+
+    // keep the order, nothing enters the ring again before the overflow is drained
+    if (!m_hasRecvOverflow && m_recvQueue.Push(new_packet))
+        return;
+
+    m_recvOverflow.push_back(std::move(new_packet));
+    m_hasRecvOverflow = true;
+}
+
+/// Take the oldest incoming packet, called by the session update only
+bool WorldSession::NextPacket(std::unique_ptr<WorldPacket>& packet)
+{
+    if (m_recvQueue.Pop(packet))
+        return true;
+
+    if (!m_hasRecvOverflow)
+        return false;
+
+    std::lock_guard<std::mutex> guard(m_recvPushLock);
+
+    // the ring may have been drained after the producer saw it full
+    if (m_recvOverflow.empty())
+        return false;
+
+    packet = std::move(m_recvOverflow.front());
+    m_recvOverflow.pop_front();
+    m_hasRecvOverflow = !m_recvOverflow.empty();
+    return true;
 }
 
 /// Logging helper for unexpected opcodes
@@ -258,13 +407,18 @@ bool WorldSession::Update(PacketFilter& updater)
 {
     std::lock_guard<std::mutex> guard(m_recvQueueLock);
 
+    SendCoalescedPackets();
+
+    // query continuations run in the world pass only, like the packets not safe for the map update,
+    // no map is updating then
+    if (updater.ProcessLogout())
+        m_queryResultQueue->Update();
+
     ///- Retrieve packets from the receive queue and call the appropriate handlers
     /// not process packets if socket already closed
-    while (m_Socket && !m_Socket->IsClosed() && !m_recvQueue.empty())
+    std::unique_ptr<WorldPacket> packet;
+    while ((m_Socket ? !m_Socket->IsClosed() : m_headless) && NextPacket(packet))
     {
-        auto const packet = std::move(m_recvQueue.front());
-        m_recvQueue.pop_front();
-
         /*#if 1
         sLog.outError( "MOEP: %s (0x%.4X)",
                         packet->GetOpcodeName(),
@@ -359,6 +513,8 @@ bool WorldSession::Update(PacketFilter& updater)
                 KickPlayer();
             }
         }
+
+        sPacketPool.Release(std::move(packet));
     }
 
 #ifdef BUILD_PLAYERBOT
@@ -373,15 +529,13 @@ bool WorldSession::Update(PacketFilter& updater)
         {
             Player* const botPlayer = itr->second;
             WorldSession* const pBotWorldSession = botPlayer->GetSession();
-            while(!pBotWorldSession->m_recvQueue.empty())
+            std::unique_ptr<WorldPacket> botpacket;
+            while (pBotWorldSession->NextPacket(botpacket))
             {
-                auto const botpacket = std::move(pBotWorldSession->m_recvQueue.front());
-                pBotWorldSession->m_recvQueue.pop_front();
-
                 OpcodeHandler const& opHandle = opcodeTable[botpacket->GetOpcode()];
                 pBotWorldSession->ExecuteOpcode(opHandle, *botpacket);
+                sPacketPool.Release(std::move(botpacket));
             }
-            pBotWorldSession->m_recvQueue.clear();
         }
     }
 #endif
@@ -401,6 +555,12 @@ bool WorldSession::Update(PacketFilter& updater)
 
                     m_Socket = m_requestSocket;
                     m_requestSocket = nullptr;
+                    {
+                        // the new client does not know the objects the held movement belongs to
+                        std::lock_guard<std::mutex> coalesceGuard(m_coalesceLock);
+                        m_coalescedPackets.clear();
+                        m_hasCoalesced = false;
+                    }
                     sLog.outDetail("New Session key %s", m_Socket->GetSessionKey().AsHexStr());
                     SendAuthOk();
                 }
@@ -419,7 +579,7 @@ bool WorldSession::Update(PacketFilter& updater)
 
                 // waiting to go online
                 // TODO:: Maybe check if have to send queue update?
-                if (!m_Socket || (m_Socket && m_Socket->IsClosed()))
+                if (!m_headless && (!m_Socket || m_Socket->IsClosed()))
                 {
                     // directly remove this session
                     return false;
@@ -29,8 +29,11 @@
 #include "AuctionHouse/AuctionHouseMgr.h"
 #include "Entities/Item.h"
 #include "Server/WorldSocket.h"
+#include "SpscQueue.h"
 
+#include <atomic>
 #include <deque>
+#include <map>
 #include <mutex>
 #include <memory>
 
@@ -47,6 +50,7 @@ class Player;
 class Unit;
 class WorldPacket;
 class QueryResult;
+class SqlResultQueue;
 class LoginQueryHolder;
 class CharacterHandler;
 class GMTicket;
@@ -99,6 +103,20 @@ struct CharacterNameQueryResponse
     uint32              classid     = 0;        // pc's class
 };
 
+// CMSG_SEND_MAIL content, kept while an offline receiver is looked up
+struct SendMailRequest
+{
+    ObjectGuid          mailbox;
+    ObjectGuid          item;
+    std::string         receiver;
+    std::string         subject;
+    std::string         body;
+    uint32              money       = 0;
+    uint32              COD         = 0;
+    uint32              unk1        = 0;                // stationery?
+    uint32              unk2        = 0;
+};
+
 // class to deal with packet processing
 // allows to determine if next packet is safe to be processed
 class PacketFilter
@@ -161,6 +179,7 @@ class WorldSession
         void SizeError(WorldPacket const& packet, uint32 size) const;
 
         void SendPacket(WorldPacket const& packet, bool forcedSend = false) const;
+        void SendPacket(SharedWorldPacket const& packet) const;
         void SendExpectedSpamRecords();
         void SendMotd(Player* currChar);
         void SendOfflineNameQueryResponses();
@@ -183,6 +202,19 @@ class WorldSession
 #else
         const std::string GetRemoteAddress() const { return m_Socket ? m_Socket->GetRemoteAddress() : "disconnected"; }
 #endif
+        // delay of buffered packets before they are sent, in microseconds, false without socket
+        bool GetSendDelay(uint32& average, uint32& max) const
+        {
+            if (!m_Socket)
+                return false;
+
+            m_Socket->GetFlushDelay(average, max);
+            return true;
+        }
+        // bytes written to the socket and not yet sent to the client
+        size_t GetSendQueueBytes() const { return m_Socket ? m_Socket->GetOutQueueBytes() : 0; }
+        // send what was buffered for the client without waiting for the end of the world tick
+        void FlushSocket() { if (m_Socket) m_Socket->FlushBuffered(); }
         void SetPlayer(Player* plr) { _player = plr; }
 
         /// Session in auth.queue currently
@@ -211,10 +243,22 @@ class WorldSession
         void LogoutPlayer(bool save);
         void KickPlayer();
 
+        /// Add an incoming packet, usually from the network thread while the session update is running.
+        /// Not lock-free: pushes take m_recvPushLock, as the socket, playerbots and the load test all
+        /// queue packets. The session update, map or world pass, is the single consumer and only takes
+        /// the lock while the overflow list is in use.
         void QueuePacket(std::unique_ptr<WorldPacket> new_packet);
 
         bool Update(PacketFilter& updater);
 
+        /// Session without client connection driven through QueuePacket (load test harness)
+        void SetHeadless() { m_headless = true; }
+        bool IsHeadless() const { return m_headless; }
+
+        /// Packets and bytes sent to the client so far
+        uint64 GetSentPacketCount() const { return m_sentPacketCount; }
+        uint64 GetSentPacketBytes() const { return m_sentPacketBytes; }
+
         /// Handle the authentication waiting queue (to be completed)
         void SendAuthWaitQue(uint32 position) const;
 
@@ -311,6 +355,11 @@ class WorldSession
         void ResetClientTimeDelay() { m_clientTimeDelay = 0; }
         uint32 getDialogStatus(const Player* pPlayer, const Object* questgiver, uint32 defstatus) const;
 
+        // async query results for this session, the continuations run in its next world update pass, where maps
+        // are not updating (all map updates finish inside MapManager::Update). A player changing maps meanwhile
+        // still gets the result.
+        std::shared_ptr<SqlResultQueue> const& GetQueryResultQueue() const { return m_queryResultQueue; }
+
         // Misc
         void SendKnockBack(float angle, float horizontalSpeed, float verticalSpeed) const;
         void SendPlaySpellVisual(ObjectGuid guid, uint32 spellArtKit) const;
@@ -457,6 +506,7 @@ class WorldSession
         void HandlePetitionQueryOpcode(WorldPacket& recv_data);
         void HandlePetitionRenameOpcode(WorldPacket& recv_data);
         void HandlePetitionSignOpcode(WorldPacket& recv_data);
+        void HandlePetitionSign(QueryResult* result, ObjectGuid petitionGuid);
         void HandlePetitionDeclineOpcode(WorldPacket& recv_data);
         void HandleOfferPetitionOpcode(WorldPacket& recv_data);
         void HandleTurnInPetitionOpcode(WorldPacket& recv_data);
@@ -534,6 +584,7 @@ class WorldSession
 
         void HandleGetMailList(WorldPacket& recv_data);
         void HandleSendMail(WorldPacket& recv_data);
+        void HandleSendMailTo(SendMailRequest const& request, ObjectGuid rc, Player* receive, Team rc_team, uint32 rc_account, uint32 mails_count);
         void HandleMailTakeMoney(WorldPacket& recv_data);
         void HandleMailTakeItem(WorldPacket& recv_data);
         void HandleMailMarkAsRead(WorldPacket& recv_data);
@@ -696,6 +747,10 @@ class WorldSession
         void HandleMoverRelocation(MovementInfo& movementInfo);
 
         void ExecuteOpcode(OpcodeHandler const& opHandle, WorldPacket& packet);
+        bool PrepareSend(WorldPacket const& packet, bool forcedSend) const;
+        bool NextPacket(std::unique_ptr<WorldPacket>& packet);
+        bool CoalescePacket(WorldPacket const& packet) const;
+        void SendCoalescedPackets();
 
         // logging helper
         void LogUnexpectedOpcode(WorldPacket const& packet, const char* reason) const;
@@ -728,8 +783,39 @@ class WorldSession
         std::set<ObjectGuid> m_offlineNameQueries; // for name queires made when not logged in (character selection screen)
         std::deque<CharacterNameQueryResponse> m_offlineNameResponses; // for responses to name queries made when not logged in
 
-        std::mutex m_recvQueueLock;
-        std::deque<std::unique_ptr<WorldPacket>> m_recvQueue;
+        std::mutex m_recvQueueLock;                         // held by the session update, packet producers never take it
+        SpscQueue<std::unique_ptr<WorldPacket>> m_recvQueue;
+        std::mutex m_recvPushLock;                          // serializes the producers, besides the socket playerbots and the load test queue packets
+        std::deque<std::unique_ptr<WorldPacket>> m_recvOverflow; // used while the ring is full, until the update drained it
+        std::atomic<bool> m_hasRecvOverflow;
+
+        uint32 m_heartbeatRelayTime;                        // last MSG_MOVE_HEARTBEAT relayed on an overloaded map
+        uint32 m_farHeartbeatRelayTime;                     // last MSG_MOVE_HEARTBEAT relayed to the far interest band
+
+        bool m_headless;
+        mutable std::atomic<uint64> m_sentPacketCount;
+        mutable std::atomic<uint64> m_sentPacketBytes;
+
+        // latest movement per object held back while the socket is congested
+        mutable std::mutex m_coalesceLock;
+        mutable std::map<ObjectGuid, WorldPacket> m_coalescedPackets;
+        mutable std::atomic<bool> m_hasCoalesced;
+
+        std::shared_ptr<SqlResultQueue> m_queryResultQueue;
+};
+
+// Packet sent unchanged to several sessions. Large payloads are copied once into a shared packet
+// on the first send and referenced by every receiving socket, small ones are copied per receiver.
+class BroadcastPacket
+{
+    public:
+        explicit BroadcastPacket(WorldPacket const& packet) : m_packet(packet) {}
+
+        void SendTo(WorldSession& session);
+
+    private:
+        WorldPacket const& m_packet;
+        SharedWorldPacket m_shared;
 };
 #endif
 /// @}
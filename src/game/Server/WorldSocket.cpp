@@ -29,12 +29,14 @@
 #include "Database/DatabaseEnv.h"
 #include "Auth/Sha1.h"
 #include "Server/WorldSession.h"
+#include "Server/PacketPool.h"
 #include "Log.h"
 #include "Server/DBCStores.h"
 
 #include <chrono>
 #include <functional>
 #include <memory>
+#include <cstring>
 
 #include <boost/asio.hpp>
 #include <utility>
@@ -60,11 +62,8 @@ WorldSocket::WorldSocket(boost::asio::io_service& service, std::function<void (S
 {
 }
 
-void WorldSocket::SendPacket(const WorldPacket& pct, bool immediate)
+void WorldSocket::PrepareHeader(const WorldPacket& pct, char* buffer)
 {
-    if (IsClosed())
-        return;
-
     // Dump outgoing packet.
     sLog.outWorldPacketDump(GetRemoteEndpoint().c_str(), pct.GetOpcode(), pct.GetOpcodeName(), pct, false);
 
@@ -78,15 +77,44 @@ void WorldSocket::SendPacket(const WorldPacket& pct, bool immediate)
 
     m_crypt.EncryptSend(reinterpret_cast<uint8*>(&header), sizeof(header));
 
+    memcpy(buffer, &header, sizeof(header));
+}
+
+void WorldSocket::SendPacket(const WorldPacket& pct, bool immediate)
+{
+    if (IsClosed())
+        return;
+
+    char header[sizeof(ServerPktHeader)];
+    PrepareHeader(pct, header);
+
     if (pct.size() > 0)
-        Write(reinterpret_cast<const char*>(&header), sizeof(header), reinterpret_cast<const char*>(pct.contents()), pct.size());
+        Write(header, sizeof(header), reinterpret_cast<const char*>(pct.contents()), pct.size());
     else
-        Write(reinterpret_cast<const char*>(&header), sizeof(header));
+        Write(header, sizeof(header));
 
     if (immediate)
         ForceFlushOut();
 }
 
+void WorldSocket::SendPacket(SharedWorldPacket const& pct)
+{
+    if (pct->size() < SharedPayloadMinSize)
+    {
+        SendPacket(*pct);
+        return;
+    }
+
+    if (IsClosed())
+        return;
+
+    char header[sizeof(ServerPktHeader)];
+    PrepareHeader(*pct, header);
+
+    // the socket keeps the packet alive until its payload is sent
+    Write(header, sizeof(header), std::shared_ptr<uint8 const>(pct, pct->contents()), pct->size());
+}
+
 bool WorldSocket::Open()
 {
     if (!Socket::Open())
@@ -168,7 +196,7 @@ bool WorldSocket::ProcessIncomingData()
     if (IsClosed())
         return false;
 
-    std::unique_ptr<WorldPacket> pct(new WorldPacket(opcode, validBytesRemaining));
+    std::unique_ptr<WorldPacket> pct = sPacketPool.Acquire(opcode, validBytesRemaining);
 
     if (validBytesRemaining)
     {
@@ -32,10 +32,14 @@
 
 #include <chrono>
 #include <functional>
+#include <memory>
 
 class WorldPacket;
 class WorldSession;
 
+/// Packet sent unchanged to many sessions, stored once and referenced by the out queue of every receiving socket
+typedef std::shared_ptr<WorldPacket const> SharedWorldPacket;
+
 /**
  * WorldSocket.
  *
@@ -120,11 +124,18 @@ class WorldSocket : public MaNGOS::Socket
         /// Called by ProcessIncoming() on CMSG_PING.
         bool HandlePing(WorldPacket& recvPacket);
 
+        /// Dump the packet and write its encrypted header to buffer.
+        void PrepareHeader(const WorldPacket& pct, char* buffer);
+
     public:
         WorldSocket(boost::asio::io_service& service, std::function<void (Socket*)> closeHandler);
 
+        /// Shared payloads smaller than this are copied, a reference costs more than copying them.
+        static const size_t SharedPayloadMinSize = 256;
+
         // send a packet \o/
         void SendPacket(const WorldPacket& pct, bool immediate = false);
+        void SendPacket(SharedWorldPacket const& pct);
 
         void FinalizeSession() { m_session = nullptr; }
 
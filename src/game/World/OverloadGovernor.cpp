@@ -0,0 +1,70 @@
+/*
+* This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#include "World/OverloadGovernor.h"
+
+OverloadConfig OverloadGovernor::s_config;
+
+bool OverloadGovernor::Update(uint32 updateTime, uint32 diff)
+{
+    OverloadStage const oldStage = m_stage;
+    OverloadStage stage = oldStage;
+
+    if (!s_config.enabled)
+    {
+        stage = OVERLOAD_STAGE_NONE;
+        m_overTime = m_underTime = 0;
+    }
+    else if (updateTime > s_config.tickBudget)
+    {
+        m_underTime = 0;
+        m_overTime += diff;
+        if (m_overTime >= s_config.raiseDelay && stage < MAX_OVERLOAD_STAGE)
+        {
+            stage = OverloadStage(stage + 1);
+            m_overTime = 0;
+        }
+    }
+    else if (updateTime * 4 < s_config.tickBudget * 3)
+    {
+        m_overTime = 0;
+        m_underTime += diff;
+        if (m_underTime >= s_config.recoverDelay && stage > OVERLOAD_STAGE_NONE)
+        {
+            stage = OverloadStage(stage - 1);
+            m_underTime = 0;
+        }
+    }
+
+    m_stage = stage;
+    return stage != oldStage;
+}
+
+char const* OverloadGovernor::GetStageName(OverloadStage stage)
+{
+    switch (stage)
+    {
+        case OVERLOAD_STAGE_NONE:       return "none";
+        case OVERLOAD_STAGE_VISIBILITY: return "visibility";
+        case OVERLOAD_STAGE_IDLE_AI:    return "idle AI";
+        case OVERLOAD_STAGE_HEARTBEAT:  return "heartbeat";
+        case OVERLOAD_STAGE_DEFER:      return "defer";
+    }
+
+    return "unknown";
+}
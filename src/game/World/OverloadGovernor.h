@@ -0,0 +1,88 @@
+/*
+* This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#ifndef OVERLOAD_GOVERNOR_H
+#define OVERLOAD_GOVERNOR_H
+
+#include "Common.h"
+
+#include <atomic>
+
+// Stages are entered in order, each one keeps the degradations of the previous ones
+enum OverloadStage
+{
+    OVERLOAD_STAGE_NONE         = 0,
+    OVERLOAD_STAGE_VISIBILITY   = 1,                        // visibility distance reduced
+    OVERLOAD_STAGE_IDLE_AI      = 2,                        // AI of creatures out of combat updated less often
+    OVERLOAD_STAGE_HEARTBEAT    = 3,                        // movement heartbeats relayed less often
+    OVERLOAD_STAGE_DEFER        = 4,                        // mass mails, AHBot and corpse cleanup postponed
+};
+
+#define MAX_OVERLOAD_STAGE OVERLOAD_STAGE_DEFER
+
+struct OverloadConfig
+{
+    OverloadConfig() : enabled(false), tickBudget(50), raiseDelay(5000), recoverDelay(30000),
+        visibilityPct(60), idleAIInterval(1000), heartbeatInterval(1000) {}
+
+    bool enabled;
+    uint32 tickBudget;                                      // ms, updates above are overloaded
+    uint32 raiseDelay;                                      // ms of continuous overload before the next stage
+    uint32 recoverDelay;                                    // ms below 3/4 of the budget before the previous stage
+    uint32 visibilityPct;
+    uint32 idleAIInterval;                                  // ms
+    uint32 heartbeatInterval;                               // ms
+};
+
+/**
+ * Watches the update time of one map and steps its degradation stage up under sustained overload
+ * and back down once the load dropped (Overload.* settings).
+ *
+ * Update() is called once per map update with the time the update took. The time over budget and the
+ * time well below budget are accumulated in game time, so a map ticking slowly does not react slower.
+ * Updates between 3/4 of the budget and the budget keep the current stage and both counters.
+ * Only the map update changes the stage, sessions and commands read it from other threads.
+ */
+class OverloadGovernor
+{
+    public:
+        OverloadGovernor() : m_stage(OVERLOAD_STAGE_NONE), m_overTime(0), m_underTime(0) {}
+
+        // returns true when the stage changed
+        bool Update(uint32 updateTime, uint32 diff);
+
+        OverloadStage GetStage() const { return m_stage; }
+        bool IsActive(OverloadStage stage) const { return m_stage >= stage; }
+
+        float GetVisibilityFactor() const { return IsActive(OVERLOAD_STAGE_VISIBILITY) ? s_config.visibilityPct / 100.0f : 1.0f; }
+        uint32 GetIdleAIInterval() const { return IsActive(OVERLOAD_STAGE_IDLE_AI) ? s_config.idleAIInterval : 0; }
+        uint32 GetHeartbeatInterval() const { return IsActive(OVERLOAD_STAGE_HEARTBEAT) ? s_config.heartbeatInterval : 0; }
+
+        static void SetConfig(OverloadConfig const& config) { s_config = config; }
+        static OverloadConfig const& GetConfig() { return s_config; }
+        static char const* GetStageName(OverloadStage stage);
+
+    private:
+        std::atomic<OverloadStage> m_stage;
+        uint32 m_overTime;
+        uint32 m_underTime;
+
+        static OverloadConfig s_config;
+};
+
+#endif
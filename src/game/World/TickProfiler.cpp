@@ -0,0 +1,164 @@
+/*
+* This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#include "World/TickProfiler.h"
+
+#include <algorithm>
+#include <cstring>
+
+bool TickProfiler::s_enabled = true;
+uint32 TickProfiler::s_window = 60;
+
+void TickHistogram::Reset()
+{
+    memset(m_buckets, 0, sizeof(m_buckets));
+    m_count = 0;
+    m_max = 0;
+}
+
+void TickHistogram::Add(uint32 us)
+{
+    ++m_buckets[GetBucket(us)];
+    ++m_count;
+    m_max = std::max(m_max, us);
+}
+
+void TickHistogram::Merge(TickHistogram const& other)
+{
+    for (uint32 i = 0; i < BUCKET_COUNT; ++i)
+        m_buckets[i] += other.m_buckets[i];
+
+    m_count += other.m_count;
+    m_max = std::max(m_max, other.m_max);
+}
+
+uint32 TickHistogram::GetPercentile(float pct) const
+{
+    if (!m_count)
+        return 0;
+
+    uint64 target = std::max(uint64(1), uint64(m_count * pct / 100.0f + 0.5f));
+    uint64 seen = 0;
+    for (uint32 i = 0; i < BUCKET_COUNT; ++i)
+    {
+        seen += m_buckets[i];
+        if (seen >= target)
+            return std::min(GetBucketLimit(i), m_max);
+    }
+
+    return m_max;
+}
+
+uint32 TickHistogram::GetBucket(uint32 us)
+{
+    if (us < 16)
+        return us;
+
+    uint32 exp = 4;
+    while (exp < 31 && (us >> (exp + 1)))
+        ++exp;
+
+    return 16 + (exp - 4) * 4 + ((us >> (exp - 2)) & 3);
+}
+
+uint32 TickHistogram::GetBucketLimit(uint32 bucket)
+{
+    if (bucket < 16)
+        return bucket;
+
+    uint32 exp = (bucket - 16) / 4 + 4;
+    uint64 low = uint64(4 + (bucket - 16) % 4) << (exp - 2);
+    return uint32(low + (uint64(1) << (exp - 2)) - 1);
+}
+
+TickProfiler::TickProfiler(char const* const* phaseNames, uint32 phaseCount) :
+    m_phaseNames(phaseNames), m_phaseCount(phaseCount), m_active(false),
+    m_tickTimes(phaseCount, 0), m_marked(phaseCount, false),
+    m_windowStart(Clock::now()), m_current(phaseCount + 1), m_previous(phaseCount + 1)
+{
+}
+
+void TickProfiler::StartTick()
+{
+    m_active = s_enabled;
+    if (!m_active)
+        return;
+
+    m_tickStart = m_lastMark = Clock::now();
+}
+
+void TickProfiler::Mark(uint32 phase)
+{
+    if (!m_active)
+        return;
+
+    Clock::time_point now = Clock::now();
+    m_tickTimes[phase] += uint32(std::chrono::duration_cast<std::chrono::microseconds>(now - m_lastMark).count());
+    m_marked[phase] = true;
+    m_lastMark = now;
+}
+
+void TickProfiler::EndTick()
+{
+    if (!m_active)
+        return;
+
+    m_active = false;
+
+    Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> guard(m_windowLock);
+    if (now - m_windowStart >= std::chrono::seconds(s_window))
+    {
+        m_previous.swap(m_current);
+        for (auto& histogram : m_current)
+            histogram.Reset();
+
+        m_windowStart = now;
+    }
+
+    for (uint32 i = 0; i < m_phaseCount; ++i)
+    {
+        if (!m_marked[i])
+            continue;
+
+        m_current[i].Add(m_tickTimes[i]);
+        m_tickTimes[i] = 0;
+        m_marked[i] = false;
+    }
+
+    m_current[m_phaseCount].Add(uint32(std::chrono::duration_cast<std::chrono::microseconds>(now - m_tickStart).count()));
+}
+
+TickHistogram TickProfiler::GetHistogram(uint32 phase) const
+{
+    std::lock_guard<std::mutex> guard(m_windowLock);
+    TickHistogram histogram = m_current[phase];
+    histogram.Merge(m_previous[phase]);
+    return histogram;
+}
+
+std::string TickProfiler::FormatPhase(uint32 phase) const
+{
+    TickHistogram histogram = GetHistogram(phase);
+
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%-16s p50 %8.2fms  p95 %8.2fms  p99 %8.2fms  max %8.2fms  (%u samples)", GetPhaseName(phase),
+        histogram.GetPercentile(50.0f) / 1000.0f, histogram.GetPercentile(95.0f) / 1000.0f,
+        histogram.GetPercentile(99.0f) / 1000.0f, histogram.GetMax() / 1000.0f, histogram.GetCount());
+    return buf;
+}
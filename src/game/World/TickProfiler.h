@@ -0,0 +1,103 @@
+/*
+* This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+
+#ifndef TICK_PROFILER_H
+#define TICK_PROFILER_H
+
+#include "Common.h"
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Durations in microseconds, log2 buckets split into 4 linear sub buckets (~25% resolution)
+class TickHistogram
+{
+    public:
+        static const uint32 BUCKET_COUNT = 128;
+
+        TickHistogram() { Reset(); }
+
+        void Reset();
+        void Add(uint32 us);
+        void Merge(TickHistogram const& other);
+
+        uint32 GetCount() const { return m_count; }
+        uint32 GetMax() const { return m_max; }
+        // upper limit of the bucket holding the given percentile
+        uint32 GetPercentile(float pct) const;
+
+    private:
+        static uint32 GetBucket(uint32 us);
+        static uint32 GetBucketLimit(uint32 bucket);
+
+        uint32 m_buckets[BUCKET_COUNT];
+        uint32 m_count;
+        uint32 m_max;
+};
+
+/**
+ * Per phase timing of one update loop (World::Update, Map::Update).
+ *
+ * StartTick() starts the clock, every Mark(phase) accounts the time since the previous mark to that phase,
+ * EndTick() records the marked phases and the whole tick. Phases not marked in a tick are not recorded, so
+ * periodic work (auctions, game events, ...) is not hidden behind ticks where it did not run.
+ * Two windows of TickProfiler.Window seconds are kept, percentiles cover the current and the previous one.
+ * The windows are only written at EndTick() under a lock, so other threads read whole ticks from them.
+ */
+class TickProfiler
+{
+    public:
+        typedef std::chrono::steady_clock Clock;
+
+        TickProfiler(char const* const* phaseNames, uint32 phaseCount);
+
+        void StartTick();
+        void Mark(uint32 phase);
+        void EndTick();
+
+        // phase index GetPhaseCount() is the whole tick
+        uint32 GetPhaseCount() const { return m_phaseCount; }
+        char const* GetPhaseName(uint32 phase) const { return phase < m_phaseCount ? m_phaseNames[phase] : "total"; }
+        TickHistogram GetHistogram(uint32 phase) const;
+        std::string FormatPhase(uint32 phase) const;
+
+        static void SetEnabled(bool enabled) { s_enabled = enabled; }
+        static bool IsEnabled() { return s_enabled; }
+        static void SetWindow(uint32 seconds) { s_window = seconds; }
+
+    private:
+        char const* const* m_phaseNames;
+        uint32 m_phaseCount;
+
+        bool m_active;                                      // enabled at StartTick
+        Clock::time_point m_tickStart;
+        Clock::time_point m_lastMark;
+        std::vector<uint32> m_tickTimes;                    // accumulated per phase in the running tick
+        std::vector<bool> m_marked;
+
+        mutable std::mutex m_windowLock;                    // guards the windows, read by commands and the tick stats
+        Clock::time_point m_windowStart;
+        std::vector<TickHistogram> m_current;               // phases + total
+        std::vector<TickHistogram> m_previous;
+
+        static bool s_enabled;
+        static uint32 s_window;
+};
+
+#endif
@@ -44,6 +44,7 @@
 #include "Loot/LootMgr.h"
 #include "Entities/ItemEnchantmentMgr.h"
 #include "Maps/MapManager.h"
+#include "Maps/GridPreloader.h"
 #include "DBScripts/ScriptMgr.h"
 #include "AI/CreatureAIRegistry.h"
 #include "Policies/Singleton.h"
@@ -91,8 +92,23 @@ uint32 World::m_currentMSTime = 0;
 TimePoint World::m_currentTime = TimePoint();
 uint32 World::m_currentDiff = 0;
 
+static char const* WorldUpdatePhaseNames[WORLD_PHASE_COUNT] =
+{
+    "timers",
+    "auctions",
+    "ahbot",
+    "sessions",
+    "maps",
+    "battlegrounds",
+    "result queue",
+    "corpses",
+    "game events",
+    "remove list",
+    "other",
+};
+
 /// World constructor
-World::World(): mail_timer(0), mail_timer_expires(0), m_NextWeeklyQuestReset(0)
+World::World(): mail_timer(0), mail_timer_expires(0), m_tickProfiler(WorldUpdatePhaseNames, WORLD_PHASE_COUNT), m_NextWeeklyQuestReset(0)
 {
     m_playerLimit = 0;
     m_allowMovement = true;
@@ -145,6 +161,7 @@ void World::CleanupsBeforeStop()
     KickAll();                                       // save and kick all players
     UpdateSessions(1);                               // real players unload required UpdateSessions call
     sBattleGroundMgr.DeleteAllBattleGrounds();       // unload battleground templates before different singletons destroyed
+    sGridPreloader.Stop();                           // release preloaded terrain before the maps drop theirs
     sMapMgr.UnloadAll();                             // unload all grids (including locked in memory)
 }
 
@@ -439,6 +456,7 @@ void World::LoadConfigSettings(bool reload)
 
     ///- Read other configuration items from the config file
     setConfigMinMax(CONFIG_UINT32_COMPRESSION, "Compression", 1, 1, 9);
+    setConfig(CONFIG_UINT32_COMPRESSION_THRESHOLD, "Compression.Threshold", 100);
     setConfig(CONFIG_BOOL_ADDON_CHANNEL, "AddonChannel", true);
     setConfig(CONFIG_BOOL_CLEAN_CHARACTER_DB, "CleanCharacterDB", true);
     setConfig(CONFIG_BOOL_GRID_UNLOAD, "GridUnload", true);
@@ -574,7 +592,50 @@ void World::LoadConfigSettings(bool reload)
         m_timers[WUPDATE_UPTIME].Reset();
     }
 
+    setConfig(CONFIG_BOOL_TICK_PROFILER, "TickProfiler.Enable", true);
+    setConfigMin(CONFIG_UINT32_TICK_PROFILER_WINDOW, "TickProfiler.Window", 60, 1);
+    setConfig(CONFIG_UINT32_TICK_STATS_INTERVAL, "TickProfiler.StatsInterval", 60);
+    TickProfiler::SetEnabled(getConfig(CONFIG_BOOL_TICK_PROFILER));
+    TickProfiler::SetWindow(getConfig(CONFIG_UINT32_TICK_PROFILER_WINDOW));
+    if (reload)
+    {
+        m_timers[WUPDATE_TICK_STATS].SetInterval(getConfig(CONFIG_UINT32_TICK_STATS_INTERVAL) * IN_MILLISECONDS);
+        m_timers[WUPDATE_TICK_STATS].Reset();
+    }
+
+    setConfig(CONFIG_BOOL_OVERLOAD_GOVERNOR, "Overload.Enable", false);
+    setConfigMin(CONFIG_UINT32_OVERLOAD_TICK_BUDGET, "Overload.TickBudget", 50, 1);
+    setConfig(CONFIG_UINT32_OVERLOAD_RAISE_DELAY, "Overload.RaiseDelay", 5000);
+    setConfig(CONFIG_UINT32_OVERLOAD_RECOVER_DELAY, "Overload.RecoverDelay", 30000);
+    setConfigMinMax(CONFIG_UINT32_OVERLOAD_VISIBILITY_PCT, "Overload.VisibilityPct", 60, 10, 100);
+    setConfig(CONFIG_UINT32_OVERLOAD_IDLE_AI_INTERVAL, "Overload.IdleAIInterval", 1000);
+    setConfig(CONFIG_UINT32_OVERLOAD_HEARTBEAT_INTERVAL, "Overload.HeartbeatInterval", 1000);
+    {
+        OverloadConfig overloadConfig;
+        overloadConfig.enabled = getConfig(CONFIG_BOOL_OVERLOAD_GOVERNOR);
+        overloadConfig.tickBudget = getConfig(CONFIG_UINT32_OVERLOAD_TICK_BUDGET);
+        overloadConfig.raiseDelay = getConfig(CONFIG_UINT32_OVERLOAD_RAISE_DELAY);
+        overloadConfig.recoverDelay = getConfig(CONFIG_UINT32_OVERLOAD_RECOVER_DELAY);
+        overloadConfig.visibilityPct = getConfig(CONFIG_UINT32_OVERLOAD_VISIBILITY_PCT);
+        overloadConfig.idleAIInterval = getConfig(CONFIG_UINT32_OVERLOAD_IDLE_AI_INTERVAL);
+        overloadConfig.heartbeatInterval = getConfig(CONFIG_UINT32_OVERLOAD_HEARTBEAT_INTERVAL);
+        OverloadGovernor::SetConfig(overloadConfig);
+    }
+
+    setConfigPos(CONFIG_FLOAT_INTEREST_FAR_DISTANCE_CONTINENTS, "Interest.FarDistance.Continents", 0.0f);
+    setConfigPos(CONFIG_FLOAT_INTEREST_FAR_DISTANCE_INSTANCES, "Interest.FarDistance.Instances", 0.0f);
+    setConfigPos(CONFIG_FLOAT_INTEREST_FAR_DISTANCE_BGARENAS, "Interest.FarDistance.BGArenas", 0.0f);
+    setConfigMin(CONFIG_UINT32_INTEREST_FAR_INTERVAL, "Interest.FarInterval", 1000, 100);
+
     setConfig(CONFIG_UINT32_NUM_MAP_THREADS, "MapUpdate.Threads", 3);
+    setConfig(CONFIG_BOOL_MAP_PARALLEL_CONTINENTS, "MapUpdate.Parallel.Continents", false);
+    if (getConfig(CONFIG_BOOL_MAP_PARALLEL_CONTINENTS))
+        sLog.outError("MapUpdate.Parallel.Continents is experimental, global state reached from scripts is not synchronized between partitions");
+    setConfigMinMax(CONFIG_UINT32_MAP_PARTITION_GAP, "MapUpdate.Parallel.PartitionGap", 3, 1, MAX_NUMBER_OF_CELLS);
+    setConfig(CONFIG_UINT32_MAP_IDLE_UPDATE_INTERVAL, "MapUpdate.IdleInterval", 0);
+    setConfig(CONFIG_UINT32_GRID_PRELOAD_THREADS, "GridPreload.Threads", 0);
+    setConfig(CONFIG_UINT32_GRID_PRELOAD_LOOKAHEAD, "GridPreload.Lookahead", 10000);
+    setConfigMin(CONFIG_UINT32_GRID_PRELOAD_HOLD_TIME, "GridPreload.HoldTime", 60000, 1000);
     setConfig(CONFIG_UINT32_SKILL_CHANCE_ORANGE, "SkillChance.Orange", 100);
     setConfig(CONFIG_UINT32_SKILL_CHANCE_YELLOW, "SkillChance.Yellow", 75);
     setConfig(CONFIG_UINT32_SKILL_CHANCE_GREEN,  "SkillChance.Green",  25);
@@ -1251,6 +1312,9 @@ void World::SetInitialWorldSettings()
     // Update groups with offline leader after delay in seconds
     m_timers[WUPDATE_GROUPS].SetInterval(IN_MILLISECONDS);
 
+    // tick profiler stats file, disabled with interval 0
+    m_timers[WUPDATE_TICK_STATS].SetInterval(getConfig(CONFIG_UINT32_TICK_STATS_INTERVAL) * IN_MILLISECONDS);
+
     // to set mailtimer to return mails every day between 4 and 5 am
     // mailtimer is increased when updating auctions
     // one second is 1000 -(tested on win system)
@@ -1270,6 +1334,7 @@ void World::SetInitialWorldSettings()
     ///- Initialize MapManager
     sLog.outString("Starting Map System");
     sMapMgr.Initialize();
+    sGridPreloader.Start(getConfig(CONFIG_UINT32_GRID_PRELOAD_THREADS), getConfig(CONFIG_UINT32_GRID_PRELOAD_HOLD_TIME));
     sLog.outString();
 
     ///- Initialize Battlegrounds
@@ -1378,8 +1443,11 @@ void World::Update(uint32 diff)
 {
     m_currentMSTime = WorldTimer::getMSTime();
     m_currentTime = std::chrono::time_point_cast<std::chrono::milliseconds>(Clock::now());
+
     m_currentDiff = diff;
 
+    m_tickProfiler.StartTick();
+
     ///- Update the different timers
     for (auto& m_timer : m_timers)
     {
@@ -1392,13 +1460,19 @@ void World::Update(uint32 diff)
     ///- Update the game time and check for shutdown time
     _UpdateGameTime();
 
+    ///- Non urgent work is postponed while a map is overloaded
+    bool const deferWork = sMapMgr.GetOverloadStage() >= OVERLOAD_STAGE_DEFER;
+
     ///-Update mass mailer tasks if any
-    sMassMailMgr.Update();
+    if (!deferWork)
+        sMassMailMgr.Update();
 
     /// Handle weekly quests reset time
     if (m_gameTime > m_NextWeeklyQuestReset)
         ResetWeeklyQuests();
 
+    m_tickProfiler.Mark(WORLD_PHASE_TIMERS);
+
     /// <ul><li> Handle auctions when the timer has passed
     if (m_timers[WUPDATE_AUCTIONS].Passed())
     {
@@ -1414,17 +1488,20 @@ void World::Update(uint32 diff)
 
         ///- Handle expired auctions
         sAuctionMgr.Update();
+        m_tickProfiler.Mark(WORLD_PHASE_AUCTIONS);
     }
 
     /// <li> Handle AHBot operations
-    if (m_timers[WUPDATE_AHBOT].Passed())
+    if (m_timers[WUPDATE_AHBOT].Passed() && !deferWork)
     {
         sAuctionBot.Update();
         m_timers[WUPDATE_AHBOT].Reset();
+        m_tickProfiler.Mark(WORLD_PHASE_AHBOT);
     }
 
     /// <li> Handle session updates
     UpdateSessions(diff);
+    m_tickProfiler.Mark(WORLD_PHASE_SESSIONS);
 
     /// <li> Update uptime table
     if (m_timers[WUPDATE_UPTIME].Passed())
@@ -1434,14 +1511,17 @@ void World::Update(uint32 diff)
 
         m_timers[WUPDATE_UPTIME].Reset();
         LoginDatabase.PExecute("UPDATE uptime SET uptime = %u, maxplayers = %u WHERE realmid = %u AND starttime = " UI64FMTD, tmpDiff, maxClientsNum, realmID, uint64(m_startTime));
+        m_tickProfiler.Mark(WORLD_PHASE_OTHER);
     }
 
     /// <li> Handle all other objects
     ///- Update objects (maps, transport, creatures,...)
     sMapMgr.Update(diff);
+    m_tickProfiler.Mark(WORLD_PHASE_MAPS);
     sBattleGroundMgr.Update(diff);
     sOutdoorPvPMgr.Update(diff);
     sWorldState.Update(diff);
+    m_tickProfiler.Mark(WORLD_PHASE_BATTLEGROUNDS);
 
     ///- Update groups with offline leaders
     if (m_timers[WUPDATE_GROUPS].Passed())
@@ -1461,15 +1541,19 @@ void World::Update(uint32 diff)
         Player::DeleteOldCharacters();
     }
 
+    m_tickProfiler.Mark(WORLD_PHASE_OTHER);
+
     // execute callbacks from sql queries that were queued recently
     UpdateResultQueue();
+    m_tickProfiler.Mark(WORLD_PHASE_RESULT_QUEUE);
 
     ///- Erase corpses once every 20 minutes
-    if (m_timers[WUPDATE_CORPSES].Passed())
+    if (m_timers[WUPDATE_CORPSES].Passed() && !deferWork)
     {
         m_timers[WUPDATE_CORPSES].Reset();
 
         sObjectAccessor.RemoveOldCorpses();
+        m_tickProfiler.Mark(WORLD_PHASE_CORPSES);
     }
 
     ///- Process Game events when necessary
@@ -1479,11 +1563,13 @@ void World::Update(uint32 diff)
         uint32 nextGameEvent = sGameEventMgr.Update();
         m_timers[WUPDATE_EVENTS].SetInterval(nextGameEvent);
         m_timers[WUPDATE_EVENTS].Reset();
+        m_tickProfiler.Mark(WORLD_PHASE_GAME_EVENTS);
     }
 
     /// </ul>
     ///- Move all creatures with "delayed move" and remove and delete all objects with "delayed remove"
     sMapMgr.RemoveAllObjectsInRemoveList();
+    m_tickProfiler.Mark(WORLD_PHASE_REMOVE_LIST);
 
     // update the instance reset times
     sMapPersistentStateMgr.Update();
@@ -1504,7 +1590,22 @@ void World::Update(uint32 diff)
     ProcessCliCommands();
 
     // cleanup unused GridMap objects as well as VMaps
+    sGridPreloader.Update();
     sTerrainMgr.Update(diff);
+    m_tickProfiler.Mark(WORLD_PHASE_OTHER);
+
+    ///- Periodically dump the tick profiles of the world and all maps
+    if (m_timers[WUPDATE_TICK_STATS].Passed())
+    {
+        m_timers[WUPDATE_TICK_STATS].Reset();
+        if (getConfig(CONFIG_UINT32_TICK_STATS_INTERVAL))
+            LogTickStats();
+    }
+
+    ///- Send what the tick buffered for the clients
+    MaNGOS::Socket::FlushDirty();
+
+    m_tickProfiler.EndTick();
 }
 
 namespace MaNGOS
@@ -1620,13 +1721,14 @@ void World::SendWorldTextToAcceptingTickets(int32 string_id, ...)
 /// Sends a packet to all players with optional team and instance restrictions
 void World::SendGlobalMessage(WorldPacket const& packet) const
 {
+    BroadcastPacket broadcast(packet);
     for (const auto& m_session : m_sessions)
     {
         if (WorldSession* session = m_session.second)
         {
             Player* player = session->GetPlayer();
             if (player && player->IsInWorld())
-                session->SendPacket(packet);
+                broadcast.SendTo(*session);
         }
     }
 }
@@ -1964,6 +2066,54 @@ void World::UpdateSessions(uint32 /*diff*/)
     }
 }
 
+/// Queue depth and latency of the async workers of a database
+static void LogAsyncDatabaseStats(char const* name, DatabaseType& database)
+{
+    std::vector<SqlDelayStats> stats;
+    database.TakeAsyncStats(stats);
+    for (size_t i = 0; i < stats.size(); ++i)
+        sLog.outTickStats("%s database worker " SIZEFMTD ": queue %u, " UI64FMTD " executed, " UI64FMTD " group commits, latency avg %u us max %u us",
+                          name, i, stats[i].queued, stats[i].executed, stats[i].groupCommits, stats[i].averageLatency, stats[i].maxLatency);
+
+    uint64 count;
+    uint32 latency, latencyMax;
+    database.TakeResultStats(count, latency, latencyMax);
+    sLog.outTickStats("%s database results: " UI64FMTD " delivered, latency avg %u us max %u us", name, count, latency, latencyMax);
+}
+
+/// Write the tick profiles of the world and all loaded maps to the tick stats log
+void World::LogTickStats() const
+{
+    sLog.outTickStats("World (%u sessions)", GetActiveSessionCount());
+    for (uint32 i = 0; i <= m_tickProfiler.GetPhaseCount(); ++i)
+        sLog.outTickStats("    %s", m_tickProfiler.FormatPhase(i).c_str());
+
+    uint64 flushCount;
+    uint32 flushDelay, flushDelayMax;
+    MaNGOS::Socket::TakeFlushStats(flushCount, flushDelay, flushDelayMax);
+    sLog.outTickStats("Network: " UI64FMTD " flushes, delay avg %u us max %u us", flushCount, flushDelay, flushDelayMax);
+
+    // LogTickStats runs on the world thread, so these are the sync queries the world tick waited for
+    uint64 syncCount, syncTime;
+    uint32 syncTimeMax;
+    Database::TakeSyncQueryStats(syncCount, syncTime, syncTimeMax);
+    sLog.outTickStats("World thread: " UI64FMTD " sync queries, blocked " UI64FMTD " us, max %u us", syncCount, syncTime, syncTimeMax);
+
+    LogAsyncDatabaseStats("Character", CharacterDatabase);
+    LogAsyncDatabaseStats("World", WorldDatabase);
+    LogAsyncDatabaseStats("Login", LoginDatabase);
+
+    for (auto const& itr : sMapMgr.Maps())
+    {
+        Map const* map = itr.second;
+        TickProfiler const& profiler = map->GetTickProfiler();
+
+        sLog.outTickStats("Map %u (instance %u, %u players)", map->GetId(), map->GetInstanceId(), map->GetPlayers().getSize());
+        for (uint32 i = 0; i <= profiler.GetPhaseCount(); ++i)
+            sLog.outTickStats("    %s", profiler.FormatPhase(i).c_str());
+    }
+}
+
 void World::ServerMaintenanceStart()
 {
     uint32 LastWeekEnd    = GetDateLastMaintenanceDay();
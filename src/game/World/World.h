@@ -27,6 +27,7 @@
 #include "Timer.h"
 #include "Globals/SharedDefines.h"
 #include "Entities/Object.h"
+#include "World/TickProfiler.h"
 
 #include <set>
 #include <list>
@@ -77,13 +78,32 @@ enum WorldTimers
     WUPDATE_DELETECHARS = 4,
     WUPDATE_AHBOT       = 5,
     WUPDATE_GROUPS      = 6,
-    WUPDATE_COUNT       = 7
+    WUPDATE_TICK_STATS  = 7,
+    WUPDATE_COUNT       = 8
+};
+
+// World::Update phases recorded by the world's TickProfiler
+enum WorldUpdatePhase
+{
+    WORLD_PHASE_TIMERS,                                     // timers, game time, mass mailer, weekly quests
+    WORLD_PHASE_AUCTIONS,
+    WORLD_PHASE_AHBOT,
+    WORLD_PHASE_SESSIONS,
+    WORLD_PHASE_MAPS,
+    WORLD_PHASE_BATTLEGROUNDS,                              // battlegrounds, outdoor pvp, world state
+    WORLD_PHASE_RESULT_QUEUE,
+    WORLD_PHASE_CORPSES,
+    WORLD_PHASE_GAME_EVENTS,
+    WORLD_PHASE_REMOVE_LIST,
+    WORLD_PHASE_OTHER,                                      // uptime, groups, character deletion, instance resets, cli, terrain
+    WORLD_PHASE_COUNT
 };
 
 /// Configuration elements
 enum eConfigUInt32Values
 {
     CONFIG_UINT32_COMPRESSION = 0,
+    CONFIG_UINT32_COMPRESSION_THRESHOLD,
     CONFIG_UINT32_INTERVAL_SAVE,
     CONFIG_UINT32_INTERVAL_GRIDCLEAN,
     CONFIG_UINT32_INTERVAL_MAPUPDATE,
@@ -131,6 +151,20 @@ enum eConfigUInt32Values
     CONFIG_UINT32_MASS_MAILER_SEND_PER_TICK,
     CONFIG_UINT32_UPTIME_UPDATE,
     CONFIG_UINT32_NUM_MAP_THREADS,
+    CONFIG_UINT32_MAP_PARTITION_GAP,
+    CONFIG_UINT32_MAP_IDLE_UPDATE_INTERVAL,
+    CONFIG_UINT32_GRID_PRELOAD_THREADS,
+    CONFIG_UINT32_GRID_PRELOAD_LOOKAHEAD,
+    CONFIG_UINT32_GRID_PRELOAD_HOLD_TIME,
+    CONFIG_UINT32_TICK_PROFILER_WINDOW,
+    CONFIG_UINT32_TICK_STATS_INTERVAL,
+    CONFIG_UINT32_OVERLOAD_TICK_BUDGET,
+    CONFIG_UINT32_OVERLOAD_RAISE_DELAY,
+    CONFIG_UINT32_OVERLOAD_RECOVER_DELAY,
+    CONFIG_UINT32_OVERLOAD_VISIBILITY_PCT,
+    CONFIG_UINT32_OVERLOAD_IDLE_AI_INTERVAL,
+    CONFIG_UINT32_OVERLOAD_HEARTBEAT_INTERVAL,
+    CONFIG_UINT32_INTEREST_FAR_INTERVAL,
     CONFIG_UINT32_AUCTION_DEPOSIT_MIN,
     CONFIG_UINT32_SKILL_CHANCE_ORANGE,
     CONFIG_UINT32_SKILL_CHANCE_YELLOW,
@@ -266,6 +300,9 @@ enum eConfigFloatValues
     CONFIG_FLOAT_THREAT_RADIUS,
     CONFIG_FLOAT_GHOST_RUN_SPEED_WORLD,
     CONFIG_FLOAT_GHOST_RUN_SPEED_BG,
+    CONFIG_FLOAT_INTEREST_FAR_DISTANCE_CONTINENTS,
+    CONFIG_FLOAT_INTEREST_FAR_DISTANCE_INSTANCES,
+    CONFIG_FLOAT_INTEREST_FAR_DISTANCE_BGARENAS,
     CONFIG_FLOAT_VALUE_COUNT
 };
 
@@ -329,6 +366,9 @@ enum eConfigBoolValues
     CONFIG_BOOL_PLAYER_COMMANDS,
     CONFIG_BOOL_PATH_FIND_OPTIMIZE,
     CONFIG_BOOL_PATH_FIND_NORMALIZE_Z,
+    CONFIG_BOOL_MAP_PARALLEL_CONTINENTS,
+    CONFIG_BOOL_TICK_PROFILER,
+    CONFIG_BOOL_OVERLOAD_GOVERNOR,
     CONFIG_BOOL_VALUE_COUNT
 };
 
@@ -503,6 +543,9 @@ class World
 
         void UpdateSessions(uint32 diff);
 
+        TickProfiler const& GetTickProfiler() const { return m_tickProfiler; }
+        void LogTickStats() const;
+
         /// Get a server configuration element (see #eConfigFloatValues)
         void setConfig(eConfigFloatValues index, float value) { m_configFloatValues[index] = value; }
         /// Get a server configuration element (see #eConfigFloatValues)
@@ -622,6 +665,7 @@ class World
         IntervalTimer m_timers[WUPDATE_COUNT];
         uint32 mail_timer;
         uint32 mail_timer_expires;
+        TickProfiler m_tickProfiler;
 
         typedef std::unordered_map<uint32, WorldSession*> SessionMap;
         SessionMap m_sessions;
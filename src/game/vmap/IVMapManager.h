@@ -20,6 +20,7 @@
 #define _IVMAPMANAGER_H
 
 #include <string>
+#include <vector>
 #include <Platform/Define.h>
 
 //===========================================================
@@ -57,6 +58,13 @@ namespace VMAP
 
             virtual bool existsMap(const char* pBasePath, unsigned int pMapId, int x, int y) = 0;
 
+            /**
+            Load and reference the model files of a tile ahead of loadMap, thread safe.
+            Referenced models are returned in models and must be given back to releaseTileModels.
+            */
+            virtual bool preloadTileModels(const char* pBasePath, unsigned int pMapId, int x, int y, std::vector<std::string>& models) = 0;
+            virtual void releaseTileModels(std::vector<std::string> const& models) = 0;
+
             virtual void unloadMap(unsigned int pMapId, int x, int y) = 0;
             virtual void unloadMap(unsigned int pMapId) = 0;
 
@@ -333,6 +333,32 @@ namespace VMAP
 
     //=========================================================
 
+    // names of the models spawned by a tile, basePath must end with a separator
+    bool StaticMapTree::GetTileModelNames(const std::string& basePath, uint32 mapID, uint32 tileX, uint32 tileY, std::vector<std::string>& names)
+    {
+        std::string tilefile = basePath + getTileFileName(mapID, tileX, tileY);
+        FILE* tf = fopen(tilefile.c_str(), "rb");
+        if (!tf)
+            return false;
+
+        char chunk[8];
+        uint32 numSpawns = 0;
+        bool result = readChunk(tf, chunk, VMAP_MAGIC, 8) && fread(&numSpawns, sizeof(uint32), 1, tf) == 1;
+        for (uint32 i = 0; i < numSpawns && result; ++i)
+        {
+            ModelSpawn spawn;
+            uint32 referencedVal;
+            result = ModelSpawn::readFromFile(tf, spawn) && fread(&referencedVal, sizeof(uint32), 1, tf) == 1;
+            if (result)
+                names.push_back(spawn.name);
+        }
+
+        fclose(tf);
+        return result;
+    }
+
+    //=========================================================
+
     bool StaticMapTree::LoadMapTile(uint32 tileX, uint32 tileY, VMapManager2* vm)
     {
         if (!iIsTiled)
@@ -288,6 +288,7 @@ namespace VMAP
 
     void VMapManager2::releaseModelInstance(const std::string& filename)
     {
+        std::lock_guard<std::mutex> lock(m_vmModelMutex);
         ModelFileMap::iterator model = iLoadedModelFiles.find(filename);
         if (model == iLoadedModelFiles.end())
         {
@@ -307,4 +308,33 @@ namespace VMAP
     {
         return StaticMapTree::CanLoadMap(std::string(pBasePath), pMapId, x, y);
     }
+
+    //=========================================================
+
+    bool VMapManager2::preloadTileModels(const char* pBasePath, unsigned int pMapId, int x, int y, std::vector<std::string>& models)
+    {
+        if (!isMapLoadingEnabled())
+            return false;
+
+        std::string basePath = pBasePath;
+        if (basePath.length() > 0 && (basePath[basePath.length() - 1] != '/' && basePath[basePath.length() - 1] != '\\'))
+            basePath.append("/");
+
+        std::vector<std::string> names;
+        if (!StaticMapTree::GetTileModelNames(basePath, pMapId, x, y, names))
+            return false;
+
+        // the model files are the expensive part of a tile, once referenced here LoadMapTile only links them
+        for (auto& name : names)
+            if (acquireModelInstance(basePath, name))
+                models.push_back(name);
+
+        return true;
+    }
+
+    void VMapManager2::releaseTileModels(std::vector<std::string> const& models)
+    {
+        for (auto& name : models)
+            releaseModelInstance(name);
+    }
 } // namespace VMAP
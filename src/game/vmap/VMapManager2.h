@@ -113,6 +113,9 @@ namespace VMAP
             }
             bool existsMap(const char* pBasePath, unsigned int pMapId, int x, int y) override;
 
+            bool preloadTileModels(const char* pBasePath, unsigned int pMapId, int x, int y, std::vector<std::string>& models) override;
+            void releaseTileModels(std::vector<std::string> const& models) override;
+
 #ifdef MMAP_GENERATOR
         public:
             void getInstanceMapTree(InstanceTreeMap& instanceMapTree);
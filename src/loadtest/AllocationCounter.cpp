@@ -0,0 +1,61 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/// \addtogroup loadtest
+/// @{
+/// \file
+
+#include "LoadGenerator.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+/*
+ * Counting global allocator. Only used by the loadtest binary, the numbers reported are the
+ * allocations done inside World::Update (world, sessions and map updates).
+ * Kept in its own file: inlined into callers it misleads the compiler's object size checks.
+ */
+static std::atomic<uint64> s_allocationCount(0);
+static std::atomic<uint64> s_allocatedBytes(0);
+
+uint64 GetAllocationCount() { return s_allocationCount.load(std::memory_order_relaxed); }
+uint64 GetAllocatedBytes() { return s_allocatedBytes.load(std::memory_order_relaxed); }
+
+void* operator new(std::size_t size)
+{
+    s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    s_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t /*size*/) noexcept
+{
+    std::free(ptr);
+}
+
+/// @}
@@ -0,0 +1,479 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/// \addtogroup loadtest
+/// @{
+/// \file
+
+#include "LoadGenerator.h"
+#include "Accounts/AccountMgr.h"
+#include "Database/DatabaseEnv.h"
+#include "Entities/Player.h"
+#include "Grids/CellImpl.h"
+#include "Grids/GridNotifiers.h"
+#include "Grids/GridNotifiersImpl.h"
+#include "Log.h"
+#include "Maps/GridMap.h"
+#include "Maps/MapManager.h"
+#include "Server/WorldSession.h"
+#include "Spells/SpellTargetDefines.h"
+#include "Timer.h"
+#include "Util.h"
+#include "World/World.h"
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#define LOADTEST_SLEEP_CONST 50                             // same as WORLD_SLEEP_CONST of mangosd
+#define LOADTEST_HEARTBEAT   500                            // client sends MSG_MOVE_HEARTBEAT every 500ms while moving
+#define LOADTEST_TARGET_RANGE 30.0f
+
+static char const* const s_chatLines[] =
+{
+    "Anyone up for a group?",
+    "Looking for more to kill some mobs here",
+    "WTS [Linen Cloth] x20, pst",
+    "Where is the flight master?",
+};
+
+LoadGenerator::LoadGenerator(LoadTestConfig const& config) : m_config(config),
+    m_measuredTicks(0), m_measuredMs(0), m_allocations(0), m_allocatedBytes(0),
+    m_sentPackets(0), m_sentBytes(0), m_activeBots(0)
+{
+}
+
+/// Create the accounts, headless sessions and characters of all bots and queue their login
+bool LoadGenerator::Setup()
+{
+    m_bots.resize(m_config.players);
+
+    for (uint32 i = 0; i < m_config.players; ++i)
+    {
+        std::string username = m_config.accountPrefix + std::to_string(i);
+        AccountOpResult result = sAccountMgr.CreateAccount(username, username);
+        if (result != AOR_OK && result != AOR_NAME_ALREADY_EXIST)
+        {
+            sLog.outError("LoadTest: can't create account %s (error %u)", username.c_str(), uint32(result));
+            return false;
+        }
+
+        // unique letter only name, CheckPlayerName refuses digits
+        LoadBot& bot = m_bots[i];
+        bot.name = "Loadbot";
+        for (uint32 n = i, l = 0; l < 4; ++l, n /= 26)
+            bot.name += char('a' + n % 26);
+    }
+
+    // accounts are inserted by the async delay thread
+    for (uint32 i = 0, tries = 0; i < m_config.players;)
+    {
+        LoadBot& bot = m_bots[i];
+        bot.accountId = sAccountMgr.GetId(m_config.accountPrefix + std::to_string(i));
+        if (bot.accountId)
+        {
+            ++i;
+            continue;
+        }
+
+        if (++tries > 100)
+        {
+            sLog.outError("LoadTest: account %s%u not found", m_config.accountPrefix.c_str(), i);
+            return false;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    for (LoadBot& bot : m_bots)
+    {
+        bot.session = new WorldSession(bot.accountId, nullptr, SEC_PLAYER, 0, LOCALE_enUS);
+        bot.session->SetHeadless();
+        sWorld.AddSession(bot.session);
+    }
+
+    if (!PrepareCharacters())
+        return false;
+
+    for (LoadBot& bot : m_bots)
+    {
+        bot.session = sWorld.FindSession(bot.accountId);
+        if (!bot.session)
+        {
+            sLog.outError("LoadTest: session of account %u was removed", bot.accountId);
+            continue;
+        }
+
+        // spread the bots around the center before login
+        float angle = frand(0.0f, 2 * M_PI_F);
+        float dist = frand(0.0f, m_config.radius * 0.8f);
+        CharacterDatabase.DirectPExecute("UPDATE characters SET map = '%u', position_x = '%f', position_y = '%f', position_z = '%f', orientation = '%f', "
+                                         "trans_x = 0, trans_y = 0, trans_z = 0, trans_o = 0, transguid = 0 WHERE guid = '%u'",
+                                         m_config.mapId, m_config.x + dist * cos(angle), m_config.y + dist * sin(angle), m_config.z, angle,
+                                         bot.guid.GetCounter());
+
+        WorldPacket data(CMSG_PLAYER_LOGIN, 8);
+        data << bot.guid;
+        Queue(bot, data);
+        bot.state = LOADBOT_LOGIN;
+    }
+
+    return true;
+}
+
+/// Find or create (through CMSG_CHAR_CREATE) the character of every bot
+bool LoadGenerator::PrepareCharacters()
+{
+    for (LoadBot& bot : m_bots)
+    {
+        QueryResult* result = CharacterDatabase.PQuery("SELECT guid FROM characters WHERE account = '%u' AND name = '%s'",
+                                                       bot.accountId, bot.name.c_str());
+        if (result)
+        {
+            bot.guid = ObjectGuid(HIGHGUID_PLAYER, (*result)[0].GetUInt32());
+            delete result;
+            continue;
+        }
+
+        WorldPacket data(CMSG_CHAR_CREATE, 20);
+        data << bot.name;
+        data << uint8(m_config.race);
+        data << uint8(m_config.playerClass);
+        data << uint8(0) << uint8(0) << uint8(0);          // gender, skin, face
+        data << uint8(0) << uint8(0) << uint8(0);          // hair style, hair color, facial hair
+        data << uint8(0);                                  // outfit
+        Queue(bot, data);
+    }
+
+    // sessions are added and the packets handled in World::UpdateSessions
+    for (uint32 tries = 0; tries < 200; ++tries)
+    {
+        sWorld.Update(LOADTEST_SLEEP_CONST);
+
+        bool done = true;
+        for (LoadBot& bot : m_bots)
+        {
+            if (!bot.guid.IsEmpty())
+                continue;
+
+            QueryResult* result = CharacterDatabase.PQuery("SELECT guid FROM characters WHERE account = '%u' AND name = '%s'",
+                                                           bot.accountId, bot.name.c_str());
+            if (!result)
+            {
+                done = false;
+                continue;
+            }
+
+            bot.guid = ObjectGuid(HIGHGUID_PLAYER, (*result)[0].GetUInt32());
+            delete result;
+        }
+
+        if (done)
+            return true;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(LOADTEST_SLEEP_CONST));
+    }
+
+    sLog.outError("LoadTest: not all characters could be created, check CharactersPerRealm and the race/class combination");
+    return false;
+}
+
+/// Run the world loop like WorldRunnable, bots act before every world update
+void LoadGenerator::Run()
+{
+    uint32 const warmupMs = m_config.warmup * IN_MILLISECONDS;
+    uint32 const totalMs = (m_config.warmup + m_config.duration) * IN_MILLISECONDS;
+
+    uint32 elapsed = 0;
+    uint32 prevSleepTime = 0;
+    bool measuring = false;
+
+    WorldTimer::tick();
+
+    while (elapsed < totalMs && !World::IsStopped())
+    {
+        ++World::m_worldLoopCounter;
+        uint32 diff = WorldTimer::tick();
+        elapsed += diff;
+
+        if (!measuring && elapsed >= warmupMs)
+        {
+            measuring = true;
+            for (LoadBot& bot : m_bots)
+            {
+                if (WorldSession* session = sWorld.FindSession(bot.accountId))
+                {
+                    bot.sentPackets = session->GetSentPacketCount();
+                    bot.sentBytes = session->GetSentPacketBytes();
+                }
+            }
+
+            sLog.outString("LoadTest: warmup done, %u of %u bots in world", m_activeBots, m_config.players);
+        }
+
+        for (LoadBot& bot : m_bots)
+            UpdateBot(bot, diff);
+
+        uint64 allocations = GetAllocationCount();
+        uint64 allocatedBytes = GetAllocatedBytes();
+        TickProfiler::Clock::time_point start = TickProfiler::Clock::now();
+
+        sWorld.Update(diff);
+
+        if (measuring)
+        {
+            m_tickHistogram.Add(uint32(std::chrono::duration_cast<std::chrono::microseconds>(TickProfiler::Clock::now() - start).count()));
+            m_allocations += GetAllocationCount() - allocations;
+            m_allocatedBytes += GetAllocatedBytes() - allocatedBytes;
+            m_measuredMs += diff;
+            ++m_measuredTicks;
+        }
+
+        if (diff <= LOADTEST_SLEEP_CONST + prevSleepTime)
+        {
+            prevSleepTime = LOADTEST_SLEEP_CONST + prevSleepTime - diff;
+            std::this_thread::sleep_for(std::chrono::milliseconds(prevSleepTime));
+        }
+        else
+            prevSleepTime = 0;
+    }
+
+    for (LoadBot const& bot : m_bots)
+    {
+        if (WorldSession* session = sWorld.FindSession(bot.accountId))
+        {
+            m_sentPackets += session->GetSentPacketCount() - bot.sentPackets;
+            m_sentBytes += session->GetSentPacketBytes() - bot.sentBytes;
+        }
+    }
+}
+
+void LoadGenerator::Report() const
+{
+    double const seconds = m_measuredMs / 1000.0;
+    uint32 const players = std::max(m_activeBots, 1u);
+
+    sLog.outString();
+    sLog.outString("LoadTest: %u bots in world on map %u, %u measured ticks over %.1fs", m_activeBots, m_config.mapId, uint32(m_measuredTicks), seconds);
+    sLog.outString("  World::Update   p50 %8.2fms  p95 %8.2fms  p99 %8.2fms  max %8.2fms",
+                   m_tickHistogram.GetPercentile(50.0f) / 1000.0f, m_tickHistogram.GetPercentile(95.0f) / 1000.0f,
+                   m_tickHistogram.GetPercentile(99.0f) / 1000.0f, m_tickHistogram.GetMax() / 1000.0f);
+
+    if (m_measuredTicks)
+        sLog.outString("  allocations     %.1f per tick, %.1f KB per tick",
+                       double(m_allocations) / m_measuredTicks, double(m_allocatedBytes) / m_measuredTicks / 1024.0);
+
+    if (seconds > 0.0)
+        sLog.outString("  sent packets    %.1f per player/s, %.1f bytes per player/s",
+                       m_sentPackets / seconds / players, m_sentBytes / seconds / players);
+
+    TickProfiler const& worldProfiler = sWorld.GetTickProfiler();
+    sLog.outString("World update:");
+    for (uint32 i = 0; i <= worldProfiler.GetPhaseCount(); ++i)
+        sLog.outString("  %s", worldProfiler.FormatPhase(i).c_str());
+
+    if (Map* map = sMapMgr.FindMap(m_config.mapId))
+    {
+        TickProfiler const& mapProfiler = map->GetTickProfiler();
+        sLog.outString("Map[%u] update:", map->GetId());
+        for (uint32 i = 0; i <= mapProfiler.GetPhaseCount(); ++i)
+            sLog.outString("  %s", mapProfiler.FormatPhase(i).c_str());
+    }
+}
+
+void LoadGenerator::UpdateBot(LoadBot& bot, uint32 diff)
+{
+    // the session may have been removed by World (kick, duplicate login)
+    WorldSession* session = sWorld.FindSession(bot.accountId);
+    if (!session)
+        return;
+
+    bot.session = session;
+    Player* player = session->GetPlayer();
+    if (!player || !player->IsInWorld())
+        return;
+
+    if (bot.state == LOADBOT_LOGIN)
+    {
+        bot.state = LOADBOT_ACTIVE;
+        bot.orientation = player->GetOrientation();
+        bot.moveTimer = urand(0, 5000);
+        bot.chatTimer = urand(0, m_config.chatInterval);
+        bot.castTimer = urand(0, m_config.castInterval);
+        bot.attackTimer = urand(0, m_config.attackInterval);
+        ++m_activeBots;
+        return;
+    }
+
+    // no client to release the spirit and run back
+    if (!player->isAlive())
+    {
+        player->ResurrectPlayer(1.0f);
+        player->SpawnCorpseBones();
+        return;
+    }
+
+    UpdateMovement(bot, player, diff);
+
+    if (m_config.attackInterval)
+    {
+        bot.attackTimer -= diff;
+        if (bot.attackTimer <= 0)
+        {
+            bot.attackTimer = m_config.attackInterval;
+            Attack(bot, player);
+        }
+    }
+
+    if (m_config.spellId)
+    {
+        bot.castTimer -= diff;
+        if (bot.castTimer <= 0)
+        {
+            bot.castTimer = m_config.castInterval;
+            Cast(bot, player);
+        }
+    }
+
+    if (m_config.chatInterval)
+    {
+        bot.chatTimer -= diff;
+        if (bot.chatTimer <= 0)
+        {
+            bot.chatTimer = m_config.chatInterval;
+            Chat(bot, player);
+        }
+    }
+}
+
+void LoadGenerator::UpdateMovement(LoadBot& bot, Player* player, uint32 diff)
+{
+    bot.moveTimer -= diff;
+    if (bot.moveTimer <= 0)
+    {
+        bot.moveTimer = urand(2000, 6000);
+
+        if (bot.moving)
+        {
+            bot.moving = false;
+            SendMovement(bot, MSG_MOVE_STOP, MOVEFLAG_NONE, player->GetPositionX(), player->GetPositionY(), player->GetPositionZ());
+        }
+        else if (urand(0, 99) < m_config.moveChance)
+        {
+            // head back when near the edge of the area
+            if (player->GetDistance2d(m_config.x, m_config.y) > m_config.radius * 0.8f)
+                bot.orientation = player->GetAngle(m_config.x, m_config.y);
+            else
+                bot.orientation = frand(0.0f, 2 * M_PI_F);
+
+            bot.moving = true;
+            bot.heartbeatTimer = LOADTEST_HEARTBEAT;
+            SendMovement(bot, MSG_MOVE_START_FORWARD, MOVEFLAG_FORWARD, player->GetPositionX(), player->GetPositionY(), player->GetPositionZ());
+        }
+        return;
+    }
+
+    if (!bot.moving)
+        return;
+
+    bot.heartbeatTimer -= diff;
+    if (bot.heartbeatTimer > 0)
+        return;
+
+    float dist = player->GetSpeed(MOVE_RUN) * (LOADTEST_HEARTBEAT - bot.heartbeatTimer) / IN_MILLISECONDS;
+    bot.heartbeatTimer = LOADTEST_HEARTBEAT;
+
+    float x = player->GetPositionX() + dist * cos(bot.orientation);
+    float y = player->GetPositionY() + dist * sin(bot.orientation);
+    float z = player->GetMap()->GetHeight(x, y, player->GetPositionZ() + 2.0f);
+
+    // stop at walls, cliffs and the edge of the area, turn around for the next run
+    if (z <= INVALID_HEIGHT || fabs(z - player->GetPositionZ()) > 5.0f || (x - m_config.x) * (x - m_config.x) + (y - m_config.y) * (y - m_config.y) > m_config.radius * m_config.radius)
+    {
+        bot.moving = false;
+        bot.orientation = player->GetAngle(m_config.x, m_config.y);
+        SendMovement(bot, MSG_MOVE_STOP, MOVEFLAG_NONE, player->GetPositionX(), player->GetPositionY(), player->GetPositionZ());
+        return;
+    }
+
+    SendMovement(bot, MSG_MOVE_HEARTBEAT, MOVEFLAG_FORWARD, x, y, z);
+}
+
+void LoadGenerator::Attack(LoadBot& bot, Player* player)
+{
+    if (Unit* victim = player->getVictim())
+        if (victim->isAlive())
+            return;
+
+    Unit* target = nullptr;
+    MaNGOS::NearestAttackableUnitInObjectRangeCheck u_check(player, nullptr, LOADTEST_TARGET_RANGE);
+    MaNGOS::UnitLastSearcher<MaNGOS::NearestAttackableUnitInObjectRangeCheck> searcher(target, u_check);
+    Cell::VisitAllObjects(player, searcher, LOADTEST_TARGET_RANGE);
+
+    if (!target)
+        return;
+
+    WorldPacket selection(CMSG_SET_SELECTION, 8);
+    selection << target->GetObjectGuid();
+    Queue(bot, selection);
+
+    WorldPacket swing(CMSG_ATTACKSWING, 8);
+    swing << target->GetObjectGuid();
+    Queue(bot, swing);
+}
+
+void LoadGenerator::Cast(LoadBot& bot, Player* player)
+{
+    Unit* target = player->GetMap()->GetUnit(player->GetSelectionGuid());
+    if (!target || !target->isAlive())
+        return;
+
+    WorldPacket data(CMSG_CAST_SPELL, 4 + 2 + 8);
+    data << uint32(m_config.spellId);
+    data << uint16(TARGET_FLAG_UNIT);
+    data << target->GetPackGUID();
+    Queue(bot, data);
+}
+
+void LoadGenerator::Chat(LoadBot& bot, Player* player)
+{
+    WorldPacket data(CMSG_MESSAGECHAT, 100);
+    data << uint32(CHAT_MSG_SAY);
+    data << uint32(player->GetTeam() == ALLIANCE ? LANG_COMMON : LANG_ORCISH);
+    data << s_chatLines[urand(0, countof(s_chatLines) - 1)];
+    Queue(bot, data);
+}
+
+void LoadGenerator::SendMovement(LoadBot& bot, uint16 opcode, uint32 moveFlags, float x, float y, float z)
+{
+    MovementInfo movementInfo;
+    movementInfo.SetMovementFlags(MovementFlags(moveFlags));
+    movementInfo.UpdateTime(WorldTimer::getMSTime());
+    movementInfo.ChangePosition(x, y, z, bot.orientation);
+
+    WorldPacket data(opcode, 4 + 4 + 4 * 4 + 4);
+    data << movementInfo;
+    Queue(bot, data);
+}
+
+void LoadGenerator::Queue(LoadBot& bot, WorldPacket const& packet)
+{
+    bot.session->QueuePacket(std::unique_ptr<WorldPacket>(new WorldPacket(packet)));
+}
+
+/// @}
@@ -0,0 +1,139 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/// \addtogroup loadtest
+/// @{
+/// \file
+
+#ifndef __LOADGENERATOR_H
+#define __LOADGENERATOR_H
+
+#include "Common.h"
+#include "Entities/ObjectGuid.h"
+#include "World/TickProfiler.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class Player;
+class Unit;
+class WorldPacket;
+class WorldSession;
+
+/// Scenario of a load test run, filled from the command line
+struct LoadTestConfig
+{
+    LoadTestConfig() : players(100), mapId(0), x(-8949.95f), y(-132.49f), z(83.53f), radius(60.0f),
+        duration(120), warmup(30), race(1), playerClass(8), spellId(133),
+        moveChance(60), chatInterval(15000), castInterval(3000), attackInterval(5000) {}
+
+    std::string accountPrefix;                              // accounts <prefix><n>, created when missing
+    uint32 players;
+    uint32 mapId;
+    float x, y, z;                                          // center of the area the bots are spread and move in
+    float radius;
+    uint32 duration;                                        // measured seconds
+    uint32 warmup;                                          // seconds before measuring, logins happen here
+    uint8 race;
+    uint8 playerClass;
+    uint32 spellId;                                         // 0 to disable casting
+    uint32 moveChance;                                      // percent of bots moving at a time
+    uint32 chatInterval;                                    // ms, 0 to disable
+    uint32 castInterval;                                    // ms
+    uint32 attackInterval;                                  // ms, 0 to disable
+};
+
+enum LoadBotState
+{
+    LOADBOT_CREATE,                                         // character being created
+    LOADBOT_LOGIN,                                          // CMSG_PLAYER_LOGIN queued
+    LOADBOT_ACTIVE,
+};
+
+/// One scripted player, driven by packets queued into its headless session
+struct LoadBot
+{
+    LoadBot() : accountId(0), session(nullptr), state(LOADBOT_CREATE), moving(false), orientation(0.0f),
+        moveTimer(0), heartbeatTimer(0), chatTimer(0), castTimer(0), attackTimer(0), sentPackets(0), sentBytes(0) {}
+
+    uint32 accountId;
+    std::string name;
+    ObjectGuid guid;
+    WorldSession* session;                                  // owned by World
+    LoadBotState state;
+
+    bool moving;
+    float orientation;
+    int32 moveTimer;
+    int32 heartbeatTimer;
+    int32 chatTimer;
+    int32 castTimer;
+    int32 attackTimer;
+
+    uint64 sentPackets;                                     // session counters when measuring started
+    uint64 sentBytes;
+};
+
+/**
+ * Drives headless WorldSessions through the world loop without any network.
+ *
+ * Every bot is a regular account session flagged headless: packets are queued into its receive
+ * queue and handled by the normal opcode handlers, packets sent to it are only counted. The world
+ * loop is run the same way WorldRunnable does, measuring every World::Update after the warmup.
+ */
+class LoadGenerator
+{
+    public:
+        explicit LoadGenerator(LoadTestConfig const& config);
+
+        bool Setup();
+        void Run();
+        void Report() const;
+
+    private:
+        bool PrepareCharacters();
+        void UpdateBot(LoadBot& bot, uint32 diff);
+        void UpdateMovement(LoadBot& bot, Player* player, uint32 diff);
+        void Attack(LoadBot& bot, Player* player);
+        void Cast(LoadBot& bot, Player* player);
+        void Chat(LoadBot& bot, Player* player);
+
+        void SendMovement(LoadBot& bot, uint16 opcode, uint32 moveFlags, float x, float y, float z);
+        static void Queue(LoadBot& bot, WorldPacket const& packet);
+
+        LoadTestConfig m_config;
+        std::vector<LoadBot> m_bots;
+
+        // measured after warmup
+        TickHistogram m_tickHistogram;
+        uint64 m_measuredTicks;
+        uint64 m_measuredMs;
+        uint64 m_allocations;
+        uint64 m_allocatedBytes;
+        uint64 m_sentPackets;
+        uint64 m_sentBytes;
+        uint32 m_activeBots;
+};
+
+/// Allocation counters of the global operator new, see LoadGenerator.cpp
+uint64 GetAllocationCount();
+uint64 GetAllocatedBytes();
+
+#endif
+/// @}
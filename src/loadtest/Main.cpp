@@ -0,0 +1,217 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/// \addtogroup loadtest Headless load test
+/// @{
+/// \file
+
+#include "Common.h"
+#include "Database/DatabaseEnv.h"
+#include "Config/Config.h"
+#include "ProgressBar.h"
+#include "Log.h"
+#include "Timer.h"
+#include "SystemConfig.h"
+#include "revision_sql.h"
+#include "World/World.h"
+#include "Mails/MassMailMgr.h"
+#include "LoadGenerator.h"
+
+#include <boost/program_options.hpp>
+
+#include <iostream>
+#include <string>
+
+DatabaseType WorldDatabase;                                 ///< Accessor to the world database
+DatabaseType CharacterDatabase;                             ///< Accessor to the character database
+DatabaseType LoginDatabase;                                 ///< Accessor to the realm/login database
+
+uint32 realmID;                                             ///< Id of the realm
+
+/// Connect the databases the same way mangosd does
+static bool StartDB()
+{
+    char const* const databases[] = { "World", "Character", "Login" };
+    DatabaseType* const handles[] = { &WorldDatabase, &CharacterDatabase, &LoginDatabase };
+
+    for (uint32 i = 0; i < countof(databases); ++i)
+    {
+        std::string name = databases[i];
+        std::string dbstring = sConfig.GetStringDefault(name + "DatabaseInfo");
+        int nConnections = sConfig.GetIntDefault(name + "DatabaseConnections", 1);
+        int nAsyncConnections = sConfig.GetIntDefault(name + "DatabaseAsyncConnections", 1);
+        if (dbstring.empty() || !handles[i]->Initialize(dbstring.c_str(), nConnections, nAsyncConnections))
+        {
+            sLog.outError("Cannot connect to %s database %s", name.c_str(), dbstring.c_str());
+
+            for (uint32 j = 0; j < i; ++j)
+                handles[j]->HaltDelayThread();
+            return false;
+        }
+    }
+
+    if (!WorldDatabase.CheckRequiredField("db_version", REVISION_DB_MANGOS) ||
+            !CharacterDatabase.CheckRequiredField("character_db_version", REVISION_DB_CHARACTERS) ||
+            !LoginDatabase.CheckRequiredField("realmd_db_version", REVISION_DB_REALMD))
+    {
+        WorldDatabase.HaltDelayThread();
+        CharacterDatabase.HaltDelayThread();
+        LoginDatabase.HaltDelayThread();
+        return false;
+    }
+
+    realmID = sConfig.GetIntDefault("RealmID", 0);
+    if (!realmID)
+    {
+        sLog.outError("Realm ID not defined in configuration file");
+        WorldDatabase.HaltDelayThread();
+        CharacterDatabase.HaltDelayThread();
+        LoginDatabase.HaltDelayThread();
+        return false;
+    }
+
+    CharacterDatabase.Execute("UPDATE characters SET online = 0 WHERE online<>0");
+
+    sWorld.LoadDBVersion();
+    return true;
+}
+
+/// Launch the world without network and drive it with headless bots
+int main(int argc, char* argv[])
+{
+    std::string configFile;
+    LoadTestConfig config;
+    uint32 race, playerClass;
+    int binaryResults;
+
+    boost::program_options::options_description desc("Allowed options");
+    desc.add_options()
+    ("config,c", boost::program_options::value<std::string>(&configFile)->default_value(_MANGOSD_CONFIG), "configuration file")
+    ("players,p", boost::program_options::value<uint32>(&config.players)->default_value(config.players), "number of bots")
+    ("accounts", boost::program_options::value<std::string>(&config.accountPrefix)->default_value("LOADTEST"), "account name prefix, accounts are created when missing")
+    ("map,m", boost::program_options::value<uint32>(&config.mapId)->default_value(config.mapId), "map id")
+    ("x", boost::program_options::value<float>(&config.x)->default_value(config.x), "center x")
+    ("y", boost::program_options::value<float>(&config.y)->default_value(config.y), "center y")
+    ("z", boost::program_options::value<float>(&config.z)->default_value(config.z), "center z")
+    ("radius,r", boost::program_options::value<float>(&config.radius)->default_value(config.radius), "radius of the area around the center")
+    ("duration,d", boost::program_options::value<uint32>(&config.duration)->default_value(config.duration), "measured seconds")
+    ("warmup,w", boost::program_options::value<uint32>(&config.warmup)->default_value(config.warmup), "seconds before measuring")
+    ("race", boost::program_options::value<uint32>(&race)->default_value(config.race), "race of created characters")
+    ("class", boost::program_options::value<uint32>(&playerClass)->default_value(config.playerClass), "class of created characters")
+    ("spell", boost::program_options::value<uint32>(&config.spellId)->default_value(config.spellId), "spell cast on the selected target, 0 to disable")
+    ("move", boost::program_options::value<uint32>(&config.moveChance)->default_value(config.moveChance), "percent chance to start moving")
+    ("chat", boost::program_options::value<uint32>(&config.chatInterval)->default_value(config.chatInterval), "say interval in ms, 0 to disable")
+    ("cast", boost::program_options::value<uint32>(&config.castInterval)->default_value(config.castInterval), "cast interval in ms")
+    ("attack", boost::program_options::value<uint32>(&config.attackInterval)->default_value(config.attackInterval), "attack interval in ms, 0 to disable")
+    ("binary-results", boost::program_options::value<int>(&binaryResults)->default_value(-1), "fetch query results with the binary protocol (1) or as text (0), -1 to use the configuration")
+    ("startup-only", "only measure loading the world")
+    ("help,h", "prints usage");
+
+    boost::program_options::variables_map vm;
+
+    try
+    {
+        boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc), vm);
+        boost::program_options::notify(vm);
+
+        if (vm.count("help"))
+        {
+            std::cout << desc << std::endl;
+            return 0;
+        }
+    }
+    catch (boost::program_options::error const& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl << std::endl;
+        std::cerr << desc << std::endl;
+
+        return 1;
+    }
+
+    config.race = uint8(race);
+    config.playerClass = uint8(playerClass);
+
+    if (!sConfig.SetSource(configFile))
+    {
+        sLog.outError("Could not find configuration file %s.", configFile.c_str());
+        return 1;
+    }
+
+    sLog.outString("Using configuration file %s.", configFile.c_str());
+    BarGoLink::SetOutputState(false);
+
+    if (!StartDB())
+        return 1;
+
+    if (binaryResults >= 0)
+    {
+        WorldDatabase.SetBinaryResults(binaryResults != 0);
+        CharacterDatabase.SetBinaryResults(binaryResults != 0);
+        LoginDatabase.SetBinaryResults(binaryResults != 0);
+    }
+
+    uint32 startTime = WorldTimer::getMSTime();
+    sWorld.SetInitialWorldSettings();
+    sLog.outString("Loaded the world in %u ms with %s query results", WorldTimer::getMSTimeDiff(startTime, WorldTimer::getMSTime()),
+                   WorldDatabase.UseBinaryResults() ? "binary" : "text");
+
+    if (vm.count("startup-only"))
+    {
+        World::StopNow(SHUTDOWN_EXIT_CODE);
+        sWorld.CleanupsBeforeStop();
+
+        CharacterDatabase.HaltDelayThread();
+        WorldDatabase.HaltDelayThread();
+        LoginDatabase.HaltDelayThread();
+        return 0;
+    }
+
+    // keep the whole measured run in the profiler windows
+    TickProfiler::SetWindow(config.warmup + config.duration);
+
+    WorldDatabase.ThreadStart();
+    sWorld.InitResultQueue();
+
+    LoadGenerator generator(config);
+    bool ready = generator.Setup();
+
+    // same order as mangosd, async transactions only after the characters are in place
+    CharacterDatabase.AllowAsyncTransactions();
+    WorldDatabase.AllowAsyncTransactions();
+    LoginDatabase.AllowAsyncTransactions();
+
+    if (ready)
+    {
+        generator.Run();
+        generator.Report();
+    }
+
+    World::StopNow(SHUTDOWN_EXIT_CODE);
+    sWorld.CleanupsBeforeStop();
+    WorldDatabase.ThreadEnd();
+
+    sMassMailMgr.Update(true);
+
+    CharacterDatabase.HaltDelayThread();
+    WorldDatabase.HaltDelayThread();
+    LoginDatabase.HaltDelayThread();
+
+    return ready ? 0 : 1;
+}
+
+/// @}
@@ -0,0 +1,503 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/// \addtogroup loadtest
+/// @{
+/// \file
+/// Benchmark of the network backends (Network.IoUring) without database or client data.
+///
+/// The server serves loopback connections through MaNGOS::Listener like mangosd with Network.TickFlush:
+/// every tick each connection gets a few packets, sent at the end of the tick by Socket::FlushDirty().
+/// A forked process drives the clients, each of them sends a small packet every --send-interval.
+///
+/// Reported for the measured window are the CPU time of the server process and, with --syscalls, the
+/// system calls of all its threads, counted by tracing it from the parent process. Both are given per
+/// 1000 connections and second. The tracer slows the server down, take the CPU time from a run without it.
+
+#include "Common.h"
+#include "Log.h"
+#include "Network/IoUring.hpp"
+#include "Network/Listener.hpp"
+#include "Network/Socket.hpp"
+
+#include <boost/program_options.hpp>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/ptrace.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct NetBenchConfig
+{
+    NetBenchConfig() : connections(1000), threads(1), port(18085), tick(50), packets(4), packetSize(64),
+        sendInterval(500), clientPacketSize(40), warmup(3), duration(10), ioUring(false), syscalls(false) {}
+
+    uint32 connections;
+    uint32 threads;                                         ///< network threads of the server
+    uint32 port;
+    uint32 tick;                                            ///< ms between the flushes of the server
+    uint32 packets;                                         ///< packets sent to every connection per tick
+    uint32 packetSize;
+    uint32 sendInterval;                                    ///< ms between two packets of one client
+    uint32 clientPacketSize;
+    uint32 warmup;                                          ///< seconds before measuring
+    uint32 duration;                                        ///< measured seconds
+    bool ioUring;
+    bool syscalls;
+};
+
+/// Server side connection, client packets are a uint16 size followed by the payload
+class BenchSocket : public MaNGOS::Socket
+{
+    private:
+        static std::mutex s_lock;
+        static std::vector<std::shared_ptr<BenchSocket> > s_sockets;
+
+    protected:
+        bool ProcessIncomingData() override
+        {
+            uint16 size;
+            if (!Read(reinterpret_cast<char*>(&size), sizeof(size)))
+            {
+                errno = EBADMSG;
+                return false;
+            }
+
+            if (ReadLengthRemaining() < size)
+            {
+                ReadSkip(-static_cast<int>(sizeof(size)));
+                errno = EBADMSG;
+                return false;
+            }
+
+            ReadSkip(size);
+            ++s_received;
+            return true;
+        }
+
+    public:
+        static std::atomic<uint64> s_received;
+
+        BenchSocket(boost::asio::io_service& service, std::function<void (Socket*)> closeHandler) : Socket(service, std::move(closeHandler)) {}
+
+        bool Open() override
+        {
+            if (!Socket::Open())
+                return false;
+
+            std::lock_guard<std::mutex> guard(s_lock);
+            s_sockets.push_back(shared<BenchSocket>());
+            return true;
+        }
+
+        static std::vector<std::shared_ptr<BenchSocket> > GetSockets()
+        {
+            std::lock_guard<std::mutex> guard(s_lock);
+            return s_sockets;
+        }
+};
+
+std::mutex BenchSocket::s_lock;
+std::vector<std::shared_ptr<BenchSocket> > BenchSocket::s_sockets;
+std::atomic<uint64> BenchSocket::s_received(0);
+
+static volatile sig_atomic_t s_stopClients = 0;
+
+static void StopClients(int /*signal*/)
+{
+    s_stopClients = 1;
+}
+
+/// Connect all clients and keep them sending and reading until SIGTERM
+static int RunClients(NetBenchConfig const& config)
+{
+    signal(SIGTERM, StopClients);
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(uint16(config.port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    int poll = epoll_create1(0);
+    std::vector<int> clients;
+    clients.reserve(config.connections);
+
+    for (uint32 i = 0; i < config.connections && !s_stopClients; ++i)
+    {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+        // the server may still be starting
+        uint32 tries = 0;
+        while (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+        {
+            if (++tries == 200 || s_stopClients)
+            {
+                std::cerr << "netbench: connecting client " << i << " failed: " << strerror(errno) << std::endl;
+                return 1;
+            }
+
+            close(fd);
+            fd = socket(AF_INET, SOCK_STREAM, 0);
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+
+        int noDelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.u32 = i;
+        epoll_ctl(poll, EPOLL_CTL_ADD, fd, &event);
+
+        clients.push_back(fd);
+    }
+
+    std::vector<char> packet(std::max<uint32>(config.clientPacketSize, 2), 0);
+    uint16 payload = uint16(packet.size() - 2);
+    memcpy(&packet[0], &payload, sizeof(payload));
+
+    // the clients send in steps of 10 ms, each one once per send interval
+    uint32 const steps = std::max<uint32>(config.sendInterval / 10, 1);
+    uint32 step = 0;
+    auto nextStep = std::chrono::steady_clock::now();
+
+    std::vector<char> buffer(65536);
+    epoll_event events[256];
+
+    while (!s_stopClients)
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= nextStep)
+        {
+            for (size_t i = step; i < clients.size(); i += steps)
+                if (send(clients[i], &packet[0], packet.size(), MSG_NOSIGNAL) < 0 && errno != EAGAIN)
+                    return 1;
+
+            step = (step + 1) % steps;
+            nextStep += std::chrono::milliseconds(10);
+            continue;
+        }
+
+        int timeout = int(std::chrono::duration_cast<std::chrono::milliseconds>(nextStep - now).count()) + 1;
+        int count = epoll_wait(poll, events, 256, timeout);
+        for (int i = 0; i < count; ++i)
+        {
+            int fd = clients[events[i].data.u32];
+            while (recv(fd, &buffer[0], buffer.size(), 0) > 0) {}
+        }
+    }
+
+    for (int fd : clients)
+        close(fd);
+    close(poll);
+
+    return 0;
+}
+
+/// Serve the clients, measure the window between the two getppid() calls, the tracer counts between them
+static int RunServer(NetBenchConfig const& config)
+{
+    MaNGOS::Socket::SetFlushPolicy(true, 16384, true);
+    MaNGOS::IoUring::SetEnabled(config.ioUring);
+
+    // never destroyed, tearing down the detached network threads is not needed as the process ends with _exit()
+    new MaNGOS::Listener<BenchSocket>("127.0.0.1", int(config.port), int(config.threads));
+
+    auto const connectDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+    while (BenchSocket::GetSockets().size() < config.connections)
+    {
+        if (std::chrono::steady_clock::now() > connectDeadline)
+        {
+            sLog.outError("netbench: only " SIZEFMTD " of %u clients connected", BenchSocket::GetSockets().size(), config.connections);
+            return 1;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    std::vector<std::shared_ptr<BenchSocket> > sockets = BenchSocket::GetSockets();
+
+    std::vector<char> packet(std::max<uint32>(config.packetSize, 4), 0);
+    uint64 sent = 0;
+
+    auto nextTick = std::chrono::steady_clock::now();
+    auto runTicks = [&](uint32 seconds)
+    {
+        auto const end = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+        while (nextTick < end)
+        {
+            for (auto const& socket : sockets)
+            {
+                for (uint32 i = 0; i < config.packets; ++i)
+                    socket->Write(&packet[0], int(packet.size()));
+                sent += config.packets * packet.size();
+            }
+
+            MaNGOS::Socket::FlushDirty();
+
+            nextTick += std::chrono::milliseconds(config.tick);
+            std::this_thread::sleep_until(nextTick);
+        }
+    };
+
+    runTicks(config.warmup);
+
+    sent = 0;
+    uint64 const receivedBefore = BenchSocket::s_received;
+    rusage usageBefore;
+    getrusage(RUSAGE_SELF, &usageBefore);
+    auto const start = std::chrono::steady_clock::now();
+    syscall(SYS_getppid);
+
+    runTicks(config.duration);
+
+    syscall(SYS_getppid);
+    rusage usageAfter;
+    getrusage(RUSAGE_SELF, &usageAfter);
+    double const seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    auto milliseconds = [](timeval const& before, timeval const& after)
+    {
+        return (after.tv_sec - before.tv_sec) * 1000.0 + (after.tv_usec - before.tv_usec) / 1000.0;
+    };
+
+    double const user = milliseconds(usageBefore.ru_utime, usageAfter.ru_utime);
+    double const system = milliseconds(usageBefore.ru_stime, usageAfter.ru_stime);
+    double const perThousand = (user + system) / seconds / (config.connections / 1000.0);
+
+    sLog.outString("netbench: %s, %u connections, %u network threads, %.1f s measured", config.ioUring ? "io_uring" : "asio",
+                   config.connections, config.threads, seconds);
+    sLog.outString("  server cpu: %.0f ms user, %.0f ms system, %.1f ms per second and 1000 connections", user, system, perThousand);
+    sLog.outString("  received " UI64FMTD " client packets, sent " UI64FMTD " bytes", uint64(BenchSocket::s_received - receivedBefore), sent);
+
+    return 0;
+}
+
+static char const* SyscallName(uint64 number)
+{
+    switch (number)
+    {
+        case SYS_read:              return "read";
+        case SYS_write:             return "write";
+        case SYS_readv:             return "readv";
+        case SYS_writev:            return "writev";
+        case SYS_recvfrom:          return "recvfrom";
+        case SYS_sendto:            return "sendto";
+        case SYS_recvmsg:           return "recvmsg";
+        case SYS_sendmsg:           return "sendmsg";
+#ifdef SYS_epoll_wait
+        case SYS_epoll_wait:        return "epoll_wait";
+#endif
+        case SYS_epoll_pwait:       return "epoll_pwait";
+        case SYS_epoll_ctl:         return "epoll_ctl";
+        case SYS_io_uring_enter:    return "io_uring_enter";
+        case SYS_futex:             return "futex";
+        case SYS_ioctl:             return "ioctl";
+        case SYS_timerfd_settime:   return "timerfd_settime";
+        case SYS_clock_nanosleep:   return "clock_nanosleep";
+        case SYS_nanosleep:         return "nanosleep";
+        case SYS_clock_gettime:     return "clock_gettime";
+        case SYS_sched_yield:       return "sched_yield";
+        case SYS_mmap:              return "mmap";
+        case SYS_munmap:            return "munmap";
+        case SYS_mprotect:          return "mprotect";
+        case SYS_madvise:           return "madvise";
+        case SYS_brk:               return "brk";
+        default:                    return nullptr;
+    }
+}
+
+/// Count the system calls of the traced server and all its threads between its two getppid() calls
+static int CountSyscalls(pid_t server, NetBenchConfig const& config)
+{
+    int status;
+    if (waitpid(server, &status, 0) != server || !WIFSTOPPED(status))
+        return 1;
+
+    ptrace(PTRACE_SETOPTIONS, server, nullptr, PTRACE_O_TRACESYSGOOD | PTRACE_O_TRACECLONE | PTRACE_O_EXITKILL);
+    ptrace(PTRACE_SYSCALL, server, nullptr, nullptr);
+
+    std::map<uint64, uint64> counts;
+    bool measuring = false;
+    std::chrono::steady_clock::time_point start, end;
+
+    for (;;)
+    {
+        pid_t thread = waitpid(-1, &status, __WALL);
+        if (thread < 0)
+            break;
+
+        if (WIFEXITED(status) || WIFSIGNALED(status))
+        {
+            if (thread == server)
+                break;
+            continue;
+        }
+
+        int signal = WSTOPSIG(status);
+        if (signal == (SIGTRAP | 0x80))
+        {
+            __ptrace_syscall_info info;
+            if (ptrace(PTRACE_GET_SYSCALL_INFO, thread, sizeof(info), &info) > 0 && info.op == PTRACE_SYSCALL_INFO_ENTRY)
+            {
+                if (info.entry.nr == SYS_getppid)
+                {
+                    measuring = !measuring;
+                    (measuring ? start : end) = std::chrono::steady_clock::now();
+                }
+                else if (measuring)
+                    ++counts[info.entry.nr];
+            }
+            signal = 0;
+        }
+        // clone events and the stop new threads start with
+        else if (signal == SIGTRAP || signal == SIGSTOP)
+            signal = 0;
+
+        ptrace(PTRACE_SYSCALL, thread, nullptr, signal);
+    }
+
+    uint64 total = 0;
+    std::vector<std::pair<uint64, uint64> > sorted;
+    for (auto const& count : counts)
+    {
+        total += count.second;
+        sorted.emplace_back(count.second, count.first);
+    }
+    std::sort(sorted.rbegin(), sorted.rend());
+
+    double const seconds = std::chrono::duration<double>(end - start).count();
+    if (seconds <= 0.0)
+        return 1;
+
+    sLog.outString("  server system calls: " UI64FMTD ", %.0f per second and 1000 connections", total, total / seconds / (config.connections / 1000.0));
+    for (size_t i = 0; i < sorted.size() && i < 8; ++i)
+    {
+        char const* name = SyscallName(sorted[i].second);
+        sLog.outString("    %-16s %.0f per second and 1000 connections", name ? name : std::to_string(sorted[i].second).c_str(),
+                       sorted[i].first / seconds / (config.connections / 1000.0));
+    }
+
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    NetBenchConfig config;
+    std::string backend;
+
+    boost::program_options::options_description desc("Allowed options");
+    desc.add_options()
+    ("backend,b", boost::program_options::value<std::string>(&backend)->default_value("asio"), "asio or uring")
+    ("connections,n", boost::program_options::value<uint32>(&config.connections)->default_value(config.connections), "client connections")
+    ("threads,t", boost::program_options::value<uint32>(&config.threads)->default_value(config.threads), "network threads of the server")
+    ("port", boost::program_options::value<uint32>(&config.port)->default_value(config.port), "loopback port")
+    ("tick", boost::program_options::value<uint32>(&config.tick)->default_value(config.tick), "ms between two server flushes")
+    ("packets", boost::program_options::value<uint32>(&config.packets)->default_value(config.packets), "packets sent to every connection per tick")
+    ("packet-size", boost::program_options::value<uint32>(&config.packetSize)->default_value(config.packetSize), "bytes of a server packet")
+    ("send-interval", boost::program_options::value<uint32>(&config.sendInterval)->default_value(config.sendInterval), "ms between two packets of one client")
+    ("client-packet-size", boost::program_options::value<uint32>(&config.clientPacketSize)->default_value(config.clientPacketSize), "bytes of a client packet")
+    ("warmup,w", boost::program_options::value<uint32>(&config.warmup)->default_value(config.warmup), "seconds before measuring")
+    ("duration,d", boost::program_options::value<uint32>(&config.duration)->default_value(config.duration), "measured seconds")
+    ("syscalls", "count the system calls of the server, which slows it down")
+    ("help,h", "prints usage");
+
+    boost::program_options::variables_map vm;
+
+    try
+    {
+        boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc), vm);
+        boost::program_options::notify(vm);
+
+        if (vm.count("help"))
+        {
+            std::cout << desc << std::endl;
+            return 0;
+        }
+    }
+    catch (boost::program_options::error const& e)
+    {
+        std::cerr << "ERROR: " << e.what() << std::endl << std::endl;
+        std::cerr << desc << std::endl;
+
+        return 1;
+    }
+
+    if (backend != "asio" && backend != "uring")
+    {
+        std::cerr << "ERROR: unknown backend " << backend << std::endl;
+        return 1;
+    }
+
+    config.ioUring = backend == "uring";
+    config.syscalls = vm.count("syscalls") != 0;
+
+    pid_t clients = fork();
+    if (clients == 0)
+        _exit(RunClients(config));
+
+    int result;
+    if (config.syscalls)
+    {
+        pid_t server = fork();
+        if (server == 0)
+        {
+            ptrace(PTRACE_TRACEME, 0, nullptr, nullptr);
+            raise(SIGSTOP);
+            _exit(RunServer(config));
+        }
+
+        result = CountSyscalls(server, config);
+    }
+    else
+    {
+        result = RunServer(config);
+        fflush(stdout);
+    }
+
+    kill(clients, SIGTERM);
+    waitpid(clients, nullptr, 0);
+
+    // the server sockets are closed with the process
+    _exit(result);
+}
+
+/// @}
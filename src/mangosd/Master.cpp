@@ -221,6 +221,12 @@ int Master::Run()
             sLog.outError("Invalid network tread workers setting in mangosd.conf. (%d) should be > 0", networkThreadWorker);
             networkThreadWorker = 1;
         }
+        MaNGOS::Socket::SetFlushPolicy(sConfig.GetBoolDefault("Network.TickFlush", true), sConfig.GetIntDefault("Network.FlushSize", 16384),
+                                       sConfig.GetBoolDefault("Network.TcpNodelay", true));
+        MaNGOS::Socket::SetOutQueueLimits(sConfig.GetIntDefault("Network.OutQueue.HighWatermark", 262144), sConfig.GetIntDefault("Network.OutQueue.LowWatermark", 65536),
+                                          sConfig.GetIntDefault("Network.OutQueue.Limit", 16777216));
+        MaNGOS::IoUring::SetEnabled(sConfig.GetBoolDefault("Network.IoUring", false));
+
         MaNGOS::Listener<WorldSocket> listener(sConfig.GetStringDefault("BindIP", "0.0.0.0"), int32(sWorld.getConfig(CONFIG_UINT32_PORT_WORLD)), networkThreadWorker);
 
         std::unique_ptr<MaNGOS::Listener<RASocket>> raListener;
@@ -329,15 +335,16 @@ bool Master::_StartDB()
     ///- Get world database info from configuration file
     std::string dbstring = sConfig.GetStringDefault("WorldDatabaseInfo");
     int nConnections = sConfig.GetIntDefault("WorldDatabaseConnections", 1);
+    int nAsyncConnections = sConfig.GetIntDefault("WorldDatabaseAsyncConnections", 1);
     if (dbstring.empty())
     {
         sLog.outError("Database not specified in configuration file");
         return false;
     }
-    sLog.outString("World Database total connections: %i", nConnections + 1);
+    sLog.outString("World Database total connections: %i", nConnections + nAsyncConnections);
 
     ///- Initialise the world database
-    if (!WorldDatabase.Initialize(dbstring.c_str(), nConnections))
+    if (!WorldDatabase.Initialize(dbstring.c_str(), nConnections, nAsyncConnections))
     {
         sLog.outError("Cannot connect to world database %s", dbstring.c_str());
         return false;
@@ -352,6 +359,7 @@ bool Master::_StartDB()
 
     dbstring = sConfig.GetStringDefault("CharacterDatabaseInfo");
     nConnections = sConfig.GetIntDefault("CharacterDatabaseConnections", 1);
+    nAsyncConnections = sConfig.GetIntDefault("CharacterDatabaseAsyncConnections", 1);
     if (dbstring.empty())
     {
         sLog.outError("Character Database not specified in configuration file");
@@ -360,10 +368,10 @@ bool Master::_StartDB()
         WorldDatabase.HaltDelayThread();
         return false;
     }
-    sLog.outString("Character Database total connections: %i", nConnections + 1);
+    sLog.outString("Character Database total connections: %i", nConnections + nAsyncConnections);
 
     ///- Initialise the Character database
-    if (!CharacterDatabase.Initialize(dbstring.c_str(), nConnections))
+    if (!CharacterDatabase.Initialize(dbstring.c_str(), nConnections, nAsyncConnections))
     {
         sLog.outError("Cannot connect to Character database %s", dbstring.c_str());
 
@@ -383,6 +391,7 @@ bool Master::_StartDB()
     ///- Get login database info from configuration file
     dbstring = sConfig.GetStringDefault("LoginDatabaseInfo");
     nConnections = sConfig.GetIntDefault("LoginDatabaseConnections", 1);
+    nAsyncConnections = sConfig.GetIntDefault("LoginDatabaseAsyncConnections", 1);
     if (dbstring.empty())
     {
         sLog.outError("Login database not specified in configuration file");
@@ -394,8 +403,8 @@ bool Master::_StartDB()
     }
 
     ///- Initialise the login database
-    sLog.outString("Login Database total connections: %i", nConnections + 1);
-    if (!LoginDatabase.Initialize(dbstring.c_str(), nConnections))
+    sLog.outString("Login Database total connections: %i", nConnections + nAsyncConnections);
+    if (!LoginDatabase.Initialize(dbstring.c_str(), nConnections, nAsyncConnections))
     {
         sLog.outError("Cannot connect to login database %s", dbstring.c_str());
 
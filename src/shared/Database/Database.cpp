@@ -19,16 +19,54 @@
 #include "DatabaseEnv.h"
 #include "Config/Config.h"
 #include "Database/SqlOperations.h"
+#include "TSS.h"
 
 #include <ctime>
 #include <iostream>
 #include <fstream>
 #include <memory>
 #include <cstdarg>
+#include <algorithm>
+#include <chrono>
 
 #define MIN_CONNECTION_POOL_SIZE 1
 #define MAX_CONNECTION_POOL_SIZE 16
 
+// sync queries of one thread, taken by the thread itself for its tick stats
+struct SyncQueryStats
+{
+    uint64 count;
+    uint64 blockedTime;
+    uint32 maxBlockedTime;
+};
+
+static SyncQueryStats* initSyncQueryStats()
+{
+    return new SyncQueryStats();
+}
+
+static MaNGOS::thread_local_ptr<SyncQueryStats> syncQueryStats(&initSyncQueryStats);
+
+// adds the time from its creation to the sync query stats of the current thread
+class SyncQueryTimer
+{
+    public:
+        SyncQueryTimer() : m_start(std::chrono::steady_clock::now()) {}
+        ~SyncQueryTimer()
+        {
+            uint32 const elapsed = uint32(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count());
+
+            SyncQueryStats* stats = syncQueryStats.get();
+            ++stats->count;
+            stats->blockedTime += elapsed;
+            if (elapsed > stats->maxBlockedTime)
+                stats->maxBlockedTime = elapsed;
+        }
+
+    private:
+        std::chrono::steady_clock::time_point const m_start;
+};
+
 //////////////////////////////////////////////////////////////////////////
 SqlPreparedStatement* SqlConnection::CreateStatement(const std::string& fmt)
 {
@@ -91,13 +129,37 @@ bool SqlConnection::ExecuteStmt(int nIndex, const SqlStmtParameters& id)
     return pStmt->execute();
 }
 
+bool SqlConnection::IsMultiRowStmt(int nIndex)
+{
+    if (nIndex == -1)
+        return false;
+
+    return GetStmt(nIndex)->isMultiRowInsert();
+}
+
+bool SqlConnection::ExecuteStmtRows(int nIndex, const std::vector<const SqlStmtParameters*>& rows)
+{
+    if (rows.empty())
+        return true;
+
+    // a single row keeps using the prepared statement
+    if (rows.size() == 1)
+        return ExecuteStmt(nIndex, *rows.front());
+
+    SqlPreparedStatement* pStmt = GetStmt(nIndex);
+    if (!pStmt->isMultiRowInsert())
+        return false;
+
+    return pStmt->executeRows(rows);
+}
+
 //////////////////////////////////////////////////////////////////////////
 Database::~Database()
 {
     StopServer();
 }
 
-bool Database::Initialize(const char* infoString, int nConns /*= 1*/)
+bool Database::Initialize(const char* infoString, int nConns /*= 1*/, int nAsyncConns /*= 1*/)
 {
     // Enable logging of SQL commands (usually only GM commands)
     // (See method: PExecuteLog)
@@ -111,6 +173,10 @@ bool Database::Initialize(const char* infoString, int nConns /*= 1*/)
 
     m_pingIntervallms = sConfig.GetIntDefault("MaxPingTime", 30) * (MINUTE * 1000);
 
+    m_groupCommitWindowms = sConfig.GetIntDefault("AsyncGroupCommitWindow", 0);
+    m_groupCommitStatements = sConfig.GetIntDefault("AsyncGroupCommitStatements", 100);
+    m_binaryResults = sConfig.GetBoolDefault("BinaryQueryResults", false);
+
     // create DB connections
 
     // setup connection pool size
@@ -134,10 +200,21 @@ bool Database::Initialize(const char* infoString, int nConns /*= 1*/)
         m_pQueryConnections.push_back(pConn);
     }
 
-    // create and initialize connection for async requests
-    m_pAsyncConn = CreateConnection();
-    if (!m_pAsyncConn->Initialize(infoString))
-        return false;
+    // create and initialize connections for async requests
+    nAsyncConns = std::min(std::max(nAsyncConns, MIN_CONNECTION_POOL_SIZE), MAX_CONNECTION_POOL_SIZE);
+    for (int i = 0; i < nAsyncConns; ++i)
+    {
+        SqlConnection* pConn = CreateConnection();
+        if (!pConn->Initialize(infoString))
+        {
+            delete pConn;
+            return false;
+        }
+
+        m_pAsyncConnections.push_back(pConn);
+    }
+
+    m_pAsyncConn = m_pAsyncConnections.front();
 
     m_pResultQueue = new SqlResultQueue;
 
@@ -150,10 +227,12 @@ void Database::StopServer()
     HaltDelayThread();
 
     delete m_pResultQueue;
-    delete m_pAsyncConn;
+    for (auto& m_pAsyncConnection : m_pAsyncConnections)
+        delete m_pAsyncConnection;
 
     m_pResultQueue = nullptr;
     m_pAsyncConn = nullptr;
+    m_pAsyncConnections.clear();
 
     for (auto& m_pQueryConnection : m_pQueryConnections)
         delete m_pQueryConnection;
@@ -161,30 +240,81 @@ void Database::StopServer()
     m_pQueryConnections.clear();
 }
 
-SqlDelayThread* Database::CreateDelayThread()
+SqlDelayThread* Database::CreateDelayThread(SqlConnection* conn)
 {
-    assert(m_pAsyncConn);
-    return new SqlDelayThread(this, m_pAsyncConn);
+    assert(conn);
+    return new SqlDelayThread(this, conn);
 }
 
 void Database::InitDelayThread()
 {
-    assert(!m_delayThread);
+    assert(m_delayThreads.empty());
 
-    // New delay thread for delay execute
-    m_threadBody = CreateDelayThread();              // will deleted at m_delayThread delete
-    m_delayThread = new MaNGOS::Thread(m_threadBody);
+    // New delay thread for delay execute, one per async connection
+    for (auto& m_pAsyncConnection : m_pAsyncConnections)
+    {
+        SqlDelayThread* threadBody = CreateDelayThread(m_pAsyncConnection);   // will deleted at thread delete
+        m_threadBodies.push_back(threadBody);
+        m_delayThreads.push_back(new MaNGOS::Thread(threadBody));
+    }
+
+    m_asyncStopped = false;
 }
 
 void Database::HaltDelayThread()
 {
-    if (!m_threadBody || !m_delayThread) return;
+    if (m_threadBodies.empty() || m_delayThreads.empty()) return;
+
+    {
+        // requests queued from now on go to the first worker and run serially once all workers ended
+        std::lock_guard<std::mutex> guard(m_asyncLock);
+        for (auto& threadBody : m_threadBodies)
+            threadBody->Stop();                             // Stop event
+        m_asyncStopped = true;
+    }
+
+    for (auto& delayThread : m_delayThreads)
+        delayThread->wait();                                // Wait for flush to DB
+
+    for (auto& delayThread : m_delayThreads)
+        delete delayThread;                                 // This also deletes the thread body
+
+    m_delayThreads.clear();
+    m_threadBodies.clear();
+}
+
+bool Database::DelayAsync(SqlOperation* operation, uint32 orderKey)
+{
+    size_t const workers = m_threadBodies.size();
+    if (!workers)
+    {
+        delete operation;
+        return false;
+    }
+
+    if (workers == 1)
+        return m_threadBodies.front()->Delay(operation);
+
+    std::lock_guard<std::mutex> guard(m_asyncLock);
+
+    if (m_asyncStopped)
+        return m_threadBodies.front()->Delay(operation);
+
+    if (orderKey)
+        return m_threadBodies[orderKey % workers]->Delay(operation);
+
+    std::shared_ptr<SqlBarrier> barrier = std::make_shared<SqlBarrier>(operation, uint32(workers - 1));
+    for (size_t i = 0; i < workers; ++i)
+        m_threadBodies[i]->Delay(new SqlBarrierStep(barrier, i == 0));
+
+    return true;
+}
 
-    m_threadBody->Stop();                                   // Stop event
-    m_delayThread->wait();                                  // Wait for flush to DB
-    delete m_delayThread;                                   // This also deletes m_threadBody
-    m_delayThread = nullptr;
-    m_threadBody = nullptr;
+void Database::TakeAsyncStats(std::vector<SqlDelayStats>& stats)
+{
+    stats.resize(m_threadBodies.size());
+    for (size_t i = 0; i < m_threadBodies.size(); ++i)
+        m_threadBodies[i]->TakeStats(stats[i]);
 }
 
 void Database::ThreadStart()
@@ -201,6 +331,23 @@ void Database::ProcessResultQueue()
         m_pResultQueue->Update();
 }
 
+void Database::TakeResultStats(uint64& count, uint32& averageLatency, uint32& maxLatency)
+{
+    if (m_pResultQueue)
+        m_pResultQueue->TakeStats(count, averageLatency, maxLatency);
+    else
+        count = averageLatency = maxLatency = 0;
+}
+
+void Database::TakeSyncQueryStats(uint64& count, uint64& blockedTime, uint32& maxBlockedTime)
+{
+    SyncQueryStats* stats = syncQueryStats.get();
+    count = stats->count;
+    blockedTime = stats->blockedTime;
+    maxBlockedTime = stats->maxBlockedTime;
+    *stats = SyncQueryStats();
+}
+
 void Database::escape_string(std::string& str)
 {
     if (str.empty())
@@ -229,8 +376,9 @@ void Database::Ping()
 {
     const char* sql = "SELECT 1";
 
+    for (auto& m_pAsyncConnection : m_pAsyncConnections)
     {
-        SqlConnection::Lock guard(m_pAsyncConn);
+        SqlConnection::Lock guard(m_pAsyncConnection);
         delete guard->Query(sql);
     }
 
@@ -283,6 +431,22 @@ bool Database::PExecuteLog(const char* format, ...)
     return Execute(szQuery);
 }
 
+QueryResult* Database::Query(const char* sql)
+{
+    SyncQueryTimer timer;
+
+    SqlConnection::Lock guard(getQueryConnection());
+    return guard->Query(sql);
+}
+
+QueryNamedResult* Database::QueryNamed(const char* sql)
+{
+    SyncQueryTimer timer;
+
+    SqlConnection::Lock guard(getQueryConnection());
+    return guard->QueryNamed(sql);
+}
+
 QueryResult* Database::PQuery(const char* format, ...)
 {
     if (!format) return nullptr;
@@ -321,6 +485,57 @@ QueryNamedResult* Database::PQueryNamed(const char* format, ...)
     return QueryNamed(szQuery);
 }
 
+bool Database::AsyncQuery(SqlQueryContinuation::Function const& function, const char* sql, std::shared_ptr<SqlResultQueue> const& queue)
+{
+    if (!sql || !m_pResultQueue)
+        return false;
+
+    if (queue)
+        return DelayAsync(new SqlQuery(sql, new SqlQueryContinuation(function), queue), 0);
+
+    return DelayAsync(new SqlQuery(sql, new SqlQueryContinuation(function), m_pResultQueue), 0);
+}
+
+bool Database::AsyncPQuery(SqlQueryContinuation::Function const& function, const char* format, ...)
+{
+    if (!format)
+        return false;
+
+    va_list ap;
+    char szQuery [MAX_QUERY_LEN];
+    va_start(ap, format);
+    int res = vsnprintf(szQuery, MAX_QUERY_LEN, format, ap);
+    va_end(ap);
+
+    if (res == -1)
+    {
+        sLog.outError("SQL Query truncated (and not execute) for format: %s", format);
+        return false;
+    }
+
+    return AsyncQuery(function, szQuery);
+}
+
+bool Database::AsyncPQuery(std::shared_ptr<SqlResultQueue> const& queue, SqlQueryContinuation::Function const& function, const char* format, ...)
+{
+    if (!format)
+        return false;
+
+    va_list ap;
+    char szQuery [MAX_QUERY_LEN];
+    va_start(ap, format);
+    int res = vsnprintf(szQuery, MAX_QUERY_LEN, format, ap);
+    va_end(ap);
+
+    if (res == -1)
+    {
+        sLog.outError("SQL Query truncated (and not execute) for format: %s", format);
+        return false;
+    }
+
+    return AsyncQuery(function, szQuery, queue);
+}
+
 bool Database::Execute(const char* sql)
 {
     if (!m_pAsyncConn)
@@ -339,7 +554,7 @@ bool Database::Execute(const char* sql)
             return DirectExecute(sql);
 
         // Simple sql statement
-        m_threadBody->Delay(new SqlPlainRequest(sql));
+        DelayAsync(new SqlPlainRequest(sql), 0);
     }
 
     return true;
@@ -385,7 +600,7 @@ bool Database::DirectPExecute(const char* format, ...)
     return DirectExecute(szQuery);
 }
 
-bool Database::BeginTransaction()
+bool Database::BeginTransaction(uint32 orderKey /*= 0*/)
 {
     if (!m_pAsyncConn)
         return false;
@@ -393,7 +608,7 @@ bool Database::BeginTransaction()
     MANGOS_ASSERT(!m_currentTransaction.get());   // if we will get a nested transaction request - we MUST fix code!!!
 
     if (!m_currentTransaction.get())
-        m_currentTransaction.reset(new SqlTransaction);
+        m_currentTransaction.reset(new SqlTransaction(orderKey));
 
     return m_currentTransaction.get() != nullptr;
 }
@@ -408,8 +623,8 @@ bool Database::CommitTransaction()
         return CommitTransactionDirect();
 
     // add SqlTransaction to the async queue
-    m_threadBody->Delay(m_currentTransaction.release());
-    return true;
+    SqlTransaction* pTrans = m_currentTransaction.release();
+    return DelayAsync(pTrans, pTrans->GetOrderKey());
 }
 
 bool Database::CommitTransactionDirect()
@@ -563,7 +778,7 @@ bool Database::ExecuteStmt(const SqlStatementID& id, SqlStmtParameters* params)
             return DirectExecuteStmt(id, params);
 
         // Simple sql statement
-        m_threadBody->Delay(new SqlPreparedRequest(id.ID(), params));
+        DelayAsync(new SqlPreparedRequest(id.ID(), params), 0);
     }
 
     return true;
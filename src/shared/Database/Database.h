@@ -60,9 +60,15 @@ class SqlConnection
         virtual bool CommitTransaction() { return true; }
         // can't rollback without transaction support
         virtual bool RollbackTransaction() { return true; }
+        // the last failed request lost a lock conflict (deadlock, lock wait timeout), the server rolled it back
+        // and nothing of the transaction can have been committed
+        virtual bool IsLockConflictError() const { return false; }
 
         // methods to work with prepared statements
         bool ExecuteStmt(int nIndex, const SqlStmtParameters& id);
+        // prepared INSERT which can take several parameter sets in one request
+        bool IsMultiRowStmt(int nIndex);
+        bool ExecuteStmtRows(int nIndex, const std::vector<const SqlStmtParameters*>& rows);
 
         // SqlConnection object lock
         class Lock
@@ -104,24 +110,15 @@ class Database
     public:
         virtual ~Database();
 
-        virtual bool Initialize(const char* infoString, int nConns = 1);
-        // start worker thread for async DB request execution
+        virtual bool Initialize(const char* infoString, int nConns = 1, int nAsyncConns = 1);
+        // start worker threads for async DB request execution
         virtual void InitDelayThread();
-        // stop worker thread
+        // stop worker threads
         virtual void HaltDelayThread();
 
-        /// Synchronous DB queries
-        inline QueryResult* Query(const char* sql)
-        {
-            SqlConnection::Lock guard(getQueryConnection());
-            return guard->Query(sql);
-        }
-
-        inline QueryNamedResult* QueryNamed(const char* sql)
-        {
-            SqlConnection::Lock guard(getQueryConnection());
-            return guard->QueryNamed(sql);
-        }
+        /// Synchronous DB queries, the calling thread is blocked until the result arrives
+        QueryResult* Query(const char* sql);
+        QueryNamedResult* QueryNamed(const char* sql);
 
         QueryResult* PQuery(const char* format, ...) ATTR_PRINTF(2, 3);
         QueryNamedResult* PQueryNamed(const char* format, ...) ATTR_PRINTF(2, 3);
@@ -171,6 +168,11 @@ class Database
         bool AsyncPQuery(void (*method)(QueryResult*, ParamType1, ParamType2), ParamType1 param1, ParamType2 param2, const char* format, ...) ATTR_PRINTF(5, 6);
         template<typename ParamType1, typename ParamType2, typename ParamType3>
         bool AsyncPQuery(void (*method)(QueryResult*, ParamType1, ParamType2, ParamType3), ParamType1 param1, ParamType2 param2, ParamType3 param3, const char* format, ...) ATTR_PRINTF(6, 7);
+        // Query / continuation, the function runs with the result when the queue is updated
+        // without a queue the result is delivered by ProcessResultQueue on the world thread
+        bool AsyncQuery(SqlQueryContinuation::Function const& function, const char* sql, std::shared_ptr<SqlResultQueue> const& queue = std::shared_ptr<SqlResultQueue>());
+        bool AsyncPQuery(SqlQueryContinuation::Function const& function, const char* format, ...) ATTR_PRINTF(3, 4);
+        bool AsyncPQuery(std::shared_ptr<SqlResultQueue> const& queue, SqlQueryContinuation::Function const& function, const char* format, ...) ATTR_PRINTF(4, 5);
         template<class Class>
         // QueryHolder
         bool DelayQueryHolder(Class* object, void (Class::*method)(QueryResult*, SqlQueryHolder*), SqlQueryHolder* holder);
@@ -183,7 +185,9 @@ class Database
         // Writes SQL commands to a LOG file (see mangosd.conf "LogSQL")
         bool PExecuteLog(const char* format, ...) ATTR_PRINTF(2, 3);
 
-        bool BeginTransaction();
+        // transactions with an ordering key stay in order with async requests of the same key only and may run
+        // in parallel to other keys, so they must not touch data owned by another key (character guid, account id)
+        bool BeginTransaction(uint32 orderKey = 0);
         bool CommitTransaction();
         bool RollbackTransaction();
         // for sync transaction execution
@@ -209,8 +213,25 @@ class Database
         // set database-wide result queue. also we should use object-bases and not thread-based result queues
         void ProcessResultQueue();
 
+        // put an async request to the worker of its ordering key, 0 orders it with all requests: with more than
+        // one worker it waits until every worker finished what was queued before it, and they wait for it
+        bool DelayAsync(SqlOperation* operation, uint32 orderKey);
+        // queue depth and latency of every async worker
+        void TakeAsyncStats(std::vector<SqlDelayStats>& stats);
+        // async query results delivered by ProcessResultQueue and their latency from queuing the query, in microseconds
+        void TakeResultStats(uint64& count, uint32& averageLatency, uint32& maxLatency);
+        // sync queries of the calling thread since its last call and the time it was blocked by them, in microseconds
+        static void TakeSyncQueryStats(uint64& count, uint64& blockedTime, uint32& maxBlockedTime);
+
         bool CheckRequiredField(char const* table_name, char const* required_name);
         uint32 GetPingIntervall() const { return m_pingIntervallms; }
+        // how long async writes may wait for more writes to share their commit, and how many may share one
+        uint32 GetGroupCommitWindow() const { return m_groupCommitWindowms; }
+        uint32 GetGroupCommitStatements() const { return m_groupCommitStatements; }
+
+        // fetch query results with the binary protocol of the backend, numeric fields then need no text conversion
+        bool UseBinaryResults() const { return m_binaryResults; }
+        void SetBinaryResults(bool binaryResults) { m_binaryResults = binaryResults; }
 
         // function to ping database connections
         void Ping();
@@ -223,8 +244,9 @@ class Database
     protected:
         Database() :
             m_nQueryConnPoolSize(1), m_pAsyncConn(nullptr), m_pResultQueue(nullptr),
-            m_threadBody(nullptr), m_delayThread(nullptr), m_bAllowAsyncTransactions(false),
-            m_iStmtIndex(-1), m_logSQL(false), m_pingIntervallms(0)
+            m_asyncStopped(false), m_bAllowAsyncTransactions(false),
+            m_iStmtIndex(-1), m_logSQL(false), m_pingIntervallms(0),
+            m_groupCommitWindowms(0), m_groupCommitStatements(0), m_binaryResults(false)
         {
             m_nQueryCounter = -1;
         }
@@ -234,7 +256,7 @@ class Database
         // factory method to create SqlConnection objects
         virtual SqlConnection* CreateConnection() = 0;
         // factory method to create SqlDelayThread objects
-        virtual SqlDelayThread* CreateDelayThread();
+        virtual SqlDelayThread* CreateDelayThread(SqlConnection* conn);
 
         // per-thread based storage for SqlTransaction object initialization - no locking is required
         boost::thread_specific_ptr<SqlTransaction> m_currentTransaction;
@@ -260,12 +282,16 @@ class Database
         typedef std::vector< SqlConnection* > SqlConnectionContainer;
         SqlConnectionContainer m_pQueryConnections;
 
-        // only one single DB connection for transactions
+        // one connection per async worker, the first one also for direct transactions
+        SqlConnectionContainer m_pAsyncConnections;
         SqlConnection* m_pAsyncConn;
 
         SqlResultQueue*     m_pResultQueue;                 ///< Transaction queues from diff. threads
-        SqlDelayThread*     m_threadBody;                   ///< Pointer to delay sql executer (owned by m_delayThread)
-        MaNGOS::Thread*     m_delayThread;                  ///< Pointer to executer thread
+        std::vector<SqlDelayThread*> m_threadBodies;        ///< Delay sql executers (owned by m_delayThreads)
+        std::vector<MaNGOS::Thread*> m_delayThreads;        ///< Executer threads
+
+        std::mutex m_asyncLock;                             ///< barriers must reach all workers in the same order
+        bool m_asyncStopped;                                ///< workers stopped, remaining requests run serially
 
         bool m_bAllowAsyncTransactions;                     ///< flag which specifies if async transactions are enabled
 
@@ -285,5 +311,8 @@ class Database
         bool m_logSQL;
         std::string m_logsDir;
         uint32 m_pingIntervallms;
+        uint32 m_groupCommitWindowms;
+        uint32 m_groupCommitStatements;
+        std::atomic<bool> m_binaryResults;
 };
 #endif
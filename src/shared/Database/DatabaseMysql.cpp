@@ -204,8 +204,72 @@ bool MySQLConnection::_Query(const char* sql, MYSQL_RES** pResult, MYSQL_FIELD**
     return true;
 }
 
+bool MySQLConnection::_QueryStmt(const char* sql, QueryResultMysqlStmt** pResult, QueryFieldNames* pNames)
+{
+    *pResult = nullptr;
+
+    if (!mMysql)
+        return false;
+
+    uint32 _s = WorldTimer::getMSTime();
+
+    MYSQL_STMT* stmt = mysql_stmt_init(mMysql);
+    if (!stmt)
+        return false;
+
+    // anything not returning rows or with '?' placeholders is left to the text protocol, also for error reporting
+    if (mysql_stmt_prepare(stmt, sql, strlen(sql)) || !mysql_stmt_field_count(stmt) || mysql_stmt_param_count(stmt))
+    {
+        mysql_stmt_close(stmt);
+        return false;
+    }
+
+    // buffers of text columns are sized by the longest value of the result
+    my_bool updateMaxLength = 1;
+    mysql_stmt_attr_set(stmt, STMT_ATTR_UPDATE_MAX_LENGTH, &updateMaxLength);
+
+    if (mysql_stmt_execute(stmt) || mysql_stmt_store_result(stmt))
+    {
+        sLog.outErrorDb("SQL: %s", sql);
+        sLog.outErrorDb("query ERROR: %s", mysql_stmt_error(stmt));
+        mysql_stmt_close(stmt);
+        return true;
+    }
+    DEBUG_FILTER_LOG(LOG_FILTER_SQL_TEXT, "[%u ms] SQL: %s", WorldTimer::getMSTimeDiff(_s, WorldTimer::getMSTime()), sql);
+
+    uint64 rowCount = mysql_stmt_num_rows(stmt);
+    uint32 fieldCount = mysql_stmt_field_count(stmt);
+    MYSQL_RES* metadata = rowCount ? mysql_stmt_result_metadata(stmt) : nullptr;
+    if (!metadata)
+    {
+        mysql_stmt_free_result(stmt);
+        mysql_stmt_close(stmt);
+        return true;
+    }
+
+    MYSQL_FIELD* fields = mysql_fetch_fields(metadata);
+    if (pNames)
+    {
+        pNames->resize(fieldCount);
+        for (uint32 i = 0; i < fieldCount; ++i)
+            (*pNames)[i] = fields[i].name;
+    }
+
+    *pResult = new QueryResultMysqlStmt(stmt, fields, rowCount, fieldCount);
+    mysql_free_result(metadata);
+    return true;
+}
+
 QueryResult* MySQLConnection::Query(const char* sql)
 {
+    QueryResultMysqlStmt* stmtResult;
+    if (m_db.UseBinaryResults() && _QueryStmt(sql, &stmtResult, nullptr))
+    {
+        if (stmtResult)
+            stmtResult->NextRow();
+        return stmtResult;
+    }
+
     MYSQL_RES* result = nullptr;
     MYSQL_FIELD* fields = nullptr;
     uint64 rowCount = 0;
@@ -222,6 +286,17 @@ QueryResult* MySQLConnection::Query(const char* sql)
 
 QueryNamedResult* MySQLConnection::QueryNamed(const char* sql)
 {
+    QueryResultMysqlStmt* stmtResult;
+    QueryFieldNames stmtNames;
+    if (m_db.UseBinaryResults() && _QueryStmt(sql, &stmtResult, &stmtNames))
+    {
+        if (!stmtResult)
+            return nullptr;
+
+        stmtResult->NextRow();
+        return new QueryNamedResult(stmtResult, stmtNames);
+    }
+
     MYSQL_RES* result = nullptr;
     MYSQL_FIELD* fields = nullptr;
     uint64 rowCount = 0;
@@ -288,6 +363,16 @@ bool MySQLConnection::RollbackTransaction()
     return _TransactionCmd("ROLLBACK");
 }
 
+bool MySQLConnection::IsLockConflictError() const
+{
+    if (!mMysql)
+        return false;
+
+    // prepared statements report their errors on the connection as well
+    unsigned int error = mysql_errno(mMysql);
+    return error == ER_LOCK_DEADLOCK || error == ER_LOCK_WAIT_TIMEOUT;
+}
+
 unsigned long MySQLConnection::escape_string(char* to, const char* from, unsigned long length)
 {
     if (!mMysql || !to || !from || !length)
@@ -26,6 +26,9 @@
 #include "Policies/Singleton.h"
 
 #include <mysql.h>
+#include <mysqld_error.h>
+
+class QueryResultMysqlStmt;
 
 // MySQL prepared statement class
 class MySqlPreparedStatement : public SqlPreparedStatement
@@ -78,6 +81,7 @@ class MySQLConnection : public SqlConnection
         bool BeginTransaction() override;
         bool CommitTransaction() override;
         bool RollbackTransaction() override;
+        bool IsLockConflictError() const override;
 
     protected:
         SqlPreparedStatement* CreateStatement(const std::string& fmt) override;
@@ -85,6 +89,8 @@ class MySQLConnection : public SqlConnection
     private:
         bool _TransactionCmd(const char* sql);
         bool _Query(const char* sql, MYSQL_RES** pResult, MYSQL_FIELD** pFields, uint64* pRowCount, uint32* pFieldCount);
+        // query by the binary protocol, false if it can not run as prepared statement
+        bool _QueryStmt(const char* sql, QueryResultMysqlStmt** pResult, QueryFieldNames* pNames);
 
         MYSQL* mMysql;
 };
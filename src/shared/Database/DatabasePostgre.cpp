@@ -97,17 +97,38 @@ bool PostgreSQLConnection::Initialize(const char* infoString)
     return true;
 }
 
-bool PostgreSQLConnection::_Query(const char* sql, PGresult** pResult, uint64* pRowCount, uint32* pFieldCount)
+// deadlock_detected, lock_not_available and serialization_failure abort the whole transaction
+static bool IsLockConflict(PGresult const* res)
+{
+    char const* state = res ? PQresultErrorField(res, PG_DIAG_SQLSTATE) : nullptr;
+    return state && (!strcmp(state, "40P01") || !strcmp(state, "55P03") || !strcmp(state, "40001"));
+}
+
+bool PostgreSQLConnection::_Query(const char* sql, PGresult** pResult, uint64* pRowCount, uint32* pFieldCount, bool& binary)
 {
     if (!mPGconn)
         return false;
 
     uint32 _s = WorldTimer::getMSTime();
     // Send the query
-    *pResult = PQexec(mPGconn, sql);
+    *pResult = binary ? PQexecParams(mPGconn, sql, 0, nullptr, nullptr, nullptr, nullptr, 1) : PQexec(mPGconn, sql);
     if (!*pResult)
         return false;
 
+    // columns without native representation, like dates, need the text result
+    if (binary && PQresultStatus(*pResult) == PGRES_TUPLES_OK)
+    {
+        for (int i = 0; i < PQnfields(*pResult); ++i)
+        {
+            if (!QueryResultPostgre::IsBinarySupported(PQftype(*pResult, i)))
+            {
+                PQclear(*pResult);
+                binary = false;
+                return _Query(sql, pResult, pRowCount, pFieldCount, binary);
+            }
+        }
+    }
+
     if (PQresultStatus(*pResult) != PGRES_TUPLES_OK)
     {
         sLog.outErrorDb("SQL : %s", sql);
@@ -141,11 +162,12 @@ QueryResult* PostgreSQLConnection::Query(const char* sql)
     PGresult* result = nullptr;
     uint64 rowCount = 0;
     uint32 fieldCount = 0;
+    bool binary = m_db.UseBinaryResults();
 
-    if (!_Query(sql, &result, &rowCount, &fieldCount))
+    if (!_Query(sql, &result, &rowCount, &fieldCount, binary))
         return nullptr;
 
-    QueryResultPostgre* queryResult = new QueryResultPostgre(result, rowCount, fieldCount);
+    QueryResultPostgre* queryResult = new QueryResultPostgre(result, rowCount, fieldCount, binary);
 
     queryResult->NextRow();
     return queryResult;
@@ -159,15 +181,16 @@ QueryNamedResult* PostgreSQLConnection::QueryNamed(const char* sql)
     PGresult* result = nullptr;
     uint64 rowCount = 0;
     uint32 fieldCount = 0;
+    bool binary = m_db.UseBinaryResults();
 
-    if (!_Query(sql, &result, &rowCount, &fieldCount))
+    if (!_Query(sql, &result, &rowCount, &fieldCount, binary))
         return nullptr;
 
     QueryFieldNames names(fieldCount);
     for (uint32 i = 0; i < fieldCount; ++i)
         names[i] = PQfname(result, i);
 
-    QueryResultPostgre* queryResult = new QueryResultPostgre(result, rowCount, fieldCount);
+    QueryResultPostgre* queryResult = new QueryResultPostgre(result, rowCount, fieldCount, binary);
 
     queryResult->NextRow();
     return new QueryNamedResult(queryResult, names);
@@ -185,6 +208,8 @@ bool PostgreSQLConnection::Execute(const char* sql)
     {
         sLog.outErrorDb("SQL: %s", sql);
         sLog.outErrorDb("SQL %s", PQerrorMessage(mPGconn));
+        m_lockConflict = IsLockConflict(res);
+        PQclear(res);
         return false;
     }
     else
@@ -206,12 +231,16 @@ bool PostgreSQLConnection::_TransactionCmd(const char* sql)
     {
         sLog.outError("SQL: %s", sql);
         sLog.outError("SQL ERROR: %s", PQerrorMessage(mPGconn));
+        m_lockConflict = IsLockConflict(res);
+        PQclear(res);
         return false;
     }
     else
     {
         DEBUG_LOG("SQL: %s", sql);
     }
+
+    PQclear(res);
     return true;
 }
 
@@ -35,7 +35,7 @@
 class PostgreSQLConnection : public SqlConnection
 {
     public:
-        PostgreSQLConnection(Database& db) : SqlConnection(db), mPGconn(nullptr) {}
+        PostgreSQLConnection(Database& db) : SqlConnection(db), mPGconn(nullptr), m_lockConflict(false) {}
         ~PostgreSQLConnection();
 
         bool Initialize(const char* infoString) override;
@@ -49,12 +49,15 @@ class PostgreSQLConnection : public SqlConnection
         bool BeginTransaction() override;
         bool CommitTransaction() override;
         bool RollbackTransaction() override;
+        bool IsLockConflictError() const override { return m_lockConflict; }
 
     private:
         bool _TransactionCmd(const char* sql);
-        bool _Query(const char* sql, PGresult** pResult, uint64* pRowCount, uint32* pFieldCount) override;
+        // binary is cleared when the result had to be requested as text
+        bool _Query(const char* sql, PGresult** pResult, uint64* pRowCount, uint32* pFieldCount, bool& binary);
 
         PGconn* mPGconn;
+        bool m_lockConflict;                                // set by the last failed request
 };
 
 class DatabasePostgre : public Database
@@ -16,4 +16,35 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
-//#include "DatabaseEnv.h"
+#include "DatabaseEnv.h"
+
+#include <limits>
+
+static float ReadReal(char const* text, float) { return strtof(text, nullptr); }
+static double ReadReal(char const* text, double) { return strtod(text, nullptr); }
+
+// shortest text that reads back to the same value, like the text protocol sends it
+template<typename T>
+static void FormatShortest(char* text, size_t size, T value)
+{
+    for (int precision = 1; precision < std::numeric_limits<T>::max_digits10; ++precision)
+    {
+        snprintf(text, size, "%.*g", precision, double(value));
+        if (ReadReal(text, value) == value)
+            return;
+    }
+
+    snprintf(text, size, "%.*g", std::numeric_limits<T>::max_digits10, double(value));
+}
+
+void Field::FormatNative() const
+{
+    switch (mNative)
+    {
+        case NATIVE_INT:    snprintf(mText, sizeof(mText), SI64FMTD, mNumber.i);    break;
+        case NATIVE_UINT:   snprintf(mText, sizeof(mText), UI64FMTD, mNumber.u);    break;
+        case NATIVE_FLOAT:  FormatShortest(mText, sizeof(mText), float(mNumber.d)); break;
+        case NATIVE_DOUBLE: FormatShortest(mText, sizeof(mText), mNumber.d);        break;
+        default:                                                                    break;
+    }
+}
@@ -34,8 +34,8 @@ class Field
             DB_TYPE_BOOL    = 0x04
         };
 
-        Field() : mValue(nullptr), mType(DB_TYPE_UNKNOWN) {}
-        Field(const char* value, enum DataTypes type) : mValue(value), mType(type) {}
+        Field() : mValue(nullptr), mType(DB_TYPE_UNKNOWN), mNative(NATIVE_NONE) {}
+        Field(const char* value, enum DataTypes type) : mValue(value), mType(type), mNative(NATIVE_NONE) {}
 
         ~Field() {}
 
@@ -44,21 +44,26 @@ class Field
 
         const char* GetString() const
         {
+            if (mNative != NATIVE_NONE && mValue && !mText[0])
+                FormatNative();
             return mValue ? mValue : ""; // We need this null check as we do not always null check what we get back from the database everywhere
         }
         std::string GetCppString() const
         {
-            return mValue ? mValue : "";                    // std::string s = 0 have undefine result in C++
+            return GetString();                             // std::string s = 0 have undefine result in C++
         }
-        float GetFloat() const { return mValue ? static_cast<float>(atof(mValue)) : 0.0f; }
-        bool GetBool() const { return mValue ? atoi(mValue) > 0 : false; }
-        int32 GetInt32() const { return mValue ? static_cast<int32>(atol(mValue)) : int32(0); }
-        uint8 GetUInt8() const { return mValue ? static_cast<uint8>(atol(mValue)) : uint8(0); }
-        uint16 GetUInt16() const { return mValue ? static_cast<uint16>(atol(mValue)) : uint16(0); }
-        int16 GetInt16() const { return mValue ? static_cast<int16>(atol(mValue)) : int16(0); }
-        uint32 GetUInt32() const { return mValue ? static_cast<uint32>(atoll(mValue)) : uint32(0); }
+        float GetFloat() const { return mValue ? static_cast<float>(mNative ? GetNativeDouble() : atof(mValue)) : 0.0f; }
+        bool GetBool() const { return mValue ? (mNative ? GetNativeInt() > 0 : atoi(mValue) > 0) : false; }
+        int32 GetInt32() const { return mValue ? static_cast<int32>(mNative ? GetNativeInt() : atol(mValue)) : int32(0); }
+        uint8 GetUInt8() const { return mValue ? static_cast<uint8>(mNative ? GetNativeInt() : atol(mValue)) : uint8(0); }
+        uint16 GetUInt16() const { return mValue ? static_cast<uint16>(mNative ? GetNativeInt() : atol(mValue)) : uint16(0); }
+        int16 GetInt16() const { return mValue ? static_cast<int16>(mNative ? GetNativeInt() : atol(mValue)) : int16(0); }
+        uint32 GetUInt32() const { return mValue ? static_cast<uint32>(mNative ? GetNativeInt() : atoll(mValue)) : uint32(0); }
         uint64 GetUInt64() const
         {
+            if (mValue && mNative)
+                return mNative == NATIVE_UINT ? mNumber.u : static_cast<uint64>(GetNativeInt());
+
             uint64 value = 0;
             if (!mValue || sscanf(mValue, UI64FMTD, &value) == -1)
                 return 0;
@@ -69,13 +74,62 @@ class Field
         void SetType(enum DataTypes type) { mType = type; }
         // no need for memory allocations to store resultset field strings
         // all we need is to cache pointers returned by different DBMS APIs
-        void SetValue(const char* value) { mValue = value; }
+        void SetValue(const char* value) { mValue = value; mNative = NATIVE_NONE; }
+
+        // values of binary result sets, read without text conversion and only formatted when asked for as string
+        void SetInt(int64 value) { mNumber.i = value; SetNative(NATIVE_INT); }
+        void SetUInt(uint64 value) { mNumber.u = value; SetNative(NATIVE_UINT); }
+        void SetFloat(float value) { mNumber.d = value; SetNative(NATIVE_FLOAT); }
+        void SetDouble(double value) { mNumber.d = value; SetNative(NATIVE_DOUBLE); }
+        void SetNull() { mValue = nullptr; mNative = NATIVE_NONE; }
 
     private:
         Field(Field const&);
         Field& operator=(Field const&);
 
+        enum NativeTypes
+        {
+            NATIVE_NONE     = 0,                            // text value of mValue
+            NATIVE_INT,
+            NATIVE_UINT,
+            NATIVE_FLOAT,                                   // kept in mNumber.d, formatted with float precision
+            NATIVE_DOUBLE
+        };
+
+        void SetNative(NativeTypes type) { mNative = type; mText[0] = '\0'; mValue = mText; }
+
+        int64 GetNativeInt() const
+        {
+            switch (mNative)
+            {
+                case NATIVE_UINT:   return static_cast<int64>(mNumber.u);
+                case NATIVE_FLOAT:
+                case NATIVE_DOUBLE: return static_cast<int64>(mNumber.d);
+                default:            return mNumber.i;
+            }
+        }
+
+        double GetNativeDouble() const
+        {
+            switch (mNative)
+            {
+                case NATIVE_INT:    return static_cast<double>(mNumber.i);
+                case NATIVE_UINT:   return static_cast<double>(mNumber.u);
+                default:            return mNumber.d;
+            }
+        }
+
+        void FormatNative() const;
+
         const char* mValue;
         enum DataTypes mType;
+        NativeTypes mNative;
+        union
+        {
+            int64 i;
+            uint64 u;
+            double d;
+        } mNumber;
+        mutable char mText[32];                             // mValue of native values once formatted
 };
 #endif
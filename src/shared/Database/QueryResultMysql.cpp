@@ -67,7 +67,7 @@ void QueryResultMysql::EndQuery()
     }
 }
 
-enum Field::DataTypes QueryResultMysql::ConvertNativeType(enum_field_types mysqlType) const
+enum Field::DataTypes QueryResultMysql::ConvertNativeType(enum_field_types mysqlType)
 {
     switch (mysqlType)
     {
@@ -97,4 +97,122 @@ enum Field::DataTypes QueryResultMysql::ConvertNativeType(enum_field_types mysql
             return Field::DB_TYPE_UNKNOWN;
     }
 }
+
+QueryResultMysqlStmt::QueryResultMysqlStmt(MYSQL_STMT* stmt, MYSQL_FIELD* fields, uint64 rowCount, uint32 fieldCount) :
+    QueryResult(rowCount, fieldCount), mStmt(stmt), mBinds(fieldCount), mColumns(fieldCount)
+{
+    mCurrentRow = new Field[mFieldCount];
+    MANGOS_ASSERT(mCurrentRow);
+
+    memset(&mBinds[0], 0, sizeof(MYSQL_BIND) * mFieldCount);
+
+    for (uint32 i = 0; i < mFieldCount; ++i)
+    {
+        mCurrentRow[i].SetType(QueryResultMysql::ConvertNativeType(fields[i].type));
+
+        Column& column = mColumns[i];
+        MYSQL_BIND& bind = mBinds[i];
+
+        switch (fields[i].type)
+        {
+            case FIELD_TYPE_TINY:
+            case FIELD_TYPE_SHORT:
+            case FIELD_TYPE_LONG:
+            case FIELD_TYPE_INT24:
+            case FIELD_TYPE_LONGLONG:
+                bind.buffer_type = MYSQL_TYPE_LONGLONG;
+                bind.buffer = &column.integer;
+                bind.is_unsigned = (fields[i].flags & UNSIGNED_FLAG) ? 1 : 0;
+                break;
+            case FIELD_TYPE_FLOAT:
+                bind.buffer_type = MYSQL_TYPE_FLOAT;
+                bind.buffer = &column.single;
+                break;
+            case FIELD_TYPE_DOUBLE:
+                bind.buffer_type = MYSQL_TYPE_DOUBLE;
+                bind.buffer = &column.real;
+                break;
+            default:
+                // with room for the longest value of the whole result
+                column.text.resize(fields[i].max_length + 1);
+                bind.buffer_type = MYSQL_TYPE_STRING;
+                bind.buffer = &column.text[0];
+                bind.buffer_length = column.text.size();
+                break;
+        }
+
+        bind.length = &column.length;
+        bind.is_null = &column.isNull;
+        bind.error = &column.error;
+    }
+
+    if (mysql_stmt_bind_result(mStmt, &mBinds[0]))
+    {
+        sLog.outErrorDb("SQL ERROR: mysql_stmt_bind_result() failed: %s", mysql_stmt_error(mStmt));
+        EndQuery();
+    }
+}
+
+QueryResultMysqlStmt::~QueryResultMysqlStmt()
+{
+    EndQuery();
+}
+
+bool QueryResultMysqlStmt::NextRow()
+{
+    if (!mStmt)
+        return false;
+
+    int status = mysql_stmt_fetch(mStmt);
+    if (status != 0 && status != MYSQL_DATA_TRUNCATED)
+    {
+        EndQuery();
+        return false;
+    }
+
+    for (uint32 i = 0; i < mFieldCount; ++i)
+    {
+        Column& column = mColumns[i];
+        if (column.isNull)
+        {
+            mCurrentRow[i].SetNull();
+            continue;
+        }
+
+        switch (mBinds[i].buffer_type)
+        {
+            case MYSQL_TYPE_LONGLONG:
+                if (mBinds[i].is_unsigned)
+                    mCurrentRow[i].SetUInt(uint64(column.integer));
+                else
+                    mCurrentRow[i].SetInt(column.integer);
+                break;
+            case MYSQL_TYPE_FLOAT:
+                mCurrentRow[i].SetFloat(column.single);
+                break;
+            case MYSQL_TYPE_DOUBLE:
+                mCurrentRow[i].SetDouble(column.real);
+                break;
+            default:
+                column.text[std::min<size_t>(column.length, column.text.size() - 1)] = '\0';
+                mCurrentRow[i].SetValue(&column.text[0]);
+                break;
+        }
+    }
+
+    return true;
+}
+
+void QueryResultMysqlStmt::EndQuery()
+{
+    delete[] mCurrentRow;
+    mCurrentRow = nullptr;
+
+    if (mStmt)
+    {
+        mysql_stmt_free_result(mStmt);
+        mysql_stmt_close(mStmt);
+        mStmt = nullptr;
+    }
+}
 #endif
@@ -29,6 +29,8 @@
 
 #include <mysql.h>
 
+#include <vector>
+
 class QueryResultMysql : public QueryResult
 {
     public:
@@ -38,11 +40,42 @@ class QueryResultMysql : public QueryResult
 
         bool NextRow() override;
 
+        static enum Field::DataTypes ConvertNativeType(enum_field_types mysqlType);
+
     private:
-        enum Field::DataTypes ConvertNativeType(enum_field_types mysqlType) const;
         void EndQuery();
 
         MYSQL_RES* mResult;
 };
+
+// result of a query run as prepared statement, integer and floating point columns are fetched
+// by the binary protocol as native values, all other columns as text
+class QueryResultMysqlStmt : public QueryResult
+{
+    public:
+        QueryResultMysqlStmt(MYSQL_STMT* stmt, MYSQL_FIELD* fields, uint64 rowCount, uint32 fieldCount);
+
+        ~QueryResultMysqlStmt();
+
+        bool NextRow() override;
+
+    private:
+        struct Column
+        {
+            int64 integer;
+            float single;
+            double real;
+            std::vector<char> text;
+            unsigned long length;
+            my_bool isNull;
+            my_bool error;
+        };
+
+        void EndQuery();
+
+        MYSQL_STMT* mStmt;
+        std::vector<MYSQL_BIND> mBinds;
+        std::vector<Column> mColumns;
+};
 #endif
 #endif
@@ -20,8 +20,8 @@
 
 #include "DatabaseEnv.h"
 
-QueryResultPostgre::QueryResultPostgre(PGresult* result, uint64 rowCount, uint32 fieldCount) :
-    QueryResult(rowCount, fieldCount), mResult(result),  mTableIndex(0)
+QueryResultPostgre::QueryResultPostgre(PGresult* result, uint64 rowCount, uint32 fieldCount, bool binary) :
+    QueryResult(rowCount, fieldCount), mResult(result),  mTableIndex(0), mBinary(binary)
 {
 
     mCurrentRow = new Field[mFieldCount];
@@ -50,6 +50,15 @@ bool QueryResultPostgre::NextRow()
     char* pPQgetvalue;
     for (int j = 0; j < mFieldCount; ++j)
     {
+        if (mBinary)
+        {
+            if (PQgetisnull(mResult, mTableIndex, j))
+                mCurrentRow[j].SetNull();
+            else
+                SetBinaryValue(mCurrentRow[j], PQftype(mResult, j), PQgetvalue(mResult, mTableIndex, j));
+            continue;
+        }
+
         pPQgetvalue = PQgetvalue(mResult, mTableIndex, j);
         if (pPQgetvalue && !(*pPQgetvalue))
             pPQgetvalue = nullptr;
@@ -73,6 +82,75 @@ void QueryResultPostgre::EndQuery()
     }
 }
 
+static uint16 ReadNet16(const char* data)
+{
+    const uint8* bytes = reinterpret_cast<const uint8*>(data);
+    return uint16(bytes[0] << 8 | bytes[1]);
+}
+
+static uint32 ReadNet32(const char* data)
+{
+    return uint32(ReadNet16(data)) << 16 | ReadNet16(data + 2);
+}
+
+static uint64 ReadNet64(const char* data)
+{
+    return uint64(ReadNet32(data)) << 32 | ReadNet32(data + 4);
+}
+
+bool QueryResultPostgre::IsBinarySupported(Oid pOid)
+{
+    switch (pOid)
+    {
+        case BOOLOID:
+        case INT2OID:
+        case INT4OID:
+        case INT8OID:
+        case OIDOID:
+        case FLOAT4OID:
+        case FLOAT8OID:
+        case BPCHAROID:
+        case NAMEOID:
+        case TEXTOID:
+        case VARCHAROID:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void QueryResultPostgre::SetBinaryValue(Field& field, Oid pOid, const char* value) const
+{
+    switch (pOid)
+    {
+        case BOOLOID:   field.SetInt(*value ? 1 : 0);                   break;
+        case INT2OID:   field.SetInt(int16(ReadNet16(value)));          break;
+        case INT4OID:   field.SetInt(int32(ReadNet32(value)));          break;
+        case INT8OID:   field.SetInt(int64(ReadNet64(value)));          break;
+        case OIDOID:    field.SetUInt(ReadNet32(value));                break;
+        case FLOAT4OID:
+        {
+            uint32 bits = ReadNet32(value);
+            float real;
+            memcpy(&real, &bits, sizeof(real));
+            field.SetFloat(real);
+            break;
+        }
+        case FLOAT8OID:
+        {
+            uint64 bits = ReadNet64(value);
+            double real;
+            memcpy(&real, &bits, sizeof(real));
+            field.SetDouble(real);
+            break;
+        }
+        default:
+            // text is sent as is, empty values count as NULL like in text results
+            field.SetValue(*value ? value : nullptr);
+            break;
+    }
+}
+
 // see types in #include <postgre/pg_type.h>
 enum Field::DataTypes QueryResultPostgre::ConvertNativeType(Oid  pOid) const
 {
@@ -74,17 +74,23 @@
 class QueryResultPostgre : public QueryResult
 {
     public:
-        QueryResultPostgre(PGresult* result, uint64 rowCount, uint32 fieldCount);
+        // a binary result holds numeric columns in network order, read as native values without text conversion
+        QueryResultPostgre(PGresult* result, uint64 rowCount, uint32 fieldCount, bool binary = false);
 
         ~QueryResultPostgre();
 
         bool NextRow() override;
 
+        // column types a binary result can be read for, results with other columns are requested as text
+        static bool IsBinarySupported(Oid pOid);
+
     private:
         enum Field::DataTypes ConvertNativeType(Oid pOid) const;
+        void SetBinaryValue(Field& field, Oid pOid, const char* value) const;
         void EndQuery() override;
 
         PGresult* mResult;
         uint32 mTableIndex;
+        bool mBinary;
 };
 #endif
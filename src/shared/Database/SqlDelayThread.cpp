@@ -20,7 +20,9 @@
 #include "Database/SqlOperations.h"
 #include "DatabaseEnv.h"
 
-SqlDelayThread::SqlDelayThread(Database* db, SqlConnection* conn) : m_dbEngine(db), m_dbConnection(conn), m_running(true)
+SqlDelayThread::SqlDelayThread(Database* db, SqlConnection* conn) : m_dbEngine(db), m_dbConnection(conn), m_running(true),
+    m_ungroupable(0), m_groupWindow(db->GetGroupCommitWindow()), m_groupStatements(db->GetGroupCommitStatements()),
+    m_queued(0), m_executed(0), m_groupCommits(0), m_latencyTotal(0), m_latencyMax(0)
 {
 }
 
@@ -36,26 +38,47 @@ void SqlDelayThread::run()
     mysql_thread_init();
 #endif
 
-    const uint32 loopSleepms = 10;
+    // without ping interval the connections are never pinged
+    std::chrono::milliseconds const pingInterval(m_dbEngine->GetPingIntervall());
+    std::chrono::steady_clock::time_point nextPing = std::chrono::steady_clock::now() + pingInterval;
 
-    const uint32 pingEveryLoop = m_dbEngine->GetPingIntervall() / loopSleepms;
-
-    uint32 loopCounter = 0;
     while (m_running)
     {
-        // if the running state gets turned off while sleeping
-        // empty the queue before exiting
-        MaNGOS::Thread::Sleep(loopSleepms);
+        {
+            // sleep until a statement is queued, the thread is stopped or the connections need a ping
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            while (m_running && m_sqlQueue.empty())
+            {
+                if (pingInterval.count() == 0)
+                    m_queueCondition.wait(lock);
+                else if (m_queueCondition.wait_until(lock, nextPing) == std::cv_status::timeout)
+                    break;
+            }
+
+            // let a burst of small writes gather to share one commit, anything else is run at once
+            if (m_groupWindow.count() != 0 && m_groupStatements > 1 && !m_sqlQueue.empty())
+            {
+                std::chrono::steady_clock::time_point const flushTime = m_sqlQueue.front().queueTime + m_groupWindow;
+                while (m_running && !m_ungroupable && m_sqlQueue.size() < m_groupStatements)
+                {
+                    if (m_queueCondition.wait_until(lock, flushTime) == std::cv_status::timeout)
+                        break;
+                }
+            }
+        }
 
         ProcessRequests();
 
-        if ((loopCounter++) >= pingEveryLoop)
+        if (pingInterval.count() != 0 && std::chrono::steady_clock::now() >= nextPing)
         {
-            loopCounter = 0;
             m_dbEngine->Ping();
+            nextPing = std::chrono::steady_clock::now() + pingInterval;
         }
     }
 
+    // requests queued before the stop, other workers may wait for them to pass their ordering barriers
+    ProcessRequests();
+
 #ifndef DO_POSTGRESQL
     mysql_thread_end();
 #endif
@@ -63,24 +86,124 @@ void SqlDelayThread::run()
 
 void SqlDelayThread::Stop()
 {
-    m_running = false;
+    {
+        std::lock_guard<std::mutex> guard(m_queueMutex);
+        m_running = false;
+    }
+    m_queueCondition.notify_all();
+}
+
+void SqlDelayThread::TakeStats(SqlDelayStats& stats)
+{
+    stats.queued = m_queued;
+    stats.executed = m_executed.exchange(0);
+    stats.groupCommits = m_groupCommits.exchange(0);
+    uint64 total = m_latencyTotal.exchange(0);
+    stats.averageLatency = stats.executed ? uint32(total / stats.executed) : 0;
+    stats.maxLatency = m_latencyMax.exchange(0);
 }
 
 void SqlDelayThread::ProcessRequests()
 {
-    std::queue<std::unique_ptr<SqlOperation>> sqlQueue;
+    std::queue<QueuedOperation> sqlQueue;
 
     // we need to move the contents of the queue to a local copy because executing these statements with the
     // lock in place can result in a deadlock with the world thread which calls Database::ProcessResultQueue()
     {
         std::lock_guard<std::mutex> guard(m_queueMutex);
         sqlQueue = std::move(m_sqlQueue);
+        m_ungroupable = 0;
     }
 
+    std::vector<QueuedOperation> group;
     while (!sqlQueue.empty())
     {
-        auto const s = std::move(sqlQueue.front());
+        // consecutive writes share a commit, the order of all operations is kept
+        while (!sqlQueue.empty() && group.size() < m_groupStatements && sqlQueue.front().operation->CanGroupCommit())
+        {
+            group.push_back(std::move(sqlQueue.front()));
+            sqlQueue.pop();
+        }
+
+        if (!group.empty())
+        {
+            ExecuteGroup(group);
+            for (auto const& queued : group)
+                OnExecuted(queued.queueTime);
+
+            group.clear();
+            continue;
+        }
+
+        auto const s = std::move(sqlQueue.front().operation);
+        auto const queueTime = sqlQueue.front().queueTime;
         sqlQueue.pop();
         s->Execute(m_dbConnection);
+        OnExecuted(queueTime);
     }
 }
+
+void SqlDelayThread::ExecuteGroup(std::vector<QueuedOperation>& group)
+{
+    if (group.size() == 1)
+    {
+        group.front().operation->Execute(m_dbConnection);
+        return;
+    }
+
+    // The group is only run again write by write when the server surely rolled it back: a lock conflict, or a
+    // failed write followed by a successful ROLLBACK. A failed COMMIT or ROLLBACK (e.g. the connection dropped)
+    // leaves the outcome unknown, the group may be committed already and is dropped, since running writes like
+    // "x = x + n" twice would corrupt data. Tables without transactions (MyISAM) are never rolled back, writes
+    // to them that ran before the failure run again.
+    bool replay = true;
+    {
+        SqlConnection::Lock guard(m_dbConnection);
+        if (guard->BeginTransaction())
+        {
+            bool failed = false;
+            std::vector<SqlOperation*> statements;
+            for (auto const& queued : group)
+            {
+                statements.clear();
+                queued.operation->AppendStatements(statements);
+                if (!SqlTransaction::ExecuteStatements(m_dbConnection, statements))
+                {
+                    failed = true;
+                    break;
+                }
+            }
+
+            if (!failed && guard->CommitTransaction())
+            {
+                ++m_groupCommits;
+                return;
+            }
+
+            bool lockConflict = guard->IsLockConflictError();
+            bool rolledBack = guard->RollbackTransaction();
+            replay = lockConflict || (failed && rolledBack);
+        }
+    }
+
+    if (!replay)
+    {
+        sLog.outError("SqlDelayThread: group commit of " SIZEFMTD " writes failed with an unknown outcome, the writes are dropped", group.size());
+        return;
+    }
+
+    // nothing of the group is kept, every write is run on its own so only the failing one is lost
+    sLog.outError("SqlDelayThread: group commit of " SIZEFMTD " writes was rolled back, executing them one by one", group.size());
+    for (auto const& queued : group)
+        queued.operation->Execute(m_dbConnection);
+}
+
+void SqlDelayThread::OnExecuted(std::chrono::steady_clock::time_point queueTime)
+{
+    uint32 latency = uint32(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - queueTime).count());
+    --m_queued;
+    ++m_executed;
+    m_latencyTotal += latency;
+    uint32 maxLatency = m_latencyMax;
+    while (latency > maxLatency && !m_latencyMax.compare_exchange_weak(maxLatency, latency)) {}
+}
@@ -23,24 +23,58 @@
 #include "SqlOperations.h"
 
 #include <mutex>
+#include <condition_variable>
 #include <queue>
+#include <vector>
 #include <memory>
+#include <atomic>
+#include <chrono>
 
 class Database;
 class SqlOperation;
 class SqlConnection;
 
+// activity of one async worker since the last TakeStats, latency from queuing to executed in microseconds
+struct SqlDelayStats
+{
+    uint32 queued;
+    uint64 executed;
+    uint64 groupCommits;                                    // commits shared by several writes
+    uint32 averageLatency;
+    uint32 maxLatency;
+};
+
 class SqlDelayThread : public MaNGOS::Runnable
 {
     private:
+        struct QueuedOperation
+        {
+            std::unique_ptr<SqlOperation> operation;
+            std::chrono::steady_clock::time_point queueTime;
+        };
+
         std::mutex m_queueMutex;
-        std::queue<std::unique_ptr<SqlOperation>> m_sqlQueue;   ///< Queue of SQL statements
+        std::condition_variable m_queueCondition;               ///< Signalled on new statements and stop
+        std::queue<QueuedOperation> m_sqlQueue;                 ///< Queue of SQL statements
         Database* m_dbEngine;                                   ///< Pointer to used Database engine
         SqlConnection* m_dbConnection;                          ///< Pointer to DB connection
-        volatile bool m_running;
+        std::atomic<bool> m_running;
+        uint32 m_ungroupable;                               ///< queued operations which can not share a commit
+
+        std::chrono::milliseconds m_groupWindow;
+        size_t m_groupStatements;
+
+        std::atomic<uint32> m_queued;
+        std::atomic<uint64> m_executed;
+        std::atomic<uint64> m_groupCommits;
+        std::atomic<uint64> m_latencyTotal;
+        std::atomic<uint32> m_latencyMax;
 
         // process all enqueued requests
         void ProcessRequests();
+        // execute consecutive writes with a single commit
+        void ExecuteGroup(std::vector<QueuedOperation>& group);
+        void OnExecuted(std::chrono::steady_clock::time_point queueTime);
 
     public:
         SqlDelayThread(Database* db, SqlConnection* conn);
@@ -49,11 +83,19 @@ class SqlDelayThread : public MaNGOS::Runnable
         ///< Put sql statement to delay queue
         bool Delay(SqlOperation* sql)
         {
-            std::lock_guard<std::mutex> guard(m_queueMutex);
-            m_sqlQueue.push(std::unique_ptr<SqlOperation>(sql));
+            {
+                std::lock_guard<std::mutex> guard(m_queueMutex);
+                if (!sql->CanGroupCommit())
+                    ++m_ungroupable;
+                m_sqlQueue.push({ std::unique_ptr<SqlOperation>(sql), std::chrono::steady_clock::now() });
+                ++m_queued;
+            }
+            m_queueCondition.notify_one();
             return true;
         }
 
+        void TakeStats(SqlDelayStats& stats);
+
         virtual void Stop();                                ///< Stop event
         virtual void run();                                 ///< Main Thread loop
 };
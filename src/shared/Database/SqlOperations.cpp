@@ -34,6 +34,17 @@ bool SqlPlainRequest::Execute(SqlConnection* conn)
     return conn->Execute(m_sql);
 }
 
+bool SqlPlainRequest::CanGroupCommit() const
+{
+    // anything else, like TRUNCATE, may end the shared transaction
+    char const* sql = m_sql;
+    while (isspace(static_cast<unsigned char>(*sql)))
+        ++sql;
+
+    return strnicmp(sql, "insert", 6) == 0 || strnicmp(sql, "update", 6) == 0 ||
+           strnicmp(sql, "delete", 6) == 0 || strnicmp(sql, "replace", 7) == 0;
+}
+
 SqlTransaction::~SqlTransaction()
 {
     while (!m_queue.empty())
@@ -52,19 +63,57 @@ bool SqlTransaction::Execute(SqlConnection* conn)
 
     conn->BeginTransaction();
 
-    const int nItems = m_queue.size();
-    for (int i = 0; i < nItems; ++i)
+    if (!ExecuteStatements(conn, m_queue))
     {
-        SqlOperation* pStmt = m_queue[i];
+        conn->RollbackTransaction();
+        return false;
+    }
 
-        if (!pStmt->Execute(conn))
-        {
-            conn->RollbackTransaction();
+    return conn->CommitTransaction();
+}
+
+bool SqlTransaction::CanGroupCommit() const
+{
+    for (SqlOperation const* pStmt : m_queue)
+        if (!pStmt->CanGroupCommit())
             return false;
+
+    return true;
+}
+
+bool SqlTransaction::ExecuteStatements(SqlConnection* conn, std::vector<SqlOperation*> const& statements)
+{
+    std::vector<SqlStmtParameters const*> rows;
+
+    size_t const nItems = statements.size();
+    for (size_t i = 0; i < nItems;)
+    {
+        SqlPreparedRequest* request = statements[i]->ToPreparedRequest();
+        if (!request || !conn->IsMultiRowStmt(request->GetIndex()))
+        {
+            if (!statements[i]->Execute(conn))
+                return false;
+
+            ++i;
+            continue;
+        }
+
+        // collect the following rows of the same INSERT, e.g. all items of an inventory save
+        rows.clear();
+        for (; i < nItems; ++i)
+        {
+            SqlPreparedRequest* next = statements[i]->ToPreparedRequest();
+            if (!next || next->GetIndex() != request->GetIndex())
+                break;
+
+            rows.push_back(&next->GetParams());
         }
+
+        if (!conn->ExecuteStmtRows(request->GetIndex(), rows))
+            return false;
     }
 
-    return conn->CommitTransaction();
+    return true;
 }
 
 SqlPreparedRequest::SqlPreparedRequest(int nIndex, SqlStmtParameters* arg) : m_nIndex(nIndex), m_param(arg)
@@ -82,8 +131,53 @@ bool SqlPreparedRequest::Execute(SqlConnection* conn)
     return conn->ExecuteStmt(m_nIndex, *m_param);
 }
 
+/// ---- ORDERING BETWEEN ASYNC WORKERS ----
+
+bool SqlBarrier::Execute(SqlConnection* conn)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (m_waiting)
+            m_condition.wait(lock);
+    }
+
+    bool result = m_operation->Execute(conn);
+
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_done = true;
+    }
+    m_condition.notify_all();
+
+    return result;
+}
+
+void SqlBarrier::Arrive()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!--m_waiting)
+        m_condition.notify_all();
+
+    while (!m_done)
+        m_condition.wait(lock);
+}
+
+bool SqlBarrierStep::Execute(SqlConnection* conn)
+{
+    if (m_execute)
+        return m_barrier->Execute(conn);
+
+    m_barrier->Arrive();
+    return true;
+}
+
 /// ---- ASYNC QUERIES ----
 
+SqlQueryContinuation::~SqlQueryContinuation()
+{
+    delete m_result;
+}
+
 bool SqlQuery::Execute(SqlConnection* conn)
 {
     if (!m_callback || !m_queue)
@@ -93,40 +187,61 @@ bool SqlQuery::Execute(SqlConnection* conn)
     /// execute the query and store the result in the callback
     m_callback->SetResult(conn->Query(&m_sql[0]));
     /// add the callback to the sql result queue of the thread it originated from
-    m_queue->Add(m_callback);
+    m_queue->Add(m_callback, m_queueTime);
 
     return true;
 }
 
 void SqlResultQueue::Update()
 {
-    std::lock_guard<std::mutex> guard(m_mutex);
+    std::queue<QueuedResult> results;
+
+    /// take the waiting callbacks, the async workers must not wait for the callbacks to add new results
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        results = std::move(m_queue);
+    }
 
     /// execute the callbacks waiting in the synchronization queue
-    while (!m_queue.empty())
+    std::chrono::steady_clock::time_point const now = std::chrono::steady_clock::now();
+    while (!results.empty())
     {
-        auto const callback = std::move(m_queue.front());
-        m_queue.pop();
+        auto const callback = std::move(results.front().callback);
+        uint32 latency = uint32(std::chrono::duration_cast<std::chrono::microseconds>(now - results.front().queueTime).count());
+        results.pop();
+
+        ++m_delivered;
+        m_latencyTotal += latency;
+        uint32 maxLatency = m_latencyMax;
+        while (latency > maxLatency && !m_latencyMax.compare_exchange_weak(maxLatency, latency)) {}
+
         callback->Execute();
     }
 }
 
-void SqlResultQueue::Add(MaNGOS::IQueryCallback* callback)
+void SqlResultQueue::Add(MaNGOS::IQueryCallback* callback, std::chrono::steady_clock::time_point queueTime)
 {
     std::lock_guard<std::mutex> guard(m_mutex);
-    m_queue.push(std::unique_ptr<MaNGOS::IQueryCallback>(callback));
+    m_queue.push({ std::unique_ptr<MaNGOS::IQueryCallback>(callback), queueTime });
 }
 
-bool SqlQueryHolder::Execute(MaNGOS::IQueryCallback* callback, SqlDelayThread* thread, SqlResultQueue* queue)
+void SqlResultQueue::TakeStats(uint64& count, uint32& averageLatency, uint32& maxLatency)
 {
-    if (!callback || !thread || !queue)
+    count = m_delivered.exchange(0);
+    uint64 total = m_latencyTotal.exchange(0);
+    averageLatency = count ? uint32(total / count) : 0;
+    maxLatency = m_latencyMax.exchange(0);
+}
+
+bool SqlQueryHolder::Execute(MaNGOS::IQueryCallback* callback, Database* db, SqlResultQueue* queue)
+{
+    if (!callback || !db || !queue)
         return false;
 
     /// delay the execution of the queries, sync them with the delay thread
     /// which will in turn resync on execution (via the queue) and call back
     SqlQueryHolderEx* holderEx = new SqlQueryHolderEx(this, callback, queue);
-    thread->Delay(holderEx);
-    return true;
+    return db->DelayAsync(holderEx, m_orderKey);
 }
 
 bool SqlQueryHolder::SetQuery(size_t index, const char* sql)
@@ -231,7 +346,7 @@ bool SqlQueryHolderEx::Execute(SqlConnection* conn)
     }
 
     /// sync with the caller thread
-    m_queue->Add(m_callback);
+    m_queue->Add(m_callback, m_queueTime);
 
     return true;
 }
@@ -24,8 +24,12 @@
 
 #include <queue>
 #include <vector>
+#include <functional>
 #include <mutex>
 #include <memory>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
 
 /// ---- BASE ---
 
@@ -34,12 +38,20 @@ class SqlConnection;
 class SqlDelayThread;
 class SqlStmtParameters;
 
+class SqlPreparedRequest;
+
 class SqlOperation
 {
     public:
         virtual void OnRemove() { delete this; }
         virtual bool Execute(SqlConnection* conn) = 0;
         virtual ~SqlOperation() {}
+
+        // writes which may share one commit with other writes queued next to them
+        virtual bool CanGroupCommit() const { return false; }
+        // single statements of a groupable write, executed in order inside the shared commit
+        virtual void AppendStatements(std::vector<SqlOperation*>& statements) { statements.push_back(this); }
+        virtual SqlPreparedRequest* ToPreparedRequest() { return nullptr; }
 };
 
 /// ---- ASYNC STATEMENTS / TRANSACTIONS ----
@@ -52,20 +64,30 @@ class SqlPlainRequest : public SqlOperation
         SqlPlainRequest(const char* sql) : m_sql(mangos_strdup(sql)) {}
         ~SqlPlainRequest() { char* tofree = const_cast<char*>(m_sql); delete[] tofree; }
         bool Execute(SqlConnection* conn) override;
+        bool CanGroupCommit() const override;
 };
 
 class SqlTransaction : public SqlOperation
 {
     private:
         std::vector<SqlOperation* > m_queue;
+        uint32 const m_orderKey;
 
     public:
-        SqlTransaction() {}
+        SqlTransaction(uint32 orderKey = 0) : m_orderKey(orderKey) {}
         ~SqlTransaction();
 
+        uint32 GetOrderKey() const { return m_orderKey; }
+
         void DelayExecute(SqlOperation* sql) { m_queue.push_back(sql); }
 
         bool Execute(SqlConnection* conn) override;
+        bool CanGroupCommit() const override;
+        void AppendStatements(std::vector<SqlOperation*>& statements) override { statements.insert(statements.end(), m_queue.begin(), m_queue.end()); }
+
+        // runs statements in order inside an open transaction, stops at the first failure
+        // consecutive rows of one prepared INSERT are sent as a single multi-row INSERT
+        static bool ExecuteStatements(SqlConnection* conn, std::vector<SqlOperation*> const& statements);
 };
 
 class SqlPreparedRequest : public SqlOperation
@@ -75,12 +97,48 @@ class SqlPreparedRequest : public SqlOperation
         ~SqlPreparedRequest();
 
         bool Execute(SqlConnection* conn) override;
+        bool CanGroupCommit() const override { return true; }
+        SqlPreparedRequest* ToPreparedRequest() override { return this; }
+
+        int GetIndex() const { return m_nIndex; }
+        SqlStmtParameters const& GetParams() const { return *m_param; }
 
     private:
         const int m_nIndex;
         SqlStmtParameters* m_param;
 };
 
+/// ---- ORDERING BETWEEN ASYNC WORKERS ----
+
+// An operation without ordering key runs once every worker reached it, so it stays behind everything queued
+// before it and ahead of everything queued after it, as with a single worker
+class SqlBarrier
+{
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        uint32 m_waiting;                                   // workers not reached yet, the executing one not counted
+        bool m_done;
+        std::unique_ptr<SqlOperation> m_operation;
+
+    public:
+        SqlBarrier(SqlOperation* operation, uint32 waiting) : m_waiting(waiting), m_done(false), m_operation(operation) {}
+
+        bool Execute(SqlConnection* conn);
+        void Arrive();
+};
+
+class SqlBarrierStep : public SqlOperation
+{
+    private:
+        std::shared_ptr<SqlBarrier> m_barrier;
+        bool const m_execute;
+
+    public:
+        SqlBarrierStep(std::shared_ptr<SqlBarrier> const& barrier, bool execute) : m_barrier(barrier), m_execute(execute) {}
+        bool Execute(SqlConnection* conn) override;
+};
+
 /// ---- ASYNC QUERIES ----
 
 class SqlQuery;                                             /// contains a single async query
@@ -91,12 +149,45 @@ class SqlQueryHolderEx;                                     /// points to a hold
 class SqlResultQueue
 {
     private:
+        struct QueuedResult
+        {
+            std::unique_ptr<MaNGOS::IQueryCallback> callback;
+            std::chrono::steady_clock::time_point queueTime;    // when the query was queued for execution
+        };
+
         std::mutex m_mutex;
-        std::queue<std::unique_ptr<MaNGOS::IQueryCallback>> m_queue;
+        std::queue<QueuedResult> m_queue;
+
+        std::atomic<uint64> m_delivered;
+        std::atomic<uint64> m_latencyTotal;
+        std::atomic<uint32> m_latencyMax;
 
     public:
+        SqlResultQueue() : m_delivered(0), m_latencyTotal(0), m_latencyMax(0) {}
+
         void Update();
-        void Add(MaNGOS::IQueryCallback*);
+        void Add(MaNGOS::IQueryCallback* callback, std::chrono::steady_clock::time_point queueTime);
+
+        // callbacks run since the last call and their latency from queuing the query, in microseconds
+        void TakeStats(uint64& count, uint32& averageLatency, uint32& maxLatency);
+};
+
+// runs a function with the query result on the thread owning the result queue, the result is deleted afterwards
+class SqlQueryContinuation : public MaNGOS::IQueryCallback
+{
+    public:
+        typedef std::function<void(QueryResult*)> Function;
+
+        explicit SqlQueryContinuation(Function const& function) : m_function(function), m_result(nullptr) {}
+        ~SqlQueryContinuation();
+
+        void Execute() override { m_function(m_result); }
+        void SetResult(QueryResult* result) override { m_result = result; }
+        QueryResult* GetResult() override { return m_result; }
+
+    private:
+        Function m_function;
+        QueryResult* m_result;
 };
 
 class SqlQuery : public SqlOperation
@@ -104,11 +195,20 @@ class SqlQuery : public SqlOperation
     private:
         std::vector<char> m_sql;
         MaNGOS::IQueryCallback* const m_callback;
+        std::shared_ptr<SqlResultQueue> const m_queueOwner;
         SqlResultQueue* const m_queue;
+        std::chrono::steady_clock::time_point const m_queueTime;
 
     public:
         SqlQuery(const char* sql, MaNGOS::IQueryCallback* callback, SqlResultQueue* queue)
-            : m_sql(strlen(sql) + 1), m_callback(callback), m_queue(queue)
+            : m_sql(strlen(sql) + 1), m_callback(callback), m_queue(queue), m_queueTime(std::chrono::steady_clock::now())
+        {
+            memcpy(&m_sql[0], sql, m_sql.size());
+        }
+
+        // the queue is kept alive until the result is added, a result for an owner gone meanwhile is dropped with the queue
+        SqlQuery(const char* sql, MaNGOS::IQueryCallback* callback, std::shared_ptr<SqlResultQueue> const& queue)
+            : m_sql(strlen(sql) + 1), m_callback(callback), m_queueOwner(queue), m_queue(queue.get()), m_queueTime(std::chrono::steady_clock::now())
         {
             memcpy(&m_sql[0], sql, m_sql.size());
         }
@@ -122,15 +222,18 @@ class SqlQueryHolder
     private:
         typedef std::pair<const char*, QueryResult*> SqlResultPair;
         std::vector<SqlResultPair> m_queries;
+        uint32 m_orderKey;
     public:
-        SqlQueryHolder() {}
+        SqlQueryHolder() : m_orderKey(0) {}
         ~SqlQueryHolder();
         bool SetQuery(size_t index, const char* sql);
         bool SetPQuery(size_t index, const char* format, ...) ATTR_PRINTF(3, 4);
         void SetSize(size_t size);
         QueryResult* GetResult(size_t index);
         void SetResult(size_t index, QueryResult* result);
-        bool Execute(MaNGOS::IQueryCallback* callback, SqlDelayThread* thread, SqlResultQueue* queue);
+        // queries with the same key are ordered with writes of that key only, see Database::BeginTransaction
+        void SetOrderKey(uint32 orderKey) { m_orderKey = orderKey; }
+        bool Execute(MaNGOS::IQueryCallback* callback, Database* db, SqlResultQueue* queue);
 };
 
 class SqlQueryHolderEx : public SqlOperation
@@ -139,9 +242,10 @@ class SqlQueryHolderEx : public SqlOperation
         SqlQueryHolder* m_holder;
         MaNGOS::IQueryCallback* m_callback;
         SqlResultQueue* m_queue;
+        std::chrono::steady_clock::time_point const m_queueTime;
     public:
         SqlQueryHolderEx(SqlQueryHolder* holder, MaNGOS::IQueryCallback* callback, SqlResultQueue* queue)
-            : m_holder(holder), m_callback(callback), m_queue(queue) {}
+            : m_holder(holder), m_callback(callback), m_queue(queue), m_queueTime(std::chrono::steady_clock::now()) {}
         bool Execute(SqlConnection* conn) override;
 };
 #endif                                                      //__SQLOPERATIONS_H
@@ -18,6 +18,10 @@
 
 #include "DatabaseEnv.h"
 
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+
 SqlStmtParameters::SqlStmtParameters(uint32 nParams)
 {
     // reserve memory if needed
@@ -83,6 +87,90 @@ bool SqlStatement::DirectExecute()
     return m_pDB->DirectExecuteStmt(m_index, args);
 }
 
+//////////////////////////////////////////////////////////////////////////
+void SqlPreparedStatement::findInsertRow()
+{
+    m_nRowBegin = m_nRowEnd = std::string::npos;
+
+    std::string fmt(m_szFmt);
+    std::transform(fmt.begin(), fmt.end(), fmt.begin(), ::tolower);
+
+    // plain "INSERT ... VALUES (...)" only, INSERT ... SELECT and ON DUPLICATE KEY UPDATE stay single row
+    if (fmt.compare(0, 6, "insert") != 0 && fmt.compare(0, 7, "replace") != 0)
+        return;
+
+    size_t pos = fmt.rfind("values");
+    if (pos == std::string::npos || fmt.find("select") != std::string::npos)
+        return;
+
+    pos = fmt.find_first_not_of(" \t\r\n", pos + 6);
+    if (pos == std::string::npos || fmt[pos] != '(')
+        return;
+
+    size_t const rowBegin = pos;
+    int depth = 0;
+    for (; pos < fmt.length(); ++pos)
+    {
+        if (fmt[pos] == '(')
+            ++depth;
+        else if (fmt[pos] == ')' && --depth == 0)
+            break;
+        else if (fmt[pos] == '\'')
+            return;                                         // no parsing of string literals
+    }
+
+    if (pos == fmt.length() || fmt.find_first_not_of(" \t\r\n;", pos + 1) != std::string::npos)
+        return;
+
+    m_nRowBegin = rowBegin;
+    m_nRowEnd = pos + 1;
+}
+
+bool SqlPreparedStatement::executeRows(const std::vector<const SqlStmtParameters*>& rows)
+{
+    // keep a single request well below the server packet limit
+    size_t const maxRequestLength = 1024 * 1024;
+
+    std::string const head = m_szFmt.substr(0, m_nRowBegin);
+    std::string const row = m_szFmt.substr(m_nRowBegin, m_nRowEnd - m_nRowBegin);
+
+    std::ostringstream request;
+    bool empty = true;
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        if (m_nParams != rows[i]->boundParams())
+        {
+            MANGOS_ASSERT(false);
+            return false;
+        }
+
+        request << (empty ? head : ",");
+        empty = false;
+
+        // replace all '?' of the row with the parameters of this set
+        SqlStmtParameters::ParameterContainer const& _args = rows[i]->params();
+        size_t nParam = 0;
+        for (char c : row)
+        {
+            if (c == '?' && nParam < _args.size())
+                DataToString(_args[nParam++], request);
+            else
+                request << c;
+        }
+
+        if (request.tellp() >= std::streamoff(maxRequestLength) || i + 1 == rows.size())
+        {
+            if (!m_pConn.Execute(request.str().c_str()))
+                return false;
+
+            request.str(std::string());
+            empty = true;
+        }
+    }
+
+    return true;
+}
+
 //////////////////////////////////////////////////////////////////////////
 SqlPlainPreparedStatement::SqlPlainPreparedStatement(const std::string& fmt, SqlConnection& conn) : SqlPreparedStatement(fmt, conn)
 {
@@ -133,7 +221,7 @@ bool SqlPlainPreparedStatement::execute()
     return m_pConn.Execute(m_szPlainRequest.c_str());
 }
 
-void SqlPlainPreparedStatement::DataToString(const SqlStmtFieldData& data, std::ostringstream& fmt) const
+void SqlPreparedStatement::DataToString(const SqlStmtFieldData& data, std::ostringstream& fmt) const
 {
     switch (data.type())
     {
@@ -146,8 +234,8 @@ void SqlPlainPreparedStatement::DataToString(const SqlStmtFieldData& data, std::
         case FIELD_I16:     fmt << "'" << int32(data.toInt16()) << "'";     break;
         case FIELD_I32:     fmt << "'" << data.toInt32() << "'";            break;
         case FIELD_I64:     fmt << "'" << data.toInt64() << "'";            break;
-        case FIELD_FLOAT:   fmt << "'" << data.toFloat() << "'";            break;
-        case FIELD_DOUBLE:  fmt << "'" << data.toDouble() << "'";           break;
+        case FIELD_FLOAT:   fmt << "'" << std::setprecision(std::numeric_limits<float>::max_digits10) << data.toFloat() << "'";     break;
+        case FIELD_DOUBLE:  fmt << "'" << std::setprecision(std::numeric_limits<double>::max_digits10) << data.toDouble() << "'";   break;
         case FIELD_STRING:
         {
             std::string tmp = data.toStr();
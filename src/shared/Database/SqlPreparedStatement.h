@@ -315,11 +315,20 @@ class SqlPreparedStatement
         // execute statement w/o result set
         virtual bool execute() = 0;
 
+        // INSERT of one VALUES row, several rows of it can be sent in a single request
+        bool isMultiRowInsert() const { return m_nRowBegin != std::string::npos; }
+        // execute one multi-row INSERT as plain SQL request for all parameter sets
+        bool executeRows(const std::vector<const SqlStmtParameters*>& rows);
+
     protected:
         SqlPreparedStatement(const std::string& fmt, SqlConnection& conn) :
             m_nParams(0), m_nColumns(0), m_bIsQuery(false),
             m_bPrepared(false), m_szFmt(fmt), m_pConn(conn)
-        {}
+        {
+            findInsertRow();
+        }
+
+        void DataToString(const SqlStmtFieldData& data, std::ostringstream& fmt) const;
 
         uint32 m_nParams;
         uint32 m_nColumns;
@@ -327,6 +336,13 @@ class SqlPreparedStatement
         bool m_bPrepared;
         std::string m_szFmt;
         SqlConnection& m_pConn;
+
+    private:
+        // locate the VALUES row of an INSERT statement
+        void findInsertRow();
+
+        size_t m_nRowBegin;                                 // '(' of the VALUES row or npos
+        size_t m_nRowEnd;                                   // past its ')'
 };
 
 // prepared statements via plain SQL string requests
@@ -345,8 +361,6 @@ class SqlPlainPreparedStatement : public SqlPreparedStatement
         virtual bool execute() override;
 
     protected:
-        void DataToString(const SqlStmtFieldData& data, std::ostringstream& fmt) const;
-
         std::string m_szPlainRequest;
 };
 
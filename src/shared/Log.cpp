@@ -67,7 +67,7 @@ const int LogType_count = int(LogError) + 1;
 
 Log::Log() :
     raLogfile(nullptr), logfile(nullptr), gmLogfile(nullptr), charLogfile(nullptr), dberLogfile(nullptr),
-    eventAiErLogfile(nullptr), scriptErrLogFile(nullptr), worldLogfile(nullptr), customLogFile(nullptr), m_colored(false), m_includeTime(false), m_gmlog_per_account(false), m_scriptLibName(nullptr)
+    eventAiErLogfile(nullptr), scriptErrLogFile(nullptr), worldLogfile(nullptr), customLogFile(nullptr), tickStatsLogFile(nullptr), m_colored(false), m_includeTime(false), m_gmlog_per_account(false), m_scriptLibName(nullptr)
 {
     Initialize();
 }
@@ -267,6 +267,7 @@ void Log::Initialize()
     raLogfile = openLogFile("RaLogFile", nullptr, "a");
     worldLogfile = openLogFile("WorldLogFile", "WorldLogTimestamp", "a");
     customLogFile = openLogFile("CustomLogFile", nullptr, "a");
+    tickStatsLogFile = openLogFile("TickStatsLogFile", nullptr, "a");
 
     // Main log file settings
     m_includeTime  = sConfig.GetBoolDefault("LogTime", false);
@@ -967,6 +968,20 @@ void Log::outCustomLog(const char* str, ...)
     fflush(stdout);
 }
 
+void Log::outTickStats(const char* str, ...)
+{
+    if (!str || !tickStatsLogFile)
+        return;
+
+    va_list ap;
+    outTimestamp(tickStatsLogFile);
+    va_start(ap, str);
+    vfprintf(tickStatsLogFile, str, ap);
+    fprintf(tickStatsLogFile, "\n");
+    va_end(ap);
+    fflush(tickStatsLogFile);
+}
+
 void Log::WaitBeforeContinueIfNeed()
 {
     int mode = sConfig.GetIntDefault("WaitAtStartupError", 0);
@@ -171,6 +171,7 @@ class Log : public MaNGOS::Singleton<Log, MaNGOS::ClassLevelLockable<Log, std::m
         void outCharDump(const char* str, uint32 account_id, uint32 guid, const char* name);
         void outRALog(const char* str, ...)       ATTR_PRINTF(2, 3);
         void outCustomLog(const char* str, ...)       ATTR_PRINTF(2, 3);
+        void outTickStats(const char* str, ...)       ATTR_PRINTF(2, 3);
         uint32 GetLogLevel() const { return m_logLevel; }
         void SetLogLevel(char* level);
         void SetLogFileLevel(char* level);
@@ -203,6 +204,7 @@ class Log : public MaNGOS::Singleton<Log, MaNGOS::ClassLevelLockable<Log, std::m
         FILE* scriptErrLogFile;
         FILE* worldLogfile;
         FILE* customLogFile;
+        FILE* tickStatsLogFile;
         std::mutex m_worldLogMtx;
 
         // log/console control
@@ -0,0 +1,450 @@
+/*
+* This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#include "IoUring.hpp"
+#include "Socket.hpp"
+#include "Log.h"
+
+#include <boost/asio.hpp>
+
+#include <memory>
+#include <vector>
+
+#ifdef MANGOS_IO_URING
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#endif
+
+namespace MaNGOS
+{
+    bool IoUring::s_enabled = false;
+
+#ifdef MANGOS_IO_URING
+    IoUring::IoUring(boost::asio::io_service& service)
+        : m_service(service), m_ringFd(-1), m_ringMemory(nullptr), m_ringSize(0), m_sqes(nullptr), m_sqesSize(0),
+          m_sqHead(nullptr), m_sqTail(nullptr), m_sqFlags(nullptr), m_sqArray(nullptr), m_sqMask(0), m_sqEntries(0),
+          m_cqHead(nullptr), m_cqTail(nullptr), m_cqes(nullptr), m_cqMask(0), m_bufferRing(nullptr), m_bufferTail(0),
+          m_event(service), m_eventValue(0), m_unsubmitted(0), m_batches(0), m_submitPosted(false) {}
+
+    IoUring::~IoUring()
+    {
+        boost::system::error_code ec;
+        m_event.close(ec);
+
+        // the kernel cancels what is still running, the operations and their sockets are released with m_operations
+        if (m_ringFd >= 0)
+            ::close(m_ringFd);
+
+        if (m_sqes)
+            munmap(m_sqes, m_sqesSize);
+        if (m_ringMemory)
+            munmap(m_ringMemory, m_ringSize);
+        if (m_bufferRing)
+            munmap(m_bufferRing, ReceiveBuffers * sizeof(io_uring_buf));
+    }
+
+    bool IoUring::Fail(char const* what)
+    {
+        sLog.outError("IoUring: %s failed: %s, the network thread uses asio", what, strerror(errno));
+        return false;
+    }
+
+    bool IoUring::Open()
+    {
+        // multishot receive came with Linux 6.0, older kernels would fail every receive
+        utsname name;
+        int major = 0, minor = 0;
+        if (uname(&name) || sscanf(name.release, "%d.%d", &major, &minor) != 2 || major < 6)
+        {
+            sLog.outError("IoUring: kernel %s has no multishot receive (Linux 6.0), the network thread uses asio", name.release);
+            return false;
+        }
+
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        params.flags = IORING_SETUP_CQSIZE;
+        params.cq_entries = Entries * 4;
+
+        m_ringFd = int(syscall(__NR_io_uring_setup, Entries, &params));
+        if (m_ringFd < 0)
+            return Fail("io_uring_setup");
+
+        if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_NODROP))
+        {
+            errno = ENOSYS;
+            return Fail("io_uring_setup features");
+        }
+
+        m_ringSize = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned), params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+        m_ringMemory = mmap(nullptr, m_ringSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQ_RING);
+        if (m_ringMemory == MAP_FAILED)
+        {
+            m_ringMemory = nullptr;
+            return Fail("mmap of the rings");
+        }
+
+        m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED)
+            return Fail("mmap of the submission entries");
+        m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+        uint8* ring = static_cast<uint8*>(m_ringMemory);
+        m_sqHead = reinterpret_cast<unsigned*>(ring + params.sq_off.head);
+        m_sqTail = reinterpret_cast<unsigned*>(ring + params.sq_off.tail);
+        m_sqFlags = reinterpret_cast<unsigned*>(ring + params.sq_off.flags);
+        m_sqArray = reinterpret_cast<unsigned*>(ring + params.sq_off.array);
+        m_sqMask = *reinterpret_cast<unsigned*>(ring + params.sq_off.ring_mask);
+        m_sqEntries = params.sq_entries;
+
+        m_cqHead = reinterpret_cast<unsigned*>(ring + params.cq_off.head);
+        m_cqTail = reinterpret_cast<unsigned*>(ring + params.cq_off.tail);
+        m_cqes = reinterpret_cast<io_uring_cqe*>(ring + params.cq_off.cqes);
+        m_cqMask = *reinterpret_cast<unsigned*>(ring + params.cq_off.ring_mask);
+
+        // the receive buffers, the kernel picks one for every completion of a multishot receive
+        void* bufferRing = mmap(nullptr, ReceiveBuffers * sizeof(io_uring_buf), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (bufferRing == MAP_FAILED)
+            return Fail("mmap of the buffer ring");
+        m_bufferRing = static_cast<io_uring_buf_ring*>(bufferRing);
+
+        io_uring_buf_reg registration;
+        memset(&registration, 0, sizeof(registration));
+        registration.ring_addr = uint64(uintptr_t(m_bufferRing));
+        registration.ring_entries = ReceiveBuffers;
+        registration.bgid = ReceiveBufferGroup;
+        if (syscall(__NR_io_uring_register, m_ringFd, IORING_REGISTER_PBUF_RING, &registration, 1) < 0)
+            return Fail("registering the buffer ring");
+
+        m_receiveBuffers.resize(ReceiveBuffers * ReceiveBufferSize);
+        for (unsigned id = 0; id < ReceiveBuffers; ++id)
+            RecycleBuffer(uint16(id));
+
+        int eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (eventFd < 0)
+            return Fail("eventfd");
+
+        if (syscall(__NR_io_uring_register, m_ringFd, IORING_REGISTER_EVENTFD, &eventFd, 1) < 0)
+        {
+            ::close(eventFd);
+            return Fail("registering the eventfd");
+        }
+
+        m_event.assign(eventFd);
+        WaitCompletions();
+
+        return true;
+    }
+
+    int IoUring::Adopt(boost::asio::ip::tcp::socket& socket)
+    {
+        boost::system::error_code ec;
+        int fd = socket.release(ec);
+        if (ec)
+        {
+            sLog.outError("IoUring: failed to take the socket from asio.  Error: %s", ec.message().c_str());
+            return -1;
+        }
+
+        return fd;
+    }
+
+    void IoUring::Shutdown(int fd)
+    {
+        ::shutdown(fd, SHUT_RDWR);
+    }
+
+    void IoUring::CloseDescriptor(int fd)
+    {
+        ::close(fd);
+    }
+
+// note that this function assumes that the ring mutex is locked
+    IoUring::Operation* IoUring::AllocateOperation(OperationType type, std::shared_ptr<Socket> const& socket)
+    {
+        Operation* operation;
+        if (!m_freeOperations.empty())
+        {
+            operation = m_freeOperations.back();
+            m_freeOperations.pop_back();
+        }
+        else
+        {
+            m_operations.emplace_back(new Operation);
+            operation = m_operations.back().get();
+        }
+
+        operation->type = type;
+        operation->socket = socket;
+        return operation;
+    }
+
+    void IoUring::FreeOperation(Operation* operation)
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_freeOperations.push_back(operation);
+    }
+
+// note that this function assumes that the ring mutex is locked
+    io_uring_sqe* IoUring::NextSqe()
+    {
+        // a full queue has to be taken by the kernel before anything else is queued
+        while (m_unsubmitted == m_sqEntries)
+            if (!Submit())
+                std::this_thread::yield();
+
+        unsigned const index = *m_sqTail & m_sqMask;
+        m_sqArray[index] = index;
+
+        io_uring_sqe* sqe = &m_sqes[index];
+        memset(sqe, 0, sizeof(*sqe));
+        return sqe;
+    }
+
+// note that this function assumes that the ring mutex is locked
+    void IoUring::PushSqe()
+    {
+        __atomic_store_n(m_sqTail, *m_sqTail + 1, __ATOMIC_RELEASE);
+        ++m_unsubmitted;
+
+        SubmitSoon();
+    }
+
+// note that this function assumes that the ring mutex is locked
+    bool IoUring::Submit()
+    {
+        while (m_unsubmitted)
+        {
+            int submitted = int(syscall(__NR_io_uring_enter, m_ringFd, m_unsubmitted, 0, 0, nullptr, 0));
+            if (submitted < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+
+                // the queued entries stay, the next submit hands them over
+                if (errno != EAGAIN && errno != EBUSY)
+                    sLog.outError("IoUring: io_uring_enter failed: %s", strerror(errno));
+                return false;
+            }
+
+            m_unsubmitted -= submitted;
+        }
+
+        return true;
+    }
+
+// note that this function assumes that the ring mutex is locked
+    void IoUring::SubmitSoon()
+    {
+        // an open batch submits when it ends
+        if (m_batches || m_submitPosted)
+            return;
+
+        m_submitPosted = true;
+        m_service.post([this]()
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_submitPosted = false;
+            if (!m_batches)
+                Submit();
+        });
+    }
+
+    void IoUring::BeginBatch()
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        ++m_batches;
+    }
+
+    void IoUring::EndBatch()
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if (--m_batches == 0)
+            Submit();
+    }
+
+    void IoUring::Receive(std::shared_ptr<Socket> const& socket, int fd)
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+
+        Operation* operation = AllocateOperation(OperationType::Receive, socket);
+
+        io_uring_sqe* sqe = NextSqe();
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = fd;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = ReceiveBufferGroup;
+        sqe->user_data = uint64(uintptr_t(operation));
+
+        PushSqe();
+    }
+
+    void IoUring::Send(std::shared_ptr<Socket> const& socket, int fd, std::vector<boost::asio::const_buffer> const& buffers)
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+
+        Operation* operation = AllocateOperation(OperationType::Send, socket);
+
+        operation->buffers.resize(buffers.size());
+        for (size_t i = 0; i < buffers.size(); ++i)
+        {
+            operation->buffers[i].iov_base = const_cast<void*>(buffers[i].data());
+            operation->buffers[i].iov_len = buffers[i].size();
+        }
+
+        memset(&operation->message, 0, sizeof(operation->message));
+        operation->message.msg_iov = &operation->buffers[0];
+        operation->message.msg_iovlen = operation->buffers.size();
+
+        io_uring_sqe* sqe = NextSqe();
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->fd = fd;
+        sqe->addr = uint64(uintptr_t(&operation->message));
+        sqe->len = 1;
+        sqe->msg_flags = MSG_NOSIGNAL;
+        sqe->user_data = uint64(uintptr_t(operation));
+
+        PushSqe();
+    }
+
+    void IoUring::WaitCompletions()
+    {
+        m_event.async_read_some(boost::asio::buffer(&m_eventValue, sizeof(m_eventValue)),
+                                [this](const boost::system::error_code & error, size_t /*length*/)
+        {
+            // the eventfd is only closed by the destructor
+            if (!error)
+                this->OnCompletions();
+        });
+    }
+
+    void IoUring::OnCompletions()
+    {
+        // what the handlers queue goes out with one submit after the last completion
+        BeginBatch();
+
+        for (;;)
+        {
+            unsigned head = *m_cqHead;
+            unsigned const tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+            if (head == tail)
+            {
+                // completions that did not fit into the queue are kept by the kernel until the ring is entered
+                if (!(__atomic_load_n(m_sqFlags, __ATOMIC_RELAXED) & IORING_SQ_CQ_OVERFLOW))
+                    break;
+
+                syscall(__NR_io_uring_enter, m_ringFd, 0, 0, IORING_ENTER_GETEVENTS, nullptr, 0);
+                continue;
+            }
+
+            for (; head != tail; ++head)
+            {
+                io_uring_cqe const cqe = m_cqes[head & m_cqMask];
+                __atomic_store_n(m_cqHead, head + 1, __ATOMIC_RELEASE);
+
+                Complete(cqe);
+            }
+        }
+
+        EndBatch();
+
+        WaitCompletions();
+    }
+
+    void IoUring::Complete(io_uring_cqe const& cqe)
+    {
+        Operation* operation = reinterpret_cast<Operation*>(uintptr_t(cqe.user_data));
+
+        if (operation->type == OperationType::Send)
+        {
+            std::shared_ptr<Socket> socket = std::move(operation->socket);
+            FreeOperation(operation);
+
+            if (cqe.res < 0)
+                socket->OnWriteComplete(boost::system::error_code(-cqe.res, boost::system::system_category()), 0);
+            else
+                socket->OnWriteComplete(boost::system::error_code(), size_t(cqe.res));
+            return;
+        }
+
+        if (cqe.flags & IORING_CQE_F_BUFFER)
+        {
+            uint16 const id = uint16(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+            if (cqe.res > 0)
+                operation->socket->OnRingRead(&m_receiveBuffers[id * ReceiveBufferSize], size_t(cqe.res));
+            RecycleBuffer(id);
+        }
+
+        // the receive goes on
+        if (cqe.flags & IORING_CQE_F_MORE)
+            return;
+
+        std::shared_ptr<Socket> socket = std::move(operation->socket);
+        FreeOperation(operation);
+
+        if (cqe.res == 0)
+            socket->OnError(boost::asio::error::eof);
+        else if (cqe.res < 0 && cqe.res != -ENOBUFS)
+            socket->OnError(boost::system::error_code(-cqe.res, boost::system::system_category()));
+        else
+            // the kernel ended the receive, when it ran out of buffers for example, it is started again
+            socket->StartAsyncRead();
+    }
+
+// only called by the network thread, and by Open() before it reaps anything
+    void IoUring::RecycleBuffer(uint16 id)
+    {
+        // not bufs[], the flexible array of older kernel headers starts 8 bytes late in C++, the ring is an array of io_uring_buf
+        io_uring_buf& buffer = reinterpret_cast<io_uring_buf*>(m_bufferRing)[m_bufferTail & (ReceiveBuffers - 1)];
+        buffer.addr = uint64(uintptr_t(&m_receiveBuffers[id * ReceiveBufferSize]));
+        buffer.len = ReceiveBufferSize;
+        buffer.bid = id;
+
+        ++m_bufferTail;
+        __atomic_store_n(&m_bufferRing->tail, m_bufferTail, __ATOMIC_RELEASE);
+    }
+#else
+    IoUring::IoUring(boost::asio::io_service& /*service*/) {}
+    IoUring::~IoUring() {}
+
+    bool IoUring::Open()
+    {
+        sLog.outError("IoUring: not supported by this build, the network thread uses asio");
+        return false;
+    }
+
+    void IoUring::Receive(std::shared_ptr<Socket> const& /*socket*/, int /*fd*/) {}
+    void IoUring::Send(std::shared_ptr<Socket> const& /*socket*/, int /*fd*/, std::vector<boost::asio::const_buffer> const& /*buffers*/) {}
+    void IoUring::BeginBatch() {}
+    void IoUring::EndBatch() {}
+
+    int IoUring::Adopt(boost::asio::ip::tcp::socket& /*socket*/) { return -1; }
+    void IoUring::Shutdown(int /*fd*/) {}
+    void IoUring::CloseDescriptor(int /*fd*/) {}
+#endif
+}
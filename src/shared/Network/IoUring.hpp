@@ -0,0 +1,152 @@
+/*
+* This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*/
+
+#ifndef __IO_URING_HPP_
+#define __IO_URING_HPP_
+
+#include "Platform/Define.h"
+
+#include <boost/asio.hpp>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef MANGOS_IO_URING
+#include <linux/io_uring.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
+namespace MaNGOS
+{
+    class Socket;
+
+    // io_uring rings of one network thread (Network.IoUring), its sockets send and receive through them
+    // instead of the asio reactor. Completions are reaped on the thread running the io_service, woken by an
+    // eventfd, so the socket handlers run on the same thread as with asio.
+    //
+    // Every socket has one multishot receive into a buffer ring registered with the kernel. Operations are
+    // queued from any thread and submitted together: at the end of a batch (a flush cycle, or the handling
+    // of one set of completions), otherwise by a submit posted to the network thread.
+    class IoUring
+    {
+        private:
+            static bool s_enabled;
+
+            static const unsigned Entries = 1024;           // submission queue, the completion queue is 4 times larger
+            static const unsigned ReceiveBuffers = 1024;    // power of two
+            static const unsigned ReceiveBufferSize = 2048;
+            static const uint16 ReceiveBufferGroup = 0;
+
+            enum class OperationType
+            {
+                Receive,
+                Send
+            };
+
+#ifdef MANGOS_IO_URING
+            struct Operation
+            {
+                OperationType type;
+                std::shared_ptr<Socket> socket;
+                std::vector<iovec> buffers;
+                msghdr message;
+            };
+
+            boost::asio::io_service& m_service;
+
+            int m_ringFd;
+            void* m_ringMemory;
+            size_t m_ringSize;
+            io_uring_sqe* m_sqes;
+            size_t m_sqesSize;
+
+            unsigned* m_sqHead;
+            unsigned* m_sqTail;
+            unsigned* m_sqFlags;
+            unsigned* m_sqArray;
+            unsigned m_sqMask;
+            unsigned m_sqEntries;
+
+            unsigned* m_cqHead;
+            unsigned* m_cqTail;
+            io_uring_cqe* m_cqes;
+            unsigned m_cqMask;
+
+            io_uring_buf_ring* m_bufferRing;
+            std::vector<uint8> m_receiveBuffers;
+            uint16 m_bufferTail;
+
+            boost::asio::posix::stream_descriptor m_event;
+            uint64 m_eventValue;
+
+            std::mutex m_lock;                              // submission queue and operations, completions are reaped by the network thread alone
+            unsigned m_unsubmitted;
+            uint32 m_batches;
+            bool m_submitPosted;
+
+            std::vector<std::unique_ptr<Operation> > m_operations;
+            std::vector<Operation*> m_freeOperations;
+
+            Operation* AllocateOperation(OperationType type, std::shared_ptr<Socket> const& socket);
+            void FreeOperation(Operation* operation);
+
+            io_uring_sqe* NextSqe();
+            void PushSqe();
+            bool Submit();
+            void SubmitSoon();
+
+            bool Fail(char const* what);
+
+            void WaitCompletions();
+            void OnCompletions();
+            void Complete(io_uring_cqe const& cqe);
+            void RecycleBuffer(uint16 id);
+#endif
+
+        public:
+            explicit IoUring(boost::asio::io_service& service);
+            ~IoUring();
+
+            IoUring(const IoUring&) = delete;
+            IoUring& operator=(const IoUring&) = delete;
+
+            // false when the kernel lacks multishot receive or provided buffer rings (Linux 6.0), the thread then uses asio
+            bool Open();
+
+            // multishot receive, runs until the connection ends
+            void Receive(std::shared_ptr<Socket> const& socket, int fd);
+            // one sendmsg over the buffers, they are referenced until its completion
+            void Send(std::shared_ptr<Socket> const& socket, int fd, std::vector<boost::asio::const_buffer> const& buffers);
+
+            // operations queued until the batch ends are submitted with one system call
+            void BeginBatch();
+            void EndBatch();
+
+            // the descriptor of an accepted socket leaves asio, -1 on failure
+            static int Adopt(boost::asio::ip::tcp::socket& socket);
+            static void Shutdown(int fd);
+            static void CloseDescriptor(int fd);
+
+            static void SetEnabled(bool enabled) { s_enabled = enabled; }
+            static bool IsEnabled() { return s_enabled; }
+    };
+}
+
+#endif /* !__IO_URING_HPP_ */
@@ -20,6 +20,7 @@
 #define __NETWORK_THREAD_HPP_
 
 #include "Socket.hpp"
+#include "IoUring.hpp"
 
 #include <boost/asio.hpp>
 
@@ -35,6 +36,9 @@ namespace MaNGOS
         private:
             boost::asio::io_service m_service;
 
+            // set with Network.IoUring when the kernel supports it, the sockets then send and receive through it
+            std::unique_ptr<IoUring> m_ring;
+
             std::mutex m_socketLock;
             std::unordered_set<std::shared_ptr<SocketType>> m_sockets;
 
@@ -47,6 +51,13 @@ namespace MaNGOS
             NetworkThread() : m_work(new boost::asio::io_service::work(m_service)), m_serviceThread([this] { boost::system::error_code ec; this->m_service.run(ec); })
             {
                 m_serviceThread.detach();
+
+                if (IoUring::IsEnabled())
+                {
+                    m_ring.reset(new IoUring(m_service));
+                    if (!m_ring->Open())
+                        m_ring.reset();
+                }
             }
 
             ~NetworkThread()
@@ -85,6 +96,8 @@ namespace MaNGOS
 
         MANGOS_ASSERT(i.second);
 
+        (*i.first)->UseRing(m_ring.get());
+
         return *i.first;
     }
 }
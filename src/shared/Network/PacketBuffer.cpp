@@ -49,4 +49,12 @@ void PacketBuffer::Write(const char* buffer, int length)
     memcpy(&m_buffer[m_writePosition], buffer, length);
 
     m_writePosition += length;
-}
\ No newline at end of file
+}
+
+void PacketBuffer::Reset()
+{
+    m_writePosition = m_readPosition = 0;
+
+    if (m_buffer.size() > DEFAULT_BUFFER_SIZE)
+        std::vector<uint8>(DEFAULT_BUFFER_SIZE, 0).swap(m_buffer);
+}
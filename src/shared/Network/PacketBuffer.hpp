@@ -47,6 +47,10 @@ namespace MaNGOS
             int ReadLengthRemaining() const { return m_writePosition - m_readPosition; }
 
             void Write(const char *buffer, int length);
+
+            // empty a spare out buffer before pooling it, memory grown past the initial size by a burst is released.
+            // the socket read buffer keeps its size, it only grows for large client packets and is reused right away
+            void Reset();
     };
 }
 
@@ -17,6 +17,7 @@
 */
 
 #include "Socket.hpp"
+#include "IoUring.hpp"
 #include "Log.h"
 
 #include <boost/asio.hpp>
@@ -29,12 +30,97 @@
 #include <vector>
 #include <functional>
 #include <cstring>
+#include <algorithm>
 
 namespace MaNGOS
 {
+    bool Socket::s_tickFlush = false;
+    size_t Socket::s_flushSize = 16384;
+    bool Socket::s_noDelay = false;
+
+    size_t Socket::s_outQueueHigh = 0;
+    size_t Socket::s_outQueueLow = 0;
+    size_t Socket::s_outQueueLimit = 0;
+
+    std::mutex Socket::s_dirtyLock;
+    std::vector<std::weak_ptr<Socket> > Socket::s_dirtySockets;
+
+    std::atomic<uint64> Socket::s_flushCount(0);
+    std::atomic<uint64> Socket::s_flushDelayTotal(0);
+    std::atomic<uint32> Socket::s_flushDelayMax(0);
+
     Socket::Socket(boost::asio::io_service& service, std::function<void (Socket*)> closeHandler)
-        : m_writeState(WriteState::Idle), m_readState(ReadState::Idle), m_socket(service),
-          m_closeHandler(std::move(closeHandler)), m_outBufferFlushTimer(service), m_address("0.0.0.0") {}
+        : m_writeState(WriteState::Idle), m_readState(ReadState::Idle), m_socket(service), m_ring(nullptr), m_ringFd(-1), m_ringOpen(false),
+          m_closeHandler(std::move(closeHandler)), m_sendingChunks(0), m_outQueueBytes(0), m_congested(false), m_flushQueued(false),
+          m_flushCount(0), m_flushDelayTotal(0), m_flushDelayMax(0), m_outBufferFlushTimer(service), m_address("0.0.0.0") {}
+
+    Socket::~Socket()
+    {
+        // no ring operation references the socket anymore, the descriptor can not be reused under one
+        if (m_ringFd >= 0)
+            IoUring::CloseDescriptor(m_ringFd);
+    }
+
+    void Socket::SetFlushPolicy(bool tickFlush, size_t flushSize, bool noDelay)
+    {
+        s_tickFlush = tickFlush;
+        s_flushSize = flushSize;
+        s_noDelay = noDelay;
+    }
+
+    void Socket::SetOutQueueLimits(size_t high, size_t low, size_t limit)
+    {
+        s_outQueueHigh = high;
+        s_outQueueLow = low;
+        s_outQueueLimit = limit;
+    }
+
+    void Socket::FlushDirty()
+    {
+        std::vector<std::weak_ptr<Socket> > sockets;
+        {
+            std::lock_guard<std::mutex> guard(s_dirtyLock);
+            sockets.swap(s_dirtySockets);
+        }
+
+        // the sends of each io_uring are submitted together once all are queued
+        std::vector<IoUring*> rings;
+
+        for (auto const& weak : sockets)
+        {
+            std::shared_ptr<Socket> socket = weak.lock();
+            if (!socket)
+                continue;
+
+            if (socket->m_ring && std::find(rings.begin(), rings.end(), socket->m_ring) == rings.end())
+            {
+                socket->m_ring->BeginBatch();
+                rings.push_back(socket->m_ring);
+            }
+
+            std::lock_guard<std::mutex> guard(socket->m_mutex);
+            if (socket->m_writeState == WriteState::Buffering && !socket->m_flushQueued)
+                socket->FlushSoon();
+        }
+
+        for (IoUring* ring : rings)
+            ring->EndBatch();
+    }
+
+    void Socket::TakeFlushStats(uint64& count, uint32& averageDelay, uint32& maxDelay)
+    {
+        count = s_flushCount.exchange(0);
+        uint64 total = s_flushDelayTotal.exchange(0);
+        averageDelay = count ? uint32(total / count) : 0;
+        maxDelay = s_flushDelayMax.exchange(0);
+    }
+
+    void Socket::GetFlushDelay(uint32& average, uint32& max) const
+    {
+        uint32 count = m_flushCount;
+        average = count ? uint32(m_flushDelayTotal / count) : 0;
+        max = m_flushDelayMax;
+    }
 
     bool Socket::Open()
     {
@@ -49,10 +135,25 @@ namespace MaNGOS
             return false;
         }
 
-        m_outBuffer.reset(new PacketBuffer);
-        m_secondaryOutBuffer.reset(new PacketBuffer);
         m_inBuffer.reset(new PacketBuffer);
 
+        if (s_noDelay)
+        {
+            boost::system::error_code ec;
+            m_socket.set_option(boost::asio::ip::tcp::no_delay(true), ec);
+            if (ec)
+                sLog.outError("Socket::Open() failed to set TCP_NODELAY.  Error: %s", ec.message().c_str());
+        }
+
+        if (m_ring)
+        {
+            m_ringFd = IoUring::Adopt(m_socket);
+            if (m_ringFd < 0)
+                return false;
+
+            m_ringOpen = true;
+        }
+
         StartAsyncRead();
 
         return true;
@@ -64,9 +165,18 @@ namespace MaNGOS
         if (IsClosed())
             return;
 
-        boost::system::error_code ec;
-        m_socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
-        m_socket.close();
+        if (m_ring)
+        {
+            // ends the receive and fails the sends, the descriptor itself is closed by the destructor
+            m_ringOpen = false;
+            IoUring::Shutdown(m_ringFd);
+        }
+        else
+        {
+            boost::system::error_code ec;
+            m_socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+            m_socket.close();
+        }
 
         if (m_closeHandler)
             m_closeHandler(this);
@@ -82,6 +192,14 @@ namespace MaNGOS
 
         std::shared_ptr<Socket> ptr = shared<Socket>();
         m_readState = ReadState::Reading;
+
+        // one multishot receive delivers everything until the connection ends
+        if (m_ring)
+        {
+            m_ring->Receive(ptr, m_ringFd);
+            return;
+        }
+
         m_socket.async_read_some(boost::asio::buffer(&m_inBuffer->m_buffer[m_inBuffer->m_writePosition], m_inBuffer->m_buffer.size() - m_inBuffer->m_writePosition),
                                  make_custom_alloc_handler(m_allocator,
         [ptr](const boost::system::error_code & error, size_t length) { ptr->OnRead(error, length); }));
@@ -114,6 +232,28 @@ namespace MaNGOS
             return;
         }
 
+        if (ProcessInBuffer())
+            StartAsyncRead();
+    }
+
+    void Socket::OnRingRead(const uint8* data, size_t length)
+    {
+        if (IsClosed())
+            return;
+
+        // the ring buffer goes back to the kernel, the data is appended to what is left of an incomplete packet
+        if (m_inBuffer->m_writePosition + length > m_inBuffer->m_buffer.size())
+            m_inBuffer->m_buffer.resize(m_inBuffer->m_writePosition + length);
+
+        memcpy(&m_inBuffer->m_buffer[m_inBuffer->m_writePosition], data, length);
+        m_inBuffer->m_writePosition += length;
+
+        ProcessInBuffer();
+    }
+
+// returns false when the connection is closed, nothing has to be read anymore
+    bool Socket::ProcessInBuffer()
+    {
         // we must repeat this in case we have read in multiple messages from the client
         while (m_inBuffer->m_readPosition < m_inBuffer->m_writePosition)
         {
@@ -130,19 +270,20 @@ namespace MaNGOS
                     m_inBuffer->m_readPosition = 0;
                     m_inBuffer->m_writePosition = bytesRemaining;
 
-                    StartAsyncRead();
+                    return true;
                 }
-                else if (!IsClosed())
+
+                if (!IsClosed())
                     Close();
 
-                return;
+                return false;
             }
         }
 
         // at this point, the packet has been read and successfully processed.  reset the buffer.
         m_inBuffer->m_writePosition = m_inBuffer->m_readPosition = 0;
 
-        StartAsyncRead();
+        return true;
     }
 
     void Socket::OnError(const boost::system::error_code& error)
@@ -165,12 +306,82 @@ namespace MaNGOS
         return true;
     }
 
+// note that this function assumes that the socket mutex is locked
+    PacketBuffer* Socket::WritableOutBuffer()
+    {
+        // the last chunk can be appended to as long as the running write does not reference it
+        if (m_outQueue.size() > m_sendingChunks && m_outQueue.back().buffer)
+            return m_outQueue.back().buffer.get();
+
+        m_outQueue.emplace_back();
+        OutChunk& chunk = m_outQueue.back();
+        if (!m_spareOutBuffers.empty())
+        {
+            chunk.buffer = std::move(m_spareOutBuffers.back());
+            m_spareOutBuffers.pop_back();
+        }
+        else
+            chunk.buffer.reset(new PacketBuffer);
+
+        return chunk.buffer.get();
+    }
+
+// note that this function assumes that the socket mutex is locked
+    bool Socket::ReserveOut(size_t length)
+    {
+        // a client not reading its data must not grow the memory without end
+        if (s_outQueueLimit && m_outQueueBytes + length > s_outQueueLimit)
+        {
+            if (!IsClosed())
+            {
+                sLog.outError("Socket::Write: %s did not read " SIZEFMTD " queued bytes, closing connection", m_remoteEndpoint.c_str(), size_t(m_outQueueBytes));
+                Close();
+            }
+            return false;
+        }
+
+        m_outQueueBytes += length;
+        if (s_outQueueHigh && m_outQueueBytes >= s_outQueueHigh)
+            m_congested = true;
+
+        return true;
+    }
+
+// note that this function assumes that the socket mutex is locked
+    void Socket::ReleaseOut(size_t length)
+    {
+        m_outQueueBytes -= length;
+        if (m_congested && m_outQueueBytes <= s_outQueueLow)
+            m_congested = false;
+    }
+
+    void Socket::Write(const char* header, int headerSize, std::shared_ptr<uint8 const> const& content, int contentSize)
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+
+        if (!ReserveOut(headerSize + contentSize))
+            return;
+
+        // the header is per socket, copy it
+        WritableOutBuffer()->Write(header, headerSize);
+
+        // reference the content
+        m_outQueue.emplace_back();
+        m_outQueue.back().payload = content;
+        m_outQueue.back().payloadSize = contentSize;
+
+        // flush data if need
+        QueueFlush();
+    }
+
     void Socket::Write(const char* header, int headerSize, const char* content, int contentSize)
     {
         std::lock_guard<std::mutex> guard(m_mutex);
 
-        // get the correct buffer depending on the current writing state
-        PacketBuffer* outBuffer = m_writeState == WriteState::Sending ? m_secondaryOutBuffer.get() : m_outBuffer.get();
+        if (!ReserveOut(headerSize + contentSize))
+            return;
+
+        PacketBuffer* outBuffer = WritableOutBuffer();
 
         // write the header
         outBuffer->Write(header, headerSize);
@@ -179,23 +390,66 @@ namespace MaNGOS
         outBuffer->Write(content, contentSize);
 
         // flush data if need
-        if (m_writeState == WriteState::Idle)
-            StartWriteFlushTimer();
+        QueueFlush();
     }
 
     void Socket::Write(const char* buffer, int length)
     {
         std::lock_guard<std::mutex> guard(m_mutex);
 
-        // get the correct buffer depending on the current writing state
-        PacketBuffer* outBuffer = m_writeState == WriteState::Sending ? m_secondaryOutBuffer.get() : m_outBuffer.get();
+        if (!ReserveOut(length))
+            return;
 
         // write the header
-        outBuffer->Write(buffer, length);
+        WritableOutBuffer()->Write(buffer, length);
 
         // flush data if need
+        QueueFlush();
+    }
+
+// note that this function assumes that the socket mutex is locked
+    void Socket::QueueFlush()
+    {
         if (m_writeState == WriteState::Idle)
-            StartWriteFlushTimer();
+        {
+            // if the socket is closed, silently fail
+            if (IsClosed())
+                return;
+
+            m_bufferedSince = std::chrono::steady_clock::now();
+
+            if (s_tickFlush)
+            {
+                m_writeState = WriteState::Buffering;
+
+                std::lock_guard<std::mutex> guard(s_dirtyLock);
+                s_dirtySockets.push_back(shared<Socket>());
+            }
+            else
+                StartWriteFlushTimer();
+        }
+
+        // enough data to fill packets does not wait for the end of the tick
+        if (m_writeState == WriteState::Buffering && !m_flushQueued && m_outQueueBytes >= s_flushSize)
+            FlushSoon();
+    }
+
+// note that this function assumes that the socket mutex is locked
+    void Socket::FlushSoon()
+    {
+        // the ring takes the send from any thread, no need to go through the network thread
+        if (m_ring)
+        {
+            SendBuffered();
+            return;
+        }
+
+        m_flushQueued = true;
+
+        // replaces a running buffer timeout, its cancelled wait calls FlushOut() as well
+        std::shared_ptr<Socket> ptr = shared<Socket>();
+        m_outBufferFlushTimer.expires_from_now(boost::posix_time::milliseconds(0));
+        m_outBufferFlushTimer.async_wait([ptr](const boost::system::error_code&) { ptr->FlushOut(); });
     }
 
 // note that this function assumes that the socket mutex is locked
@@ -229,23 +483,83 @@ namespace MaNGOS
 
         std::lock_guard<std::mutex> guard(m_mutex);
 
-        assert(m_writeState == WriteState::Buffering);
+        // a flush requested while the buffer timeout was running calls this twice
+        if (m_writeState != WriteState::Buffering)
+            return;
+
+        SendBuffered();
+    }
 
-        // at this point we are guarunteed that there is data to send in the primary buffer.  send it.
+// note that this function assumes that the socket mutex is locked
+    void Socket::SendBuffered()
+    {
+        m_flushQueued = false;
+
+        uint32 delay = uint32(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_bufferedSince).count());
+        ++m_flushCount;
+        m_flushDelayTotal += delay;
+        if (delay > m_flushDelayMax)
+            m_flushDelayMax = delay;
+
+        ++s_flushCount;
+        s_flushDelayTotal += delay;
+        uint32 maxDelay = s_flushDelayMax;
+        while (delay > maxDelay && !s_flushDelayMax.compare_exchange_weak(maxDelay, delay)) {}
+
+        // at this point we are guarunteed that there is data to send in the out queue.  send it.
         m_writeState = WriteState::Sending;
 
+        StartAsyncWrite();
+    }
+
+// note that this function assumes that the socket mutex is locked
+    void Socket::StartAsyncWrite()
+    {
+        // one scatter/gather write over the chunks at the front of the queue
+        m_sendBuffers.clear();
+        for (OutChunk const& chunk : m_outQueue)
+        {
+            if (m_sendBuffers.size() == MaxSendChunks)
+                break;
+
+            m_sendBuffers.push_back(boost::asio::buffer(chunk.Data() + chunk.sent, chunk.Size() - chunk.sent));
+        }
+
+        m_sendingChunks = m_sendBuffers.size();
+
         std::shared_ptr<Socket> ptr = shared<Socket>();
-        m_socket.async_write_some(boost::asio::buffer(m_outBuffer->m_buffer, m_outBuffer->m_writePosition),
+
+        if (m_ring)
+        {
+            m_ring->Send(ptr, m_ringFd, m_sendBuffers);
+            return;
+        }
+
+        m_socket.async_write_some(m_sendBuffers,
                                   make_custom_alloc_handler(m_allocator,
         [ptr](const boost::system::error_code & error, size_t length) { ptr->OnWriteComplete(error, length); }));
     }
 
+    void Socket::FlushBuffered()
+    {
+        if (!s_tickFlush)
+            return;
+
+        std::lock_guard<std::mutex> guard(m_mutex);
+        if (m_writeState == WriteState::Buffering && !m_flushQueued)
+            FlushSoon();
+    }
+
 // if the write state is idle, this will do nothing, which is correct
 // if the write state is sending, this will do nothing, which is correct
 // if the write state is buffering, this will cancel the running timer, which will immediately trigger FlushOut()
+// with tickFlush no timer is running, the flush is queued the same way FlushDirty() does it
     void Socket::ForceFlushOut()
     {
-        m_outBufferFlushTimer.cancel();
+        if (s_tickFlush)
+            FlushBuffered();
+        else
+            m_outBufferFlushTimer.cancel();
     }
 
     void Socket::OnWriteComplete(const boost::system::error_code& error, size_t length)
@@ -267,37 +581,34 @@ namespace MaNGOS
         std::lock_guard<std::mutex> guard(m_mutex);
 
         assert(m_writeState == WriteState::Sending);
-        assert(length <= m_outBuffer->m_writePosition);
 
-        // if there is data left to write, move it to the start of the buffer
-        if (length < m_outBuffer->m_writePosition)
+        // drop the chunks written completely, the remainder of a partially written one is sent next
+        while (length > 0)
         {
-            memcpy(&(m_outBuffer->m_buffer[0]), &(m_outBuffer->m_buffer[length]), (m_outBuffer->m_writePosition - length) * sizeof(m_outBuffer->m_buffer[0]));
-            m_outBuffer->m_writePosition -= length;
-        }
-        // if not, reset the write pointer
-        else
-            m_outBuffer->m_writePosition = 0;
-
-        // if there is data in the secondary buffer, append it to the primary buffer
-        if (m_secondaryOutBuffer->m_writePosition > 0)
-        {
-            // do we have enough space? if not, resize
-            if (m_outBuffer->m_buffer.size() < (m_outBuffer->m_writePosition + m_secondaryOutBuffer->m_writePosition))
-                m_outBuffer->m_buffer.resize(m_outBuffer->m_writePosition + m_secondaryOutBuffer->m_writePosition);
-
-            memcpy(&(m_outBuffer->m_buffer[m_outBuffer->m_writePosition]), &(m_secondaryOutBuffer->m_buffer[0]), (m_secondaryOutBuffer->m_writePosition) * sizeof(m_secondaryOutBuffer->m_buffer[0]));
+            OutChunk& chunk = m_outQueue.front();
+            size_t remaining = chunk.Size() - chunk.sent;
+            if (length < remaining)
+            {
+                chunk.sent += length;
+                ReleaseOut(length);
+                break;
+            }
 
-            m_outBuffer->m_writePosition += m_secondaryOutBuffer->m_writePosition;
-            m_secondaryOutBuffer->m_writePosition = 0;
+            length -= remaining;
+            ReleaseOut(remaining);
+            if (chunk.buffer && m_spareOutBuffers.size() < 2)
+            {
+                chunk.buffer->Reset();
+                m_spareOutBuffers.push_back(std::move(chunk.buffer));
+            }
+            m_outQueue.pop_front();
         }
 
-        std::shared_ptr<Socket> ptr = shared<Socket>();
+        m_sendingChunks = 0;
+
         // if there is any data to write, do so immediately
-        if (m_outBuffer->m_writePosition > 0)
-            m_socket.async_write_some(boost::asio::buffer(m_outBuffer->m_buffer, m_outBuffer->m_writePosition),
-                                      make_custom_alloc_handler(m_allocator,
-            [ptr](const boost::system::error_code & error, size_t length) { ptr->OnWriteComplete(error, length);}));
+        if (!m_outQueue.empty())
+            StartAsyncWrite();
         else
             m_writeState = WriteState::Idle;
     }
@@ -29,16 +29,43 @@
 #include <string>
 #include <mutex>
 #include <functional>
+#include <deque>
+#include <vector>
+#include <atomic>
+#include <chrono>
 
 namespace MaNGOS
 {
+    class IoUring;
+
     class Socket : public std::enable_shared_from_this<Socket>
     {
+        friend class IoUring;
+
         private:
             // buffer timeout period, in milliseconds.  higher values decrease responsiveness
             // ingame but increase bandwidth efficiency by reducing tcp overhead.
+            // not used with tick flushing, buffered data is then sent by FlushDirty()
             static const int BufferTimeout = 50;
 
+            static bool s_tickFlush;
+            static size_t s_flushSize;
+            static bool s_noDelay;
+
+            static size_t s_outQueueHigh;
+            static size_t s_outQueueLow;
+            static size_t s_outQueueLimit;
+
+            static std::mutex s_dirtyLock;
+            static std::vector<std::weak_ptr<Socket> > s_dirtySockets;
+
+            static std::atomic<uint64> s_flushCount;
+            static std::atomic<uint64> s_flushDelayTotal;
+            static std::atomic<uint32> s_flushDelayMax;
+
+            // most chunks handed to one scatter/gather write
+            static const size_t MaxSendChunks = 64;
+
             enum class WriteState
             {
                 Idle,       // no write operation is currently underway
@@ -57,11 +84,40 @@ namespace MaNGOS
 
             boost::asio::ip::tcp::socket m_socket;
 
+            // with Network.IoUring the descriptor leaves m_socket once opened, it is closed with the socket
+            IoUring* m_ring;
+            int m_ringFd;
+            std::atomic<bool> m_ringOpen;
+
             std::function<void(Socket *)> m_closeHandler;
 
+            // part of the out queue, either bytes copied into the socket or a payload referenced from a shared packet
+            struct OutChunk
+            {
+                OutChunk() : payloadSize(0), sent(0) {}
+
+                std::unique_ptr<PacketBuffer> buffer;       // copied bytes, appended to while last in the queue and not being sent
+                std::shared_ptr<uint8 const> payload;       // referenced payload when buffer is not set
+                size_t payloadSize;
+                size_t sent;                                // bytes of the chunk already written to the socket
+
+                const uint8* Data() const { return buffer ? &buffer->m_buffer[0] : payload.get(); }
+                size_t Size() const { return buffer ? buffer->m_writePosition : payloadSize; }
+            };
+
             std::unique_ptr<PacketBuffer> m_inBuffer;
-            std::unique_ptr<PacketBuffer> m_outBuffer;
-            std::unique_ptr<PacketBuffer> m_secondaryOutBuffer;
+            std::deque<OutChunk> m_outQueue;
+            size_t m_sendingChunks;                         // chunks at the queue front referenced by the running write
+            std::vector<boost::asio::const_buffer> m_sendBuffers;
+            std::vector<std::unique_ptr<PacketBuffer> > m_spareOutBuffers;
+            std::atomic<size_t> m_outQueueBytes;            // queued and not yet sent
+            std::atomic<bool> m_congested;                  // out queue passed the high watermark and did not drain to the low one yet
+
+            bool m_flushQueued;                             // a flush was requested before the buffering delay ended
+            std::chrono::steady_clock::time_point m_bufferedSince;
+            std::atomic<uint32> m_flushCount;
+            std::atomic<uint64> m_flushDelayTotal;          // microseconds between the first buffered write and its send
+            std::atomic<uint32> m_flushDelayMax;
 
             std::mutex m_mutex;
             std::mutex m_closeMutex;
@@ -69,10 +125,22 @@ namespace MaNGOS
 
             void StartAsyncRead();
             void OnRead(const boost::system::error_code &error, size_t length);
+            void OnRingRead(const uint8 *data, size_t length);
+            bool ProcessInBuffer();
 
             void StartWriteFlushTimer();
             void OnWriteComplete(const boost::system::error_code &error, size_t length);
             void FlushOut();
+            void SendBuffered();
+
+            PacketBuffer* WritableOutBuffer();
+            void StartAsyncWrite();
+
+            void QueueFlush();
+            void FlushSoon();
+
+            bool ReserveOut(size_t length);
+            void ReleaseOut(size_t length);
 
             void OnError(const boost::system::error_code &error);
 
@@ -90,12 +158,15 @@ namespace MaNGOS
 
         public:
             Socket(boost::asio::io_service &service, std::function<void (Socket *)> closeHandler);
-            virtual ~Socket() = default;
+            virtual ~Socket();
+
+            // send and receive through the io_uring of the network thread instead of asio, set before Open()
+            void UseRing(IoUring *ring) { m_ring = ring; }
 
             virtual bool Open();
             void Close();
 
-            bool IsClosed() const { return !m_socket.is_open(); }
+            bool IsClosed() const { return m_ring ? !m_ringOpen : !m_socket.is_open(); }
             virtual bool Deletable() const { return IsClosed(); }
 
             bool Read(char *buffer, int length);
@@ -103,6 +174,8 @@ namespace MaNGOS
 
             void Write(const char *buffer, int length);
             void Write(const char *header, int headerSize, const char* content, int contentSize);
+            // content is referenced until sent instead of being copied, it must not change anymore
+            void Write(const char *header, int headerSize, std::shared_ptr<uint8 const> const& content, int contentSize);
 
             boost::asio::ip::tcp::socket &GetAsioSocket() { return m_socket; }
 
@@ -112,6 +185,26 @@ namespace MaNGOS
             template <typename T>
             std::shared_ptr<T> shared() { return std::static_pointer_cast<T>(shared_from_this()); }
 
+            // with tickFlush buffered writes wait for the next FlushDirty() instead of BufferTimeout,
+            // a socket with flushSize bytes queued is flushed right away in both modes
+            static void SetFlushPolicy(bool tickFlush, size_t flushSize, bool noDelay);
+            // send the buffered data of all sockets written to since the last call, called at the end of the world tick
+            static void FlushDirty();
+            // with tickFlush send what this socket buffered so far, at the end of the update its writes belong to
+            void FlushBuffered();
+            // flushes of all sockets since the last call and their delay in microseconds
+            static void TakeFlushStats(uint64& count, uint32& averageDelay, uint32& maxDelay);
+
+            // out queue watermarks and the size at which the client is disconnected, 0 for no limit
+            static void SetOutQueueLimits(size_t high, size_t low, size_t limit);
+
+            // delay between the first buffered write and its send, in microseconds
+            void GetFlushDelay(uint32& average, uint32& max) const;
+
+            size_t GetOutQueueBytes() const { return m_outQueueBytes; }
+            // the client does not keep up, senders should leave out what newer data makes redundant
+            bool IsCongested() const { return m_congested; }
+
         private:
             // custom allocator based on example from http://www.boost.org/doc/libs/1_62_0/doc/html/boost_asio/example/cpp11/allocation/server.cpp
 
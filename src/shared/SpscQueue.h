@@ -0,0 +1,85 @@
+/*
+ * This file is part of the CMaNGOS Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _SPSCQ_H
+#define _SPSCQ_H
+
+#include <atomic>
+#include <vector>
+#include <utility>
+#include <cstddef>
+
+// Bounded ring between exactly one producer thread and one consumer thread, no locks inside.
+// Push may only be called by the producer, Pop by the consumer. Several producers have to be
+// serialized by the caller, which makes that side blocking.
+template <typename T>
+class SpscQueue
+{
+    public:
+        // capacity is rounded up to a power of two
+        explicit SpscQueue(size_t capacity) : m_head(0), m_tail(0)
+        {
+            size_t size = 2;
+            while (size < capacity)
+                size <<= 1;
+
+            m_slots.resize(size);
+            m_mask = size - 1;
+        }
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        // value is only moved from when there was room for it
+        bool Push(T& value)
+        {
+            size_t const tail = m_tail.load(std::memory_order_relaxed);
+            if (tail - m_head.load(std::memory_order_acquire) > m_mask)
+                return false;
+
+            m_slots[tail & m_mask] = std::move(value);
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool Pop(T& value)
+        {
+            size_t const head = m_head.load(std::memory_order_relaxed);
+            if (head == m_tail.load(std::memory_order_acquire))
+                return false;
+
+            value = std::move(m_slots[head & m_mask]);
+            m_slots[head & m_mask] = T();
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool Empty() const { return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire); }
+
+    private:
+        std::vector<T> m_slots;
+        size_t m_mask;
+
+        // producer and consumer position kept apart so they do not share a cache line
+        char m_padHead[64];
+        std::atomic<size_t> m_head;
+        char m_padTail[64];
+        std::atomic<size_t> m_tail;
+};
+
+#endif
@@ -2,5 +2,5 @@
 #define __REVISION_SQL_H__
  #define REVISION_DB_REALMD "required_z2748_01_realmd_banning"
  #define REVISION_DB_CHARACTERS "required_z2753_01_characters_new_ticket_system_sql_created"
- #define REVISION_DB_MANGOS "required_z2756_01_mangos_new_ticket_system_update"
+ #define REVISION_DB_MANGOS "required_z2757_01_mangos_pinfo_send_delay"
 #endif // __REVISION_SQL_H__